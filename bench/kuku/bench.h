@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "kuku/common.h"
+#include "benchmark/benchmark.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// The largest table size, as a power of two, used by the benchmarks that sweep table sizes. A table of 2^k items
+// takes 2^(k + 4) bytes; define this to at most 30 on machines with enough memory.
+#ifndef KUKU_BENCH_MAX_LOG_TABLE_SIZE
+#define KUKU_BENCH_MAX_LOG_TABLE_SIZE 24
+#endif
+
+namespace kuku_bench
+{
+    constexpr kuku::table_size_type min_bench_table_size = kuku::table_size_type(1) << 10;
+
+    constexpr kuku::table_size_type max_bench_table_size = kuku::table_size_type(1) << KUKU_BENCH_MAX_LOG_TABLE_SIZE;
+
+    /*
+    Returns count random items. Only the seed comes from std::random_device, which is far too slow to draw the
+    millions of items of the largest tables from.
+    */
+    inline std::vector<kuku::item_type> make_random_items(std::size_t count)
+    {
+        std::mt19937_64 gen(kuku::random_uint64());
+        std::vector<kuku::item_type> items(count);
+        for (auto &item : items)
+        {
+            kuku::set_item(gen(), gen(), item);
+        }
+        return items;
+    }
+
+    /*
+    Returns count random items of ItemBytes bytes, like make_random_items.
+    */
+    template <std::size_t ItemBytes>
+    std::vector<kuku::basic_item_type<ItemBytes>> make_random_basic_items(std::size_t count)
+    {
+        std::mt19937_64 gen(kuku::random_uint64());
+        std::vector<kuku::basic_item_type<ItemBytes>> items(count);
+        for (auto &item : items)
+        {
+            for (std::size_t i = 0; i < ItemBytes; i += sizeof(std::uint64_t))
+            {
+                const std::uint64_t word = gen();
+                std::memcpy(item.data() + i, &word, sizeof(word));
+            }
+        }
+        return items;
+    }
+
+    /*
+    Reports the throughput of a benchmark that processes items_per_iteration items in every iteration, both as
+    items_per_second and as the time per item (time_per_item, in seconds).
+    */
+    inline void set_items_processed(benchmark::State &state, std::size_t items_per_iteration)
+    {
+        state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * items_per_iteration));
+        state.counters["time_per_item"] = benchmark::Counter(
+            static_cast<double>(items_per_iteration),
+            benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+    }
+} // namespace kuku_bench
@@ -0,0 +1,119 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "bench.h"
+#include "kuku/bucket.h"
+#include "benchmark/benchmark.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_bench
+{
+    namespace
+    {
+        constexpr size_t bucket_query_count = 1 << 12;
+
+        /*
+        A bucketized table with two location functions and four slots per bucket, filled to 90%, together with a
+        random sample of its items (hits) and of items not in the table (misses). Cached like the query fixtures.
+        */
+        struct BucketQueryFixture
+        {
+            unique_ptr<BucketKukuTable> table;
+
+            vector<item_type> hits;
+
+            vector<item_type> misses;
+        };
+
+        const BucketQueryFixture &get_bucket_fixture(table_size_type table_size)
+        {
+            static map<table_size_type, BucketQueryFixture> fixtures;
+            auto it = fixtures.find(table_size);
+            if (it != fixtures.end())
+            {
+                return it->second;
+            }
+
+            BucketQueryFixture &fixture = fixtures[table_size];
+            fixture.table =
+                make_unique<BucketKukuTable>(table_size / 4, 4, 0, 2, make_random_item(), 500, make_zero_item());
+
+            vector<item_type> items = make_random_items(table_size / 10 * 9);
+            for (const auto &item : items)
+            {
+                (void)fixture.table->insert(item);
+            }
+
+            mt19937_64 gen(random_uint64());
+            uniform_int_distribution<size_t> index(0, items.size() - 1);
+            fixture.hits.resize(bucket_query_count);
+            for (auto &query : fixture.hits)
+            {
+                query = items[index(gen)];
+            }
+            fixture.misses = make_random_items(bucket_query_count);
+            return fixture;
+        }
+    } // namespace
+
+    /*
+    Inserts random items into an empty bucketized table until the first insertion fails and reports the fill rate
+    reached at that point. The arguments are the number of slots per bucket and the location function count.
+    */
+    void bm_bucket_fill_until_failure(benchmark::State &state)
+    {
+        constexpr table_size_type table_size = 1 << 16;
+        const auto slot_count = static_cast<uint32_t>(state.range(0));
+        const auto loc_func_count = static_cast<uint32_t>(state.range(1));
+
+        double fill_rate_sum = 0.0;
+        uint64_t inserted = 0;
+        for (auto _ : state)
+        {
+            BucketKukuTable table(
+                table_size / slot_count, slot_count, 0, loc_func_count, make_random_item(), 100, make_zero_item());
+            item_type item = make_random_item();
+            while (table.insert(item))
+            {
+                increment_item(item);
+                inserted++;
+            }
+            fill_rate_sum += table.fill_rate();
+        }
+        state.counters["fill_rate"] = fill_rate_sum / static_cast<double>(state.iterations());
+        state.SetItemsProcessed(static_cast<int64_t>(inserted));
+    }
+
+    /*
+    The arguments are the table size in slots and whether the queried items are in the table (1) or not (0); compare
+    with bm_query_scalar, whose tables are only half full.
+    */
+    void bm_bucket_query(benchmark::State &state)
+    {
+        const BucketQueryFixture &fixture = get_bucket_fixture(static_cast<table_size_type>(state.range(0)));
+        const vector<item_type> &queries = state.range(1) ? fixture.hits : fixture.misses;
+        for (auto _ : state)
+        {
+            for (const auto &query : queries)
+            {
+                benchmark::DoNotOptimize(fixture.table->query(query));
+            }
+        }
+        set_items_processed(state, queries.size());
+    }
+
+    BENCHMARK(bm_bucket_fill_until_failure)
+        ->ArgNames({ "slots", "lfc" })
+        ->ArgsProduct({ { 2, 4, 8 }, { 2, 3 } })
+        ->Unit(benchmark::kMillisecond);
+    BENCHMARK(bm_bucket_query)
+        ->ArgNames({ "size", "hit" })
+        ->ArgsProduct({ benchmark::CreateRange(min_bench_table_size, max_bench_table_size, 8), { 1, 0 } });
+} // namespace kuku_bench
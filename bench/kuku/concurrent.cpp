@@ -0,0 +1,103 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "bench.h"
+#include "kuku/concurrent.h"
+#include "benchmark/benchmark.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_bench
+{
+    namespace
+    {
+        constexpr table_size_type concurrent_table_size = 1 << 20;
+
+        /*
+        Every thread inserts its own slice of items; together they fill the table to 80%.
+        */
+        constexpr size_t concurrent_item_count = concurrent_table_size / 5 * 4;
+
+        unique_ptr<ConcurrentKukuTable> concurrent_table;
+
+        vector<item_type> concurrent_items;
+
+        void setup_concurrent(const benchmark::State &)
+        {
+            concurrent_table = make_unique<ConcurrentKukuTable>(
+                concurrent_table_size, 0, 3, make_random_item(), 100, make_zero_item());
+            concurrent_items = make_random_items(concurrent_item_count);
+        }
+
+        void setup_concurrent_filled(const benchmark::State &state)
+        {
+            setup_concurrent(state);
+            for (const auto &item : concurrent_items)
+            {
+                (void)concurrent_table->insert(item);
+            }
+        }
+
+        void teardown_concurrent(const benchmark::State &)
+        {
+            concurrent_table.reset();
+            concurrent_items = vector<item_type>();
+        }
+    } // namespace
+
+    /*
+    Fills an empty ConcurrentKukuTable to 80% with the given number of threads, each inserting its own share of the
+    items. The threads are not synchronized when timing is paused, so every run fills a fresh table exactly once.
+    */
+    void bm_concurrent_insert(benchmark::State &state)
+    {
+        const auto thread_count = static_cast<size_t>(state.threads());
+        const auto thread_index = static_cast<size_t>(state.thread_index());
+        const size_t begin = concurrent_item_count * thread_index / thread_count;
+        const size_t end = concurrent_item_count * (thread_index + 1) / thread_count;
+        for (auto _ : state)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                benchmark::DoNotOptimize(concurrent_table->insert(concurrent_items[i]));
+            }
+        }
+        set_items_processed(state, end - begin);
+    }
+
+    /*
+    Queries a ConcurrentKukuTable filled to 80% with the given number of threads.
+    */
+    void bm_concurrent_query(benchmark::State &state)
+    {
+        const auto thread_count = static_cast<size_t>(state.threads());
+        const auto thread_index = static_cast<size_t>(state.thread_index());
+        const size_t begin = concurrent_item_count * thread_index / thread_count;
+        const size_t end = begin + (size_t(1) << 12);
+        for (auto _ : state)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                benchmark::DoNotOptimize(concurrent_table->query(concurrent_items[i]));
+            }
+        }
+        set_items_processed(state, end - begin);
+    }
+
+    BENCHMARK(bm_concurrent_insert)
+        ->Setup(setup_concurrent)
+        ->Teardown(teardown_concurrent)
+        ->ThreadRange(1, 8)
+        ->Iterations(1)
+        ->UseRealTime()
+        ->Unit(benchmark::kMillisecond);
+    BENCHMARK(bm_concurrent_query)
+        ->Setup(setup_concurrent_filled)
+        ->Teardown(teardown_concurrent)
+        ->ThreadRange(1, 8)
+        ->UseRealTime();
+} // namespace kuku_bench
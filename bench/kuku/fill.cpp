@@ -0,0 +1,58 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/kuku.h"
+#include "benchmark/benchmark.h"
+#include <cstdint>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_bench
+{
+    /*
+    Inserts random items into an empty table until the first insertion fails and reports the fill rate reached at
+    that point. The arguments are the location function count, the LocFuncMode, and the InsertStrategy. When Kuku
+    is built with KUKU_USE_STATS=ON, the evictions counter is the average number of items moved per successful insert.
+    */
+    void bm_fill_until_failure(benchmark::State &state)
+    {
+        constexpr table_size_type table_size = 1 << 16;
+        const auto loc_func_count = static_cast<uint32_t>(state.range(0));
+        const auto loc_func_mode = static_cast<LocFuncMode>(state.range(1));
+        const auto insert_strategy = static_cast<InsertStrategy>(state.range(2));
+
+        double fill_rate_sum = 0.0;
+        uint64_t inserted = 0;
+#ifdef KUKU_USE_STATS
+        uint64_t evictions = 0;
+#endif
+        for (auto _ : state)
+        {
+            KukuTable table(table_size, 0, loc_func_count, make_random_item(), 100, make_zero_item(), loc_func_mode);
+            table.set_insert_strategy(insert_strategy);
+            item_type item = make_random_item();
+            while (table.insert(item))
+            {
+                increment_item(item);
+                inserted++;
+            }
+            fill_rate_sum += table.fill_rate();
+#ifdef KUKU_USE_STATS
+            evictions += table.stats().evictions;
+#endif
+        }
+        state.counters["fill_rate"] = fill_rate_sum / static_cast<double>(state.iterations());
+#ifdef KUKU_USE_STATS
+        state.counters["evictions"] = static_cast<double>(evictions) / static_cast<double>(inserted);
+#endif
+        state.SetItemsProcessed(static_cast<int64_t>(inserted));
+    }
+
+    BENCHMARK(bm_fill_until_failure)
+        ->ArgNames({ "lfc", "mode", "strategy" })
+        ->ArgsProduct({ { 2, 3, 4, 8 },
+                        { static_cast<int64_t>(LocFuncMode::independent), static_cast<int64_t>(LocFuncMode::derived) },
+                        { static_cast<int64_t>(InsertStrategy::random_walk), static_cast<int64_t>(InsertStrategy::bfs) } })
+        ->Unit(benchmark::kMillisecond);
+} // namespace kuku_bench
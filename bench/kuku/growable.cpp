@@ -0,0 +1,51 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "bench.h"
+#include "kuku/growable.h"
+#include "benchmark/benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_bench
+{
+    /*
+    Inserts 2^20 items into a GrowableKukuTable of initial size 2^10; the argument is the migration step. The
+    max_insert_us counter is the longest single insert: with a large migration step every migration happens in one
+    call, like rebuilding into a larger table, while a small step spreads it over many inserts.
+    */
+    void bm_growable_insert(benchmark::State &state)
+    {
+        const auto items = make_random_items(1 << 20);
+        double max_insert_us = 0;
+        for (auto _ : state)
+        {
+            GrowableKukuTable table(
+                1 << 10, 0, 3, make_random_item(), 100, make_zero_item(), 0.9, 2.0,
+                static_cast<size_t>(state.range(0)));
+            for (const auto &item : items)
+            {
+                const auto start = chrono::steady_clock::now();
+                benchmark::DoNotOptimize(table.insert(item));
+                const chrono::duration<double, micro> elapsed = chrono::steady_clock::now() - start;
+                max_insert_us = max(max_insert_us, elapsed.count());
+            }
+        }
+        state.counters["max_insert_us"] = max_insert_us;
+        set_items_processed(state, items.size());
+    }
+
+    BENCHMARK(bm_growable_insert)
+        ->ArgName("step")
+        ->Arg(4)
+        ->Arg(16)
+        ->Arg(64)
+        ->Arg(1 << 30)
+        ->Unit(benchmark::kMillisecond);
+} // namespace kuku_bench
@@ -0,0 +1,110 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "bench.h"
+#include "kuku/kuku.h"
+#include "kuku/internal/hash.h"
+#include "benchmark/benchmark.h"
+#include <cstdint>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_bench
+{
+    void bm_hash_func_scalar(benchmark::State &state)
+    {
+        HashFunc hf(make_random_item());
+        auto items = make_random_items(static_cast<size_t>(state.range(0)));
+        vector<location_type> out(items.size());
+        for (auto _ : state)
+        {
+            for (size_t i = 0; i < items.size(); i++)
+            {
+                out[i] = hf(items[i]);
+            }
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items_processed(state, items.size());
+    }
+
+    void bm_hash_func_batch(benchmark::State &state)
+    {
+        HashFunc hf(make_random_item());
+        auto items = make_random_items(static_cast<size_t>(state.range(0)));
+        vector<location_type> out(items.size());
+        for (auto _ : state)
+        {
+            hf(items.data(), items.size(), out.data());
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items_processed(state, items.size());
+    }
+
+    /*
+    Computes the location of each item with a single location function; the argument is the HashFamily.
+    */
+    void bm_loc_func(benchmark::State &state)
+    {
+        LocFunc lf(1000003, make_random_item(), static_cast<HashFamily>(state.range(0)));
+        auto items = make_random_items(1 << 10);
+        vector<location_type> out(items.size());
+        for (auto _ : state)
+        {
+            for (size_t i = 0; i < items.size(); i++)
+            {
+                out[i] = lf(items[i]);
+            }
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items_processed(state, items.size());
+    }
+
+    void bm_locations(benchmark::State &state)
+    {
+        KukuTable table(
+            1 << 20, 0, static_cast<uint32_t>(state.range(0)), make_random_item(), 100, make_zero_item(),
+            LocFuncMode::independent, static_cast<HashFamily>(state.range(1)));
+        auto items = make_random_items(1 << 10);
+        vector<location_type> out(items.size() * table.loc_func_count());
+        for (auto _ : state)
+        {
+            table.locations(items.data(), items.size(), out.data());
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items_processed(state, items.size());
+    }
+
+    void bm_all_locations(benchmark::State &state)
+    {
+        KukuTable table(1 << 20, 0, static_cast<uint32_t>(state.range(0)), make_random_item(), 100, make_zero_item());
+        auto items = make_random_items(1 << 10);
+        for (auto _ : state)
+        {
+            for (const auto &item : items)
+            {
+                benchmark::DoNotOptimize(table.all_locations(item));
+            }
+        }
+        set_items_processed(state, items.size());
+    }
+
+    BENCHMARK(bm_hash_func_scalar)->Arg(1 << 10);
+    BENCHMARK(bm_hash_func_batch)->Arg(1 << 10);
+    BENCHMARK(bm_loc_func)
+        ->ArgName("family")
+        ->Arg(static_cast<int64_t>(HashFamily::tabulation))
+        ->Arg(static_cast<int64_t>(HashFamily::aes))
+        ->Arg(static_cast<int64_t>(HashFamily::multiply_shift));
+    BENCHMARK(bm_locations)
+        ->ArgNames({ "lfc", "family" })
+        ->ArgsProduct({ { 2, 3, 4, 8 }, { static_cast<int64_t>(HashFamily::tabulation),
+                                          static_cast<int64_t>(HashFamily::aes),
+                                          static_cast<int64_t>(HashFamily::multiply_shift) } });
+    BENCHMARK(bm_all_locations)->Arg(2)->Arg(3)->Arg(4)->Arg(8);
+} // namespace kuku_bench
@@ -0,0 +1,198 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "bench.h"
+#include "kuku/kuku.h"
+#include "benchmark/benchmark.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_bench
+{
+    /*
+    Inserts a band of new items into a table already filled to a given rate. The arguments are the fill rate in
+    percent before the band, the location function count, the stash size, max_probe, and the InsertStrategy. The
+    table is refilled with timing paused, so only the inserts of the band are measured; the failure_rate counter is
+    the fraction of the band that could not be inserted.
+    */
+    void bm_insert(benchmark::State &state)
+    {
+        constexpr table_size_type table_size = 1 << 14;
+        constexpr size_t band_size = table_size / 32;
+        const auto fill_count = static_cast<size_t>(table_size * state.range(0) / 100);
+        const auto loc_func_count = static_cast<uint32_t>(state.range(1));
+        const auto stash_size = static_cast<table_size_type>(state.range(2));
+        const auto max_probe = static_cast<uint64_t>(state.range(3));
+        const auto insert_strategy = static_cast<InsertStrategy>(state.range(4));
+
+        KukuTable table(table_size, stash_size, loc_func_count, make_random_item(), max_probe, make_zero_item());
+        table.set_insert_strategy(insert_strategy);
+        const vector<item_type> prefill = make_random_items(fill_count);
+        const vector<item_type> band = make_random_items(band_size);
+        unique_ptr<bool[]> results(new bool[prefill.size()]);
+
+        uint64_t failures = 0;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            table.clear_table();
+            (void)table.insert_batch(prefill.data(), prefill.size(), results.get());
+            state.ResumeTiming();
+
+            for (const auto &item : band)
+            {
+                failures += static_cast<uint64_t>(!table.insert(item));
+            }
+        }
+        state.counters["failure_rate"] = benchmark::Counter(
+            static_cast<double>(failures) / static_cast<double>(band_size), benchmark::Counter::kAvgIterations);
+        set_items_processed(state, band_size);
+    }
+
+    /*
+    Fills an empty table to 80% with insert_batch; the argument is the table size.
+    */
+    void bm_insert_batch(benchmark::State &state)
+    {
+        const auto table_size = static_cast<table_size_type>(state.range(0));
+        KukuTable table(table_size, 0, 3, make_random_item(), 100, make_zero_item());
+        const vector<item_type> items = make_random_items(table_size / 5 * 4);
+        unique_ptr<bool[]> results(new bool[items.size()]);
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            table.clear_table();
+            state.ResumeTiming();
+
+            benchmark::DoNotOptimize(table.insert_batch(items.data(), items.size(), results.get()));
+        }
+        set_items_processed(state, items.size());
+    }
+
+    /*
+    Fills an empty table of 2^20 locations to 80% with build_parallel; the argument is the number of threads.
+    */
+    void bm_build_parallel(benchmark::State &state)
+    {
+        const table_size_type table_size = 1 << 20;
+        KukuTable table(table_size, 0, 3, make_random_item(), 100, make_zero_item());
+        const vector<item_type> items = make_random_items(table_size / 5 * 4);
+        unique_ptr<bool[]> results(new bool[items.size()]);
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            table.clear_table();
+            state.ResumeTiming();
+
+            benchmark::DoNotOptimize(
+                table.build_parallel(items.data(), items.size(), static_cast<size_t>(state.range(0)), results.get()));
+        }
+        set_items_processed(state, items.size());
+    }
+
+    /*
+    Builds a table of 2^20 locations filled to 93% with four candidate seeds, which is more than three location
+    functions hold in practice, so every seed is tried and fails late; this is the cost of retrying seeds. The argument
+    is the number of threads of build_with_seeds, or zero to construct a new table for every seed and fill it with
+    inserting the items one seed at a time until the first failure.
+    */
+    void bm_build_with_seeds(benchmark::State &state)
+    {
+        const table_size_type table_size = 1 << 20;
+        const vector<item_type> seeds = make_random_items(4);
+        const vector<item_type> items = make_random_items(static_cast<size_t>(table_size * 0.93));
+        for (auto _ : state)
+        {
+            if (state.range(0))
+            {
+                benchmark::DoNotOptimize(KukuTable::build_with_seeds(
+                    table_size, 0, 3, seeds.data(), seeds.size(), 100, make_zero_item(), items.data(), items.size(),
+                    static_cast<size_t>(state.range(0))));
+                continue;
+            }
+            for (const auto &seed : seeds)
+            {
+                KukuTable table(table_size, 0, 3, seed, 100, make_zero_item());
+                if (all_of(items.begin(), items.end(), [&](const item_type &item) { return table.insert(item); }))
+                {
+                    break;
+                }
+            }
+        }
+        set_items_processed(state, items.size() * seeds.size());
+    }
+
+    /*
+    Replaces 1% of the items of a table filled to 80% by erasing them with erase_batch and inserting new items with
+    insert_batch, which is what an incremental update costs; the argument is the table size. Compare with
+    bm_insert_batch, which rebuilds a table of the same size.
+    */
+    void bm_erase_insert_batch(benchmark::State &state)
+    {
+        const auto table_size = static_cast<table_size_type>(state.range(0));
+        KukuTable table(table_size, 16, 3, make_random_item(), 100, make_zero_item());
+        vector<item_type> items = make_random_items(table_size / 5 * 4);
+        unique_ptr<bool[]> results(new bool[items.size()]);
+        (void)table.insert_batch(items.data(), items.size(), results.get());
+
+        // Every iteration replaces the next band of items with new ones
+        const size_t band_size = items.size() / 100;
+        size_t band_start = 0;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            if (band_start + band_size > items.size())
+            {
+                band_start = 0;
+            }
+            const vector<item_type> band = make_random_items(band_size);
+            state.ResumeTiming();
+
+            benchmark::DoNotOptimize(table.erase_batch(items.data() + band_start, band_size, results.get()));
+            benchmark::DoNotOptimize(table.insert_batch(band.data(), band_size, results.get()));
+
+            state.PauseTiming();
+            copy(band.begin(), band.end(), items.begin() + static_cast<ptrdiff_t>(band_start));
+            band_start += band_size;
+            state.ResumeTiming();
+        }
+        set_items_processed(state, band_size);
+    }
+
+    BENCHMARK(bm_insert)
+        ->ArgNames({ "fill", "lfc", "stash", "max_probe", "strategy" })
+        ->ArgsProduct({ { 0, 25, 50, 75, 85 }, { 3, 4 }, { 0 }, { 100 }, { 0, 1 } })
+        ->ArgsProduct({ { 85 }, { 3 }, { 0, 16, 128 }, { 10, 100, 1000 }, { 0, 1 } })
+        ->MinTime(0.1);
+    BENCHMARK(bm_insert_batch)
+        ->ArgName("size")
+        ->RangeMultiplier(8)
+        ->Range(min_bench_table_size, max_bench_table_size)
+        ->Unit(benchmark::kMillisecond);
+    BENCHMARK(bm_build_parallel)
+        ->ArgName("threads")
+        ->Arg(1)
+        ->Arg(2)
+        ->Arg(4)
+        ->UseRealTime()
+        ->Unit(benchmark::kMillisecond);
+    BENCHMARK(bm_build_with_seeds)
+        ->ArgName("threads")
+        ->Arg(0)
+        ->Arg(1)
+        ->Arg(2)
+        ->Arg(4)
+        ->UseRealTime()
+        ->Unit(benchmark::kMillisecond);
+    BENCHMARK(bm_erase_insert_batch)
+        ->ArgName("size")
+        ->RangeMultiplier(8)
+        ->Range(min_bench_table_size << 6, max_bench_table_size)
+        ->Unit(benchmark::kMillisecond);
+} // namespace kuku_bench
@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "bench.h"
+#include "kuku/kuku.h"
+#include "kuku/map.h"
+#include "benchmark/benchmark.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_bench
+{
+    namespace
+    {
+        constexpr size_t lookup_count = 1 << 12;
+
+        struct ItemHash
+        {
+            size_t operator()(const item_type &item) const noexcept
+            {
+                return static_cast<size_t>(get_low_word(item));
+            }
+        };
+
+        struct ItemEqual
+        {
+            bool operator()(const item_type &in1, const item_type &in2) const noexcept
+            {
+                return are_equal_item(in1, in2);
+            }
+        };
+
+        /*
+        Returns lookup_count of the given items, spread over all of them.
+        */
+        vector<item_type> sample_items(const vector<item_type> &items)
+        {
+            vector<item_type> sample;
+            for (size_t i = 0; i < lookup_count; i++)
+            {
+                sample.push_back(items[(i * 7919) % items.size()]);
+            }
+            return sample;
+        }
+    } // namespace
+
+    /*
+    Looks up the 8-byte payloads of items in a half-full KukuMap; the argument is the table size.
+    */
+    void bm_map_find(benchmark::State &state)
+    {
+        const auto table_size = static_cast<table_size_type>(state.range(0));
+        KukuMap map(table_size, 0, 3, make_random_item(), 100, make_zero_item(), sizeof(uint64_t));
+        const auto items = make_random_items(table_size / 2);
+        for (const auto &item : items)
+        {
+            (void)map.insert(item, item.data());
+        }
+        const auto lookups = sample_items(items);
+        for (auto _ : state)
+        {
+            for (const auto &item : lookups)
+            {
+                benchmark::DoNotOptimize(*map.find(item));
+            }
+        }
+        set_items_processed(state, lookups.size());
+    }
+
+    /*
+    Looks up the 8-byte payloads of items in a half-full KukuTable together with a separate std::unordered_map from
+    item to payload, which is what KukuMap replaces; the argument is the table size.
+    */
+    void bm_map_table_and_unordered_map(benchmark::State &state)
+    {
+        const auto table_size = static_cast<table_size_type>(state.range(0));
+        KukuTable table(table_size, 0, 3, make_random_item(), 100, make_zero_item());
+        unordered_map<item_type, uint64_t, ItemHash, ItemEqual> payloads;
+        const auto items = make_random_items(table_size / 2);
+        for (const auto &item : items)
+        {
+            (void)table.insert(item);
+            payloads.emplace(item, get_low_word(item));
+        }
+        const auto lookups = sample_items(items);
+        for (auto _ : state)
+        {
+            for (const auto &item : lookups)
+            {
+                if (table.query(item))
+                {
+                    benchmark::DoNotOptimize(payloads.find(item)->second);
+                }
+            }
+        }
+        set_items_processed(state, lookups.size());
+    }
+
+    BENCHMARK(bm_map_find)->ArgName("size")->RangeMultiplier(8)->Range(min_bench_table_size, max_bench_table_size);
+    BENCHMARK(bm_map_table_and_unordered_map)
+        ->ArgName("size")
+        ->RangeMultiplier(8)
+        ->Range(min_bench_table_size, max_bench_table_size);
+} // namespace kuku_bench
@@ -0,0 +1,124 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "bench.h"
+#include "kuku/kuku.h"
+#include "benchmark/benchmark.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_bench
+{
+    namespace
+    {
+        constexpr size_t query_count = 1 << 12;
+
+        /*
+        A half-full table with three location functions together with a random sample of its items (hits) and of
+        items not in the table (misses). Tables are cached so that all query benchmarks for the same size share the
+        (slow) build.
+        */
+        struct QueryFixture
+        {
+            unique_ptr<KukuTable> table;
+
+            vector<item_type> hits;
+
+            vector<item_type> misses;
+        };
+
+        const QueryFixture &get_fixture(table_size_type table_size)
+        {
+            static map<table_size_type, QueryFixture> fixtures;
+            auto it = fixtures.find(table_size);
+            if (it != fixtures.end())
+            {
+                return it->second;
+            }
+
+            QueryFixture &fixture = fixtures[table_size];
+            fixture.table = make_unique<KukuTable>(table_size, 0, 3, make_random_item(), 100, make_zero_item());
+
+            vector<item_type> items = make_random_items(table_size / 2);
+            unique_ptr<bool[]> results(new bool[items.size()]);
+            (void)fixture.table->insert_batch(items.data(), items.size(), results.get());
+
+            mt19937_64 gen(random_uint64());
+            uniform_int_distribution<size_t> index(0, items.size() - 1);
+            fixture.hits.resize(query_count);
+            for (auto &query : fixture.hits)
+            {
+                query = items[index(gen)];
+            }
+            fixture.misses = make_random_items(query_count);
+            return fixture;
+        }
+    } // namespace
+
+    /*
+    The arguments are the table size and whether the queried items are in the table (1) or not (0).
+    */
+    void bm_query_scalar(benchmark::State &state)
+    {
+        const QueryFixture &fixture = get_fixture(static_cast<table_size_type>(state.range(0)));
+        const vector<item_type> &queries = state.range(1) ? fixture.hits : fixture.misses;
+        for (auto _ : state)
+        {
+            for (const auto &query : queries)
+            {
+                benchmark::DoNotOptimize(fixture.table->query(query));
+            }
+        }
+        set_items_processed(state, queries.size());
+    }
+
+    void bm_query_batch(benchmark::State &state)
+    {
+        const QueryFixture &fixture = get_fixture(static_cast<table_size_type>(state.range(0)));
+        const vector<item_type> &queries = state.range(1) ? fixture.hits : fixture.misses;
+        vector<QueryResult> out(queries.size());
+        for (auto _ : state)
+        {
+            fixture.table->query_batch(queries.data(), queries.size(), out.data());
+            benchmark::DoNotOptimize(out.data());
+            benchmark::ClobberMemory();
+        }
+        set_items_processed(state, queries.size());
+    }
+
+    /*
+    Queries items not in a table of 2^16 locations whose stash is full; the argument is the stash size. The table is
+    filled with max_probe 1 so that items overflow into the stash early.
+    */
+    void bm_query_stash_miss(benchmark::State &state)
+    {
+        const auto stash_size = static_cast<table_size_type>(state.range(0));
+        KukuTable table(1 << 16, stash_size, 2, make_random_item(), 1, make_zero_item());
+        while (table.stash().size() < stash_size && table.insert(make_random_item()))
+        {
+        }
+        const vector<item_type> misses = make_random_items(query_count);
+        for (auto _ : state)
+        {
+            for (const auto &query : misses)
+            {
+                benchmark::DoNotOptimize(table.query(query));
+            }
+        }
+        state.counters["fill_rate"] = table.fill_rate();
+        set_items_processed(state, misses.size());
+    }
+
+    BENCHMARK(bm_query_scalar)
+        ->ArgNames({ "size", "hit" })
+        ->ArgsProduct({ benchmark::CreateRange(min_bench_table_size, max_bench_table_size, 8), { 1, 0 } });
+    BENCHMARK(bm_query_batch)
+        ->ArgNames({ "size", "hit" })
+        ->ArgsProduct({ benchmark::CreateRange(min_bench_table_size, max_bench_table_size, 8), { 1, 0 } });
+    BENCHMARK(bm_query_stash_miss)->ArgName("stash")->RangeMultiplier(4)->Range(4, 1024);
+} // namespace kuku_bench
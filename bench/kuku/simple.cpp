@@ -0,0 +1,65 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "bench.h"
+#include "kuku/kuku.h"
+#include "kuku/simple.h"
+#include "benchmark/benchmark.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_bench
+{
+    /*
+    Places 2^20 items into all of their bins in a table of size 2^20 with three location functions the way it is done
+    without SimpleHashTable: with KukuTable::all_locations and a vector of bins.
+    */
+    void bm_simple_build_all_locations(benchmark::State &state)
+    {
+        const auto items = make_random_items(1 << 20);
+        KukuTable table(1 << 20, 0, 3, make_random_item(), 100, make_zero_item());
+        for (auto _ : state)
+        {
+            vector<vector<item_type>> bins(table.table_size());
+            for (const auto &item : items)
+            {
+                for (location_type loc : table.all_locations(item))
+                {
+                    bins[loc].push_back(item);
+                }
+            }
+            benchmark::DoNotOptimize(bins.data());
+        }
+        set_items_processed(state, items.size());
+    }
+
+    /*
+    Places the same items with SimpleHashTable::build; the argument is the number of threads.
+    */
+    void bm_simple_build(benchmark::State &state)
+    {
+        const auto items = make_random_items(1 << 20);
+        SimpleHashTable table(1 << 20, 3, make_random_item());
+        for (auto _ : state)
+        {
+            table.build(items.data(), items.size(), static_cast<size_t>(state.range(0)));
+            benchmark::DoNotOptimize(table.items().data());
+        }
+        state.counters["max_bin_load"] = static_cast<double>(table.max_bin_load());
+        set_items_processed(state, items.size());
+    }
+
+    BENCHMARK(bm_simple_build_all_locations)->Unit(benchmark::kMillisecond);
+
+    BENCHMARK(bm_simple_build)
+        ->ArgName("threads")
+        ->Arg(1)
+        ->Arg(2)
+        ->Arg(4)
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+} // namespace kuku_bench
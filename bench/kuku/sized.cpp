@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "bench.h"
+#include "kuku/basic.h"
+#include "benchmark/benchmark.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_bench
+{
+    /*
+    Fills an empty SizedKukuTable of ItemBytes-byte items to 80%; the argument is the table size. Compare the item
+    widths with each other and with bm_insert_batch.
+    */
+    template <size_t ItemBytes>
+    void bm_sized_fill(benchmark::State &state)
+    {
+        const auto table_size = static_cast<table_size_type>(state.range(0));
+        SizedKukuTable<ItemBytes> table(table_size, 0, 3, make_random_item(), 100, basic_item_type<ItemBytes>{});
+        const auto items = make_random_basic_items<ItemBytes>(table_size / 5 * 4);
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            table.clear_table();
+            state.ResumeTiming();
+
+            for (const auto &item : items)
+            {
+                benchmark::DoNotOptimize(table.insert(item));
+            }
+        }
+        set_items_processed(state, items.size());
+    }
+
+    /*
+    Queries items present in a half-full SizedKukuTable of ItemBytes-byte items; the argument is the table size.
+    Compare with bm_query_scalar.
+    */
+    template <size_t ItemBytes>
+    void bm_sized_query(benchmark::State &state)
+    {
+        const auto table_size = static_cast<table_size_type>(state.range(0));
+        SizedKukuTable<ItemBytes> table(table_size, 0, 3, make_random_item(), 100, basic_item_type<ItemBytes>{});
+        const auto items = make_random_basic_items<ItemBytes>(table_size / 2);
+        for (const auto &item : items)
+        {
+            (void)table.insert(item);
+        }
+
+        // Query a fixed number of items spread over the whole table
+        constexpr size_t query_count = 1 << 12;
+        vector<basic_item_type<ItemBytes>> queries;
+        for (size_t i = 0; i < query_count; i++)
+        {
+            queries.push_back(items[(i * 7919) % items.size()]);
+        }
+        for (auto _ : state)
+        {
+            for (const auto &query : queries)
+            {
+                benchmark::DoNotOptimize(table.query(query));
+            }
+        }
+        set_items_processed(state, queries.size());
+    }
+
+    BENCHMARK_TEMPLATE(bm_sized_fill, 8)
+        ->ArgName("size")
+        ->RangeMultiplier(8)
+        ->Range(min_bench_table_size, max_bench_table_size)
+        ->Unit(benchmark::kMillisecond);
+    BENCHMARK_TEMPLATE(bm_sized_fill, 16)
+        ->ArgName("size")
+        ->RangeMultiplier(8)
+        ->Range(min_bench_table_size, max_bench_table_size)
+        ->Unit(benchmark::kMillisecond);
+    BENCHMARK_TEMPLATE(bm_sized_fill, 32)
+        ->ArgName("size")
+        ->RangeMultiplier(8)
+        ->Range(min_bench_table_size, max_bench_table_size)
+        ->Unit(benchmark::kMillisecond);
+    BENCHMARK_TEMPLATE(bm_sized_query, 8)
+        ->ArgName("size")
+        ->RangeMultiplier(8)
+        ->Range(min_bench_table_size, max_bench_table_size);
+    BENCHMARK_TEMPLATE(bm_sized_query, 16)
+        ->ArgName("size")
+        ->RangeMultiplier(8)
+        ->Range(min_bench_table_size, max_bench_table_size);
+    BENCHMARK_TEMPLATE(bm_sized_query, 32)
+        ->ArgName("size")
+        ->RangeMultiplier(8)
+        ->Range(min_bench_table_size, max_bench_table_size);
+} // namespace kuku_bench
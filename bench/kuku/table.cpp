@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "bench.h"
+#include "kuku/kuku.h"
+#include "kuku/view.h"
+#include "benchmark/benchmark.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_bench
+{
+    /*
+    Constructs an empty table, which includes seeding the location functions with blake2xb and allocating the table.
+    The arguments are the table size and the location function count.
+    */
+    void bm_construct(benchmark::State &state)
+    {
+        const auto table_size = static_cast<table_size_type>(state.range(0));
+        const auto loc_func_count = static_cast<uint32_t>(state.range(1));
+        for (auto _ : state)
+        {
+            KukuTable table(table_size, 0, loc_func_count, make_random_item(), 100, make_zero_item());
+            benchmark::DoNotOptimize(table.table(0));
+        }
+    }
+
+    /*
+    Clears a table; the argument is the table size.
+    */
+    void bm_clear_table(benchmark::State &state)
+    {
+        const auto table_size = static_cast<table_size_type>(state.range(0));
+        KukuTable table(table_size, 0, 3, make_random_item(), 100, make_zero_item());
+        for (auto _ : state)
+        {
+            table.clear_table();
+            benchmark::ClobberMemory();
+        }
+        set_items_processed(state, table_size);
+    }
+
+    /*
+    Saves a table filled to 80% to a buffer; the argument is the table size.
+    */
+    void bm_save(benchmark::State &state)
+    {
+        const auto table_size = static_cast<table_size_type>(state.range(0));
+        KukuTable table(table_size, 0, 3, make_random_item(), 100, make_zero_item());
+        for (const auto &item : make_random_items(table_size / 5 * 4))
+        {
+            (void)table.insert(item);
+        }
+        vector<byte> buffer(table.save_size());
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(table.save(buffer.data(), buffer.size()));
+            benchmark::ClobberMemory();
+        }
+        set_items_processed(state, table_size);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+    }
+
+    /*
+    Loads a table filled to 80% from a buffer, which includes constructing it and verifying the checksum; the
+    argument is the table size. Compare with bm_insert_batch, which rebuilds a table of the same size.
+    */
+    void bm_load(benchmark::State &state)
+    {
+        const auto table_size = static_cast<table_size_type>(state.range(0));
+        KukuTable table(table_size, 0, 3, make_random_item(), 100, make_zero_item());
+        for (const auto &item : make_random_items(table_size / 5 * 4))
+        {
+            (void)table.insert(item);
+        }
+        vector<byte> buffer(table.save_size());
+        (void)table.save(buffer.data(), buffer.size());
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(KukuTable::load(buffer.data(), buffer.size()));
+        }
+        set_items_processed(state, table_size);
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+    }
+
+    /*
+    Maps a saved table filled to 80% from a file and queries one item, which is what a process needs to do before it
+    can serve queries; the argument is the table size. Compare with bm_load.
+    */
+    void bm_map_file(benchmark::State &state)
+    {
+        const auto table_size = static_cast<table_size_type>(state.range(0));
+        KukuTable table(table_size, 0, 3, make_random_item(), 100, make_zero_item());
+        const auto items = make_random_items(table_size / 5 * 4);
+        for (const auto &item : items)
+        {
+            (void)table.insert(item);
+        }
+        const string path = (filesystem::temp_directory_path() / "kukubench_map_file.bin").string();
+        {
+            ofstream stream(path, ios::binary);
+            (void)table.save(stream);
+        }
+        for (auto _ : state)
+        {
+            auto view = KukuTableView::map_file(path);
+            benchmark::DoNotOptimize(view->query(items[0]));
+        }
+        remove(path.c_str());
+    }
+
+    BENCHMARK(bm_construct)
+        ->ArgNames({ "size", "lfc" })
+        ->ArgsProduct({ benchmark::CreateRange(min_bench_table_size, max_bench_table_size, 16), { 2, 3, 4, 8 } })
+        ->Unit(benchmark::kMicrosecond);
+    BENCHMARK(bm_clear_table)
+        ->ArgName("size")
+        ->RangeMultiplier(16)
+        ->Range(min_bench_table_size, max_bench_table_size)
+        ->Unit(benchmark::kMicrosecond);
+    BENCHMARK(bm_save)
+        ->ArgName("size")
+        ->RangeMultiplier(16)
+        ->Range(min_bench_table_size, max_bench_table_size)
+        ->Unit(benchmark::kMicrosecond);
+    BENCHMARK(bm_load)
+        ->ArgName("size")
+        ->RangeMultiplier(16)
+        ->Range(min_bench_table_size, max_bench_table_size)
+        ->Unit(benchmark::kMicrosecond);
+    BENCHMARK(bm_map_file)
+        ->ArgName("size")
+        ->RangeMultiplier(16)
+        ->Range(min_bench_table_size, max_bench_table_size)
+        ->Unit(benchmark::kMicrosecond);
+} // namespace kuku_bench
@@ -3,6 +3,7 @@
 
 using System;
 using System.Collections.Generic;
+using System.Runtime.InteropServices;
 using System.Text;
 using System.Threading;
 
@@ -16,6 +17,9 @@ namespace Microsoft.Research.Kuku
     {
         private IntPtr _unmanagedkukuTable;
 
+        // The number of query results QueryMany receives from the native library at once.
+        private const int QueryManyChunkSize = 4096;
+
         /// <summary>Returns a <see cref="KukuTableTable"/> instance referring to the hash table.</summary>
         public KukuTableTable Table { get; }
 
@@ -106,6 +110,25 @@ namespace Microsoft.Research.Kuku
             }
         }
 
+        // Returns the number of items in a batch given as pairs of words, checking that none is the empty item.
+        private int CheckBatch(ReadOnlySpan<ulong> items)
+        {
+            if (0 != items.Length % 2)
+            {
+                throw new ArgumentException($"{nameof(items)} must hold two words per item");
+            }
+
+            (ulong emptyLow, ulong emptyHigh) = EmptyItem.Data;
+            for (int i = 0; i < items.Length; i += 2)
+            {
+                if (items[i] == emptyLow && items[i + 1] == emptyHigh)
+                {
+                    throw new ArgumentException($"{nameof(items)} cannot contain the empty item");
+                }
+            }
+            return items.Length / 2;
+        }
+
         /// <summary>
         /// Adds a single item to the hash table using random walk cuckoo hashing. The return value indicates whether
         /// the item was successfully inserted (possibly into the stash) or not.
@@ -129,6 +152,38 @@ namespace Microsoft.Research.Kuku
             return NativeMethods.KukuTable_Insert(_unmanagedkukuTable, data);
         }
 
+        /// <summary>
+        /// Adds a batch of items to the hash table in a single call into the native library. The items are given as
+        /// pairs of 64-bit words, the low word of every item first, and are inserted in order as by
+        /// <see cref="Insert"/>. Returns the number of items that were successfully inserted. If the native insertion
+        /// fails partway, the items before the failure stay inserted and are reported in results.
+        /// </summary>
+        /// <param name="items">The hash table items to insert, two words per item</param>
+        /// <param name="results">Receives whether each item was successfully inserted</param>
+        /// <exception cref="ArgumentException">if the length of items is odd, or results holds fewer elements than
+        /// there are items</exception>
+        /// <exception cref="ArgumentException">if any of the given items is the empty item for this hash table; in
+        /// this case the hash table is not modified</exception>
+        public ulong InsertMany(ReadOnlySpan<ulong> items, Span<bool> results)
+        {
+            ThrowIfDisposed();
+            int count = CheckBatch(items);
+            if (results.Length < count)
+            {
+                throw new ArgumentException($"{nameof(results)} is too short");
+            }
+            if (0 == count)
+            {
+                return 0;
+            }
+
+            return NativeMethods.KukuTable_InsertMany(
+                _unmanagedkukuTable,
+                ref MemoryMarshal.GetReference(items),
+                (ulong)count,
+                ref MemoryMarshal.GetReference(MemoryMarshal.Cast<bool, byte>(results)));
+        }
+
         /// <summary>Queries for the presence of a given item in the hash table and stash.</summary>
         /// <param name="item">The hash table item to query</param>
         /// <exception cref="ArgumentNullException">if item is null</exception>
@@ -151,6 +206,45 @@ namespace Microsoft.Research.Kuku
             return new QueryResult(queryResult);
         }
 
+        /// <summary>
+        /// Queries for the presence of a batch of items in the hash table and stash, with one call into the native
+        /// library for every 4096 items. The items are given as pairs of 64-bit words, the low word of every item
+        /// first, and the result for each item is the same as that of <see cref="Query"/>. Returns the number of items
+        /// that were found.
+        /// </summary>
+        /// <param name="items">The hash table items to query, two words per item</param>
+        /// <param name="results">Receives the result of the query for each item</param>
+        /// <exception cref="ArgumentException">if the length of items is odd, or results holds fewer elements than
+        /// there are items</exception>
+        /// <exception cref="ArgumentException">if any of the given items is the empty item for this hash
+        /// table</exception>
+        public ulong QueryMany(ReadOnlySpan<ulong> items, Span<QueryResult> results)
+        {
+            ThrowIfDisposed();
+            int count = CheckBatch(items);
+            if (results.Length < count)
+            {
+                throw new ArgumentException($"{nameof(results)} is too short");
+            }
+
+            var chunk = new QueryResultData[Math.Min(count, QueryManyChunkSize)];
+            ulong found = 0;
+            for (int begin = 0; begin < count; begin += chunk.Length)
+            {
+                int chunkSize = Math.Min(count - begin, chunk.Length);
+                found += NativeMethods.KukuTable_QueryMany(
+                    _unmanagedkukuTable,
+                    ref MemoryMarshal.GetReference(items.Slice(2 * begin)),
+                    (ulong)chunkSize,
+                    ref chunk[0]);
+                for (int i = 0; i < chunkSize; i++)
+                {
+                    results[begin + i] = new QueryResult(chunk[i]);
+                }
+            }
+            return found;
+        }
+
         /// <summary>Returns whether a given item is the empty item for this hash table.</summary>
         /// <exception cref="ArgumentNullException">if item is null</exception>
         public bool IsEmptyItem(Item item)
@@ -277,6 +371,42 @@ namespace Microsoft.Research.Kuku
             return result;
         }
 
+        /// <summary>
+        /// Computes the locations of a batch of items for all location functions in a single call into the native
+        /// library. The items are given as pairs of 64-bit words, the low word of every item first, and the location of
+        /// item i for location function j, as returned by <see cref="Location"/>, is written to
+        /// locations[i * LocFuncCount + j].
+        /// </summary>
+        /// <param name="items">The hash table items whose locations to compute, two words per item</param>
+        /// <param name="locations">Receives the locations of the items, LocFuncCount per item</param>
+        /// <exception cref="ArgumentException">if the length of items is odd, or locations holds fewer elements than
+        /// LocFuncCount per item</exception>
+        /// <exception cref="ArgumentException">if any of the given items is the empty item for this hash
+        /// table</exception>
+        /// <exception cref="InvalidOperationException">if the native library fails to compute the locations</exception>
+        public void LocationsMany(ReadOnlySpan<ulong> items, Span<uint> locations)
+        {
+            ThrowIfDisposed();
+            int count = CheckBatch(items);
+            if ((ulong)locations.Length < (ulong)count * LocFuncCount)
+            {
+                throw new ArgumentException($"{nameof(locations)} is too short");
+            }
+            if (0 == count)
+            {
+                return;
+            }
+
+            if (!NativeMethods.KukuTable_LocationsMany(
+                _unmanagedkukuTable,
+                ref MemoryMarshal.GetReference(items),
+                (ulong)count,
+                ref MemoryMarshal.GetReference(locations)))
+            {
+                throw new InvalidOperationException("Failed to compute locations in native KukuTable");
+            }
+        }
+
         /// <summary>Returns a reference to a specific location in the hash table.</summary>
         /// <param name="index">The index in the hash table</param>
         /// <exception cref="ArgumentOutOfRangeException">if index is out of range</exception>
@@ -296,6 +426,40 @@ namespace Microsoft.Research.Kuku
             }
         }
 
+        /// <summary>
+        /// Copies a range of locations in the hash table to a buffer in a single call into the native library. The
+        /// range starts at index and holds half as many locations as destination has elements; every item is written
+        /// as a pair of 64-bit words, the low word first.
+        /// </summary>
+        /// <param name="destination">The buffer to copy to, two words per location</param>
+        /// <param name="index">The index in the hash table of the first location to copy</param>
+        /// <exception cref="ArgumentException">if the length of destination is odd</exception>
+        /// <exception cref="ArgumentOutOfRangeException">if the range is out of range</exception>
+        /// <exception cref="InvalidOperationException">if the native library fails to copy the table</exception>
+        public void CopyTableTo(Span<ulong> destination, uint index = 0)
+        {
+            ThrowIfDisposed();
+            if (0 != destination.Length % 2)
+            {
+                throw new ArgumentException($"{nameof(destination)} must hold two words per location");
+            }
+            uint count = (uint)(destination.Length / 2);
+            if ((ulong)index + count > TableSize)
+            {
+                throw new ArgumentOutOfRangeException(nameof(index), "range is out of range");
+            }
+            if (0 == count)
+            {
+                return;
+            }
+
+            if (!NativeMethods.KukuTable_CopyTable(
+                _unmanagedkukuTable, index, count, ref MemoryMarshal.GetReference(destination)))
+            {
+                throw new InvalidOperationException("Failed to copy the table of native KukuTable");
+            }
+        }
+
         /// <summary>Returns the size of the hash table.</summary>
         public uint TableSize
         {
@@ -318,6 +482,39 @@ namespace Microsoft.Research.Kuku
             return Item.MakeItem((data[0], data[1]));
         }
 
+        /// <summary>
+        /// Copies a range of locations in the stash to a buffer in a single call into the native library, like
+        /// <see cref="CopyTableTo"/>.
+        /// </summary>
+        /// <param name="destination">The buffer to copy to, two words per location</param>
+        /// <param name="index">The index in the stash of the first location to copy</param>
+        /// <exception cref="ArgumentException">if the length of destination is odd</exception>
+        /// <exception cref="ArgumentOutOfRangeException">if the range is out of range</exception>
+        /// <exception cref="InvalidOperationException">if the native library fails to copy the stash</exception>
+        public void CopyStashTo(Span<ulong> destination, uint index = 0)
+        {
+            ThrowIfDisposed();
+            if (0 != destination.Length % 2)
+            {
+                throw new ArgumentException($"{nameof(destination)} must hold two words per location");
+            }
+            uint count = (uint)(destination.Length / 2);
+            if ((ulong)index + count > StashSize)
+            {
+                throw new ArgumentOutOfRangeException(nameof(index), "range is out of range");
+            }
+            if (0 == count)
+            {
+                return;
+            }
+
+            if (!NativeMethods.KukuTable_CopyStash(
+                _unmanagedkukuTable, index, count, ref MemoryMarshal.GetReference(destination)))
+            {
+                throw new InvalidOperationException("Failed to copy the stash of native KukuTable");
+            }
+        }
+
         /// <summary>Returns the size of the stash for the hash table.</summary>
         public uint StashSize
         {
@@ -33,6 +33,15 @@ namespace Microsoft.Research.Kuku
         [return: MarshalAs(UnmanagedType.I1)]
         internal static extern bool KukuTable_Query(IntPtr kuku_table, ulong[] item, ref QueryResultData query_result);
 
+        // The batch functions take the first element of a pinned buffer by reference, so that a span is passed to the
+        // native library without copying.
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern ulong KukuTable_InsertMany(IntPtr kuku_table, ref ulong items, ulong count, ref byte results);
+
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern ulong KukuTable_QueryMany(IntPtr kuku_table, ref ulong items, ulong count, ref QueryResultData query_results);
+
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         [return: MarshalAs(UnmanagedType.I1)]
         internal static extern bool KukuTable_IsEmptyItem(IntPtr kuku_table, ulong[] item);
@@ -55,18 +64,30 @@ namespace Microsoft.Research.Kuku
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         internal static extern uint KukuTable_TableSize(IntPtr kuku_table);
 
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        internal static extern bool KukuTable_CopyTable(IntPtr kuku_table, uint index, uint count, ref ulong items);
+
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         internal static extern void KukuTable_Stash(IntPtr kuku_table, uint index, ulong[] item);
 
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         internal static extern uint KukuTable_StashSize(IntPtr kuku_table);
 
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        internal static extern bool KukuTable_CopyStash(IntPtr kuku_table, uint index, uint count, ref ulong items);
+
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         internal static extern uint KukuTable_Location(IntPtr kuku_table, ulong[] item, uint loc_func_index);
 
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         internal static extern void KukuTable_AllLocations(IntPtr kuku_table, ulong[] item, uint[] locations, ref uint count);
 
+        [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
+        [return: MarshalAs(UnmanagedType.I1)]
+        internal static extern bool KukuTable_LocationsMany(IntPtr kuku_table, ref ulong items, ulong count, ref uint locations);
+
         [DllImport(DllName, CallingConvention = CallingConvention.Cdecl)]
         internal static extern void KukuTable_ClearTable(IntPtr kuku_table);
 
@@ -89,13 +110,13 @@ namespace Microsoft.Research.Kuku
         internal static extern uint Common_MaxLocFuncCount();
     }
 
+    // The flags are bytes rather than bools so that the struct is blittable, and an array of it can be passed to
+    // KukuTable_QueryMany without marshalling.
     [StructLayout(LayoutKind.Sequential)]
     internal struct QueryResultData
     {
-        [MarshalAs(UnmanagedType.I1)]
-        public bool found;
-        [MarshalAs(UnmanagedType.I1)]
-        public bool in_stash;
+        public byte found;
+        public byte in_stash;
         public uint location;
         public uint loc_func_index;
     }
@@ -20,10 +20,10 @@ namespace Microsoft.Research.Kuku
         }
 
         /// <summary>Returns whether the queried item was found in the hash table or in the stash.</summary>
-        public bool Found => _resultStruct.found;
+        public bool Found => 0 != _resultStruct.found;
 
         /// <summary>Returns whether the queried item was found in the stash.</summary>
-        public bool InStash => _resultStruct.in_stash;
+        public bool InStash => 0 != _resultStruct.in_stash;
 
         /// <summary>Returns the hash table or stash location represented by this QueryResult.</summary>
         public uint Location => _resultStruct.location;
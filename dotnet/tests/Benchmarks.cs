@@ -0,0 +1,116 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+using Microsoft.Research.Kuku;
+using Microsoft.VisualStudio.TestTools.UnitTesting;
+using System;
+using System.Diagnostics;
+
+namespace KukuNetTest
+{
+    /// <summary>
+    /// Compares the per-item API with the batch API, which crosses into the native library once per batch instead of
+    /// once per item. The timings are written to the test output. The benchmarks take several seconds, so they are
+    /// skipped unless the environment variable KUKU_NET_BENCHMARKS is set to 1; run them with
+    /// KUKU_NET_BENCHMARKS=1 dotnet test --filter TestCategory=Benchmark.
+    /// </summary>
+    [TestClass]
+    public class Benchmarks
+    {
+        private const int LogTableSize = 20;
+
+        private static void SkipUnlessEnabled()
+        {
+            if ("1" != Environment.GetEnvironmentVariable("KUKU_NET_BENCHMARKS"))
+            {
+                Assert.Inconclusive("Set KUKU_NET_BENCHMARKS=1 to run the benchmarks");
+            }
+        }
+
+        private static KukuTable CreateTable()
+        {
+            return new KukuTable(
+                new KukuTableParameters
+                {
+                    TableSize = 1 << LogTableSize,
+                    StashSize = 0,
+                    LocFuncCount = 3,
+                    LocFuncSeed = Item.MakeRandomItem(),
+                    MaxProbe = 100,
+                    EmptyItem = Item.MakeZeroItem()
+                }
+            );
+        }
+
+        private static ulong[] MakeRandomItems(int count)
+        {
+            var random = new Random();
+            var items = new ulong[2 * count];
+            for (int i = 0; i < items.Length; i++)
+            {
+                items[i] = (ulong)random.NextInt64() | 1;
+            }
+            return items;
+        }
+
+        private static void Report(string name, int count, TimeSpan perItem, TimeSpan batch)
+        {
+            Console.WriteLine(
+                $"{name}: {perItem.TotalMilliseconds * 1e6 / count:F1} ns per item one by one, " +
+                $"{batch.TotalMilliseconds * 1e6 / count:F1} ns per item in a batch " +
+                $"({perItem.TotalMilliseconds / batch.TotalMilliseconds:F1}x)");
+        }
+
+        [TestMethod]
+        [TestCategory("Benchmark")]
+        public void InsertQueryCopy()
+        {
+            SkipUnlessEnabled();
+
+            int count = (1 << LogTableSize) / 2;
+            ulong[] items = MakeRandomItems(count);
+            KukuTable perItemTable = CreateTable();
+            KukuTable batchTable = CreateTable();
+
+            var stopwatch = Stopwatch.StartNew();
+            for (int i = 0; i < count; i++)
+            {
+                perItemTable.Insert(Item.MakeItem(items[2 * i], items[2 * i + 1]));
+            }
+            TimeSpan perItem = stopwatch.Elapsed;
+            stopwatch.Restart();
+            batchTable.InsertMany(items, new bool[count]);
+            Report("Insert", count, perItem, stopwatch.Elapsed);
+
+            var results = new QueryResult[count];
+            stopwatch.Restart();
+            for (int i = 0; i < count; i++)
+            {
+                results[i] = batchTable.Query(Item.MakeItem(items[2 * i], items[2 * i + 1]));
+            }
+            perItem = stopwatch.Elapsed;
+            stopwatch.Restart();
+            ulong found = batchTable.QueryMany(items, results);
+            Report("Query", count, perItem, stopwatch.Elapsed);
+            Assert.AreEqual((ulong)count, found);
+
+            uint tableSize = batchTable.TableSize;
+            var slots = new Item[tableSize];
+            stopwatch.Restart();
+            for (uint i = 0; i < tableSize; i++)
+            {
+                slots[i] = batchTable[i];
+            }
+            perItem = stopwatch.Elapsed;
+            var table = new ulong[2 * tableSize];
+            stopwatch.Restart();
+            batchTable.CopyTableTo(table);
+            Report("Table copy", (int)tableSize, perItem, stopwatch.Elapsed);
+
+            for (uint i = 0; i < tableSize; i++)
+            {
+                Assert.AreEqual(slots[i].Data, (table[2 * i], table[2 * i + 1]));
+            }
+        }
+    }
+}
@@ -380,5 +380,103 @@ namespace KukuNetTest
             Assert.IsFalse(ct.Insert(Item.MakeItem(1, 1)));
             Assert.IsFalse(ct.Insert(Item.MakeItem(2, 2)));
         }
+
+        [TestMethod]
+        public void BatchInsertQueryCopy()
+        {
+            KukuTable ct = new KukuTable(
+                new KukuTableParameters
+                {
+                    TableSize = 1 << 12,
+                    StashSize = 4,
+                    LocFuncCount = 3,
+                    LocFuncSeed = Item.MakeRandomItem(),
+                    MaxProbe = 100,
+                    EmptyItem = Item.MakeZeroItem()
+                }
+            );
+
+            int count = 3500;
+            ulong[] items = new ulong[2 * count];
+            for (int i = 0; i < count; i++)
+            {
+                Item it = Item.MakeRandomItem();
+                (items[2 * i], items[2 * i + 1]) = it.Data;
+            }
+
+            bool[] inserted = new bool[count];
+            ulong insertedCount = ct.InsertMany(items, inserted);
+            Assert.AreEqual(insertedCount, (ulong)Array.FindAll(inserted, b => b).Length);
+            Assert.IsTrue(insertedCount > 3000);
+
+            // Items already in the table are not inserted again
+            List<ulong> present = new List<ulong>();
+            for (int i = 0; i < count; i++)
+            {
+                if (inserted[i])
+                {
+                    present.Add(items[2 * i]);
+                    present.Add(items[2 * i + 1]);
+                }
+            }
+            bool[] reinserted = new bool[present.Count / 2];
+            Assert.AreEqual(0UL, ct.InsertMany(present.ToArray(), reinserted));
+
+            QueryResult[] results = new QueryResult[count];
+            ulong foundCount = ct.QueryMany(items, results);
+            Assert.AreEqual(insertedCount, foundCount);
+            for (int i = 0; i < count; i++)
+            {
+                QueryResult res = ct.Query(Item.MakeItem(items[2 * i], items[2 * i + 1]));
+                Assert.AreEqual(inserted[i], results[i].Found);
+                Assert.AreEqual(res.Found, results[i].Found);
+                Assert.AreEqual(res.InStash, results[i].InStash);
+                Assert.AreEqual(res.Location, results[i].Location);
+                Assert.AreEqual(res.LocFuncIndex, results[i].LocFuncIndex);
+            }
+
+            uint[] locations = new uint[count * ct.LocFuncCount];
+            ct.LocationsMany(items, locations);
+            for (int i = 0; i < count; i++)
+            {
+                Item it = Item.MakeItem(items[2 * i], items[2 * i + 1]);
+                for (uint j = 0; j < ct.LocFuncCount; j++)
+                {
+                    Assert.AreEqual(ct.Location(it, j), locations[(uint)i * ct.LocFuncCount + j]);
+                }
+            }
+
+            ulong[] table = new ulong[2 * ct.TableSize];
+            ct.CopyTableTo(table);
+            for (uint i = 0; i < ct.TableSize; i++)
+            {
+                Assert.AreEqual(ct[i].Data, (table[2 * i], table[2 * i + 1]));
+            }
+            ulong[] range = new ulong[20];
+            ct.CopyTableTo(range, ct.TableSize - 10);
+            CollectionAssert.AreEqual(table[(table.Length - 20)..], range);
+
+            ulong[] stash = new ulong[2 * ct.StashSize];
+            ct.CopyStashTo(stash);
+            for (uint i = 0; i < ct.StashSize; i++)
+            {
+                Assert.AreEqual(ct.StashItem(i).Data, (stash[2 * i], stash[2 * i + 1]));
+            }
+
+            Utilities.AssertThrows<ArgumentException>(() => ct.InsertMany(new ulong[3], new bool[2]));
+            Utilities.AssertThrows<ArgumentException>(() => ct.InsertMany(items, new bool[count - 1]));
+            Utilities.AssertThrows<ArgumentException>(() => ct.QueryMany(new ulong[2], new QueryResult[1]));
+            Utilities.AssertThrows<ArgumentException>(() => ct.LocationsMany(items, new uint[locations.Length - 1]));
+            Utilities.AssertThrows<ArgumentException>(() => ct.CopyTableTo(new ulong[3]));
+            Utilities.AssertThrows<ArgumentOutOfRangeException>(() => ct.CopyTableTo(range, ct.TableSize - 9));
+            Utilities.AssertThrows<ArgumentOutOfRangeException>(() => ct.CopyStashTo(new ulong[2], ct.StashSize));
+
+            // A batch containing the empty item does not modify the table
+            ct.ClearTable();
+            items[2 * (count - 1)] = 0;
+            items[2 * (count - 1) + 1] = 0;
+            Utilities.AssertThrows<ArgumentException>(() => ct.InsertMany(items, inserted));
+            Assert.AreEqual(0.0, ct.FillRate);
+        }
     }
 }
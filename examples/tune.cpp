@@ -0,0 +1,64 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include <iomanip>
+#include <iostream>
+#include <kuku/tune.h>
+#include <string>
+
+using namespace std;
+using namespace kuku;
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc < 3 || argc > 5)
+        {
+            cout << "Usage: ./kukutune item_count failure_probability [trial_count [thread_count]]\n";
+            cout << "E.g., ./kukutune 1000000 0.01 300\n";
+            return 0;
+        }
+
+        TuneOptions options;
+        options.item_count = static_cast<size_t>(stoull(argv[1]));
+        options.failure_probability = stod(argv[2]);
+        if (argc > 3)
+        {
+            options.trial_count = static_cast<size_t>(stoull(argv[3]));
+        }
+        if (argc > 4)
+        {
+            options.thread_count = static_cast<size_t>(stoull(argv[4]));
+        }
+
+        const auto results = tune_parameters(options);
+        if (results.empty())
+        {
+            cout << "No candidate parameters hold " << options.item_count << " items\n";
+            return 1;
+        }
+
+        cout << setw(12) << "table_size" << setw(12) << "stash_size" << setw(16) << "loc_func_count" << setw(11)
+             << "max_probe" << setw(11) << "fill_rate" << setw(11) << "failures" << setw(16) << "inserts/s\n";
+        for (const auto &result : results)
+        {
+            const double fill_rate = static_cast<double>(options.item_count) /
+                                     (static_cast<double>(result.table_size) + static_cast<double>(result.stash_size));
+            cout << setw(12) << result.table_size << setw(12) << result.stash_size << setw(16)
+                 << result.loc_func_count << setw(11) << result.max_probe << setw(11) << fixed << setprecision(3)
+                 << fill_rate << setw(6) << result.failure_count << "/" << setw(4) << left << result.trial_count
+                 << right << setw(15) << setprecision(0) << result.inserts_per_second << "\n";
+        }
+
+        const auto &best = results.front();
+        cout << "\nRecommended: KukuTable(" << best.table_size << ", " << best.stash_size << ", "
+             << best.loc_func_count << ", loc_func_seed, " << best.max_probe << ", empty_item)\n";
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
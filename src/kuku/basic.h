@@ -0,0 +1,471 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "kuku/common.h"
+#include "kuku/kuku.h"
+#include "kuku/internal/hash.h"
+#include "kuku/internal/lookup.h"
+#include "kuku/internal/walk.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace kuku
+{
+    /**
+    The SizedKukuTable class represents a cuckoo hash table whose items are ItemBytes bytes wide, where ItemBytes is
+    8, 16, or 32. Both the table slots and the tabulation hashing scale with the item width: a table of 64-bit keys
+    takes half the memory and memory bandwidth of a KukuTable of the same size, and hashing an item takes 8 table
+    lookups instead of 16.
+
+    The location functions are tabulation hash functions over the ItemBytes bytes of the item, seeded like the
+    independent tabulation location functions of KukuTable; with ItemBytes equal to 16 the locations of an item are
+    identical to those in a KukuTable with the same seed. Items are inserted with the random walk cuckoo hashing of
+    KukuTable. Use BasicKukuTable<ItemBytes> to select the table type for an item width: it is KukuTable for 16-byte
+    items.
+    */
+    template <std::size_t ItemBytes>
+    class SizedKukuTable
+    {
+        static_assert(ItemBytes == 8 || ItemBytes == 16 || ItemBytes == 32, "ItemBytes must be 8, 16, or 32");
+
+    public:
+        /**
+        The type of the items stored in the hash table.
+        */
+        using item_type = basic_item_type<ItemBytes>;
+
+        /**
+        The width of the items stored in the hash table in bytes.
+        */
+        static constexpr std::size_t item_bytes = ItemBytes;
+
+        /**
+        Creates a new empty hash table.
+
+        @param[in] table_size The size of the hash table
+        @param[in] stash_size The size of the stash (possibly zero)
+        @param[in] loc_func_count The number of location functions (hash functions) to use
+        @param[in] loc_func_seed The 128-bit seed for the location functions, represented as a 16-byte hash table item
+        @param[in] max_probe The maximum number of random walk steps taken in attempting to insert an item
+        @param[in] empty_item A hash table item that represents an empty location in the table
+        @throws std::invalid_argument if loc_func_count is too large or too small
+        @throws std::invalid_argument if table_size is too large or too small
+        @throws std::invalid_argument if max_probe is zero
+        */
+        SizedKukuTable(
+            table_size_type table_size, table_size_type stash_size, std::uint32_t loc_func_count,
+            kuku::item_type loc_func_seed, std::uint64_t max_probe, item_type empty_item)
+            : hash_funcs_(validate_loc_func_count(table_size, loc_func_count), loc_func_seed), stash_index_(stash_size),
+              table_size_(table_size), stash_size_(stash_size), loc_func_seed_(loc_func_seed), max_probe_(max_probe),
+              empty_item_(empty_item), leftover_item_(empty_item_), gen_(random_uint64())
+        {
+            if (!max_probe)
+            {
+                throw std::invalid_argument("max_probe cannot be zero");
+            }
+
+            // Allocate the hash table
+            table_.resize(table_size_, empty_item_);
+
+            // Set up the distribution for location function sampling
+            u_ = std::uniform_int_distribution<std::uint32_t>(0, loc_func_count - 1);
+        }
+
+        /**
+        Adds a single item to the hash table using random walk cuckoo hashing. The return value indicates whether the
+        item was successfully inserted (possibly into the stash) or not.
+
+        @param[in] item The hash table item to insert
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] bool insert(item_type item);
+
+        /**
+        Queries for the presence of a given item in the hash table and stash.
+
+        @param[in] item The hash table item to query
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] QueryResult query(const item_type &item) const
+        {
+            if (is_empty_item(item))
+            {
+                throw std::invalid_argument("item cannot be the empty item");
+            }
+
+            std::array<location_type, max_loc_func_count> locations;
+            compute_locations(item, locations.data());
+            return query_at(item, locations.data());
+        }
+
+        /**
+        Returns a location that a given hash table item may be placed at.
+
+        @param[in] item The hash table item for which the location is to be obtained
+        @param[in] loc_func_index The index of the location function which to use to compute the location
+        @throws std::out_of_range if loc_func_index is out of range
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] location_type location(const item_type &item, std::uint32_t loc_func_index) const
+        {
+            if (loc_func_index >= loc_func_count())
+            {
+                throw std::out_of_range("loc_func_index is out of range");
+            }
+            if (is_empty_item(item))
+            {
+                throw std::invalid_argument("item cannot be the empty item");
+            }
+            return hash_funcs_(item, loc_func_index) % table_size_;
+        }
+
+        /**
+        Clears the hash table by filling every location with the empty item.
+        */
+        void clear_table() noexcept
+        {
+            std::fill(table_.begin(), table_.end(), empty_item_);
+            stash_.clear();
+            stash_index_.clear();
+            leftover_item_ = empty_item_;
+            inserted_items_ = 0;
+        }
+
+        /**
+        Returns the number of location functions used by the hash table.
+        */
+        [[nodiscard]] std::uint32_t loc_func_count() const noexcept
+        {
+            return hash_funcs_.count();
+        }
+
+        /**
+        Returns a reference to a specific location in the hash table.
+
+        @param[in] index The index in the hash table
+        @throws std::out_of_range if index is out of range
+        */
+        [[nodiscard]] const item_type &table(location_type index) const
+        {
+            if (index >= table_size_)
+            {
+                throw std::out_of_range("index is out of range");
+            }
+            return table_[index];
+        }
+
+        /**
+        Returns a reference to the hash table.
+        */
+        [[nodiscard]] const std::vector<item_type> &table() const noexcept
+        {
+            return table_;
+        }
+
+        /**
+        Returns a reference to a specific location in the stash. As in KukuTable, the stash is logically full of empty
+        slots up to stash_size(), so for indices in the range [stash().size(), stash_size()) this returns a reference
+        to the empty item.
+
+        @param[in] index The index in the stash
+        @throws std::out_of_range if index is greater than or equal to stash_size()
+        */
+        [[nodiscard]] const item_type &stash(location_type index) const
+        {
+            if (index >= stash_size_)
+            {
+                throw std::out_of_range("index is out of range");
+            }
+            if (index >= stash_.size())
+            {
+                return empty_item_;
+            }
+            return stash_[index];
+        }
+
+        /**
+        Returns a reference to the stash.
+        */
+        [[nodiscard]] const std::vector<item_type> &stash() const noexcept
+        {
+            return stash_;
+        }
+
+        /**
+        Returns the size of the hash table.
+        */
+        [[nodiscard]] table_size_type table_size() const noexcept
+        {
+            return table_size_;
+        }
+
+        /**
+        Returns the size of the stash.
+        */
+        [[nodiscard]] table_size_type stash_size() const noexcept
+        {
+            return stash_size_;
+        }
+
+        /**
+        Returns the 128-bit seed used for the location functions, represented as a 16-byte hash table item.
+        */
+        [[nodiscard]] kuku::item_type loc_func_seed() const noexcept
+        {
+            return loc_func_seed_;
+        }
+
+        /**
+        Returns the maximum number of random walk steps taken in attempting to insert an item.
+        */
+        [[nodiscard]] std::uint64_t max_probe() const noexcept
+        {
+            return max_probe_;
+        }
+
+        /**
+        Returns the hash table item that represents an empty location in the table.
+        */
+        [[nodiscard]] const item_type &empty_item() const noexcept
+        {
+            return empty_item_;
+        }
+
+        /**
+        Returns whether a given location in the table is empty.
+
+        @param[in] index The index in the hash table
+        @throws std::out_of_range if index is out of range
+        */
+        [[nodiscard]] bool is_empty(location_type index) const
+        {
+            return is_empty_item(table(index));
+        }
+
+        /**
+        Returns whether a given item is the empty item for this hash table.
+
+        @param[in] item The item to compare to the empty item
+        */
+        [[nodiscard]] bool is_empty_item(const item_type &item) const noexcept
+        {
+            return are_equal_item(item, empty_item_);
+        }
+
+        /**
+        When the insert function fails to insert a hash table item, there is a leftover item that could not be inserted
+        into the table. This function will return the empty item if insertion never failed, and otherwise it will return
+        the latest leftover item.
+        */
+        [[nodiscard]] item_type leftover_item() const noexcept
+        {
+            return leftover_item_;
+        }
+
+        /**
+        Returns the current fill rate of the hash table and stash.
+        */
+        [[nodiscard]] double fill_rate() const noexcept
+        {
+            return static_cast<double>(inserted_items_) /
+                   (static_cast<double>(table_size()) + static_cast<double>(stash_size_));
+        }
+
+        SizedKukuTable(const SizedKukuTable &copy) = delete;
+
+        SizedKukuTable &operator=(const SizedKukuTable &assign) = delete;
+
+    private:
+        /*
+        Validates the arguments of the hash function bank, which does not check them itself, and returns
+        loc_func_count.
+        */
+        static std::uint32_t validate_loc_func_count(table_size_type table_size, std::uint32_t loc_func_count)
+        {
+            if (loc_func_count < min_loc_func_count || loc_func_count > max_loc_func_count)
+            {
+                throw std::invalid_argument("loc_func_count is out of range");
+            }
+            if (table_size < min_table_size || table_size > max_table_size)
+            {
+                throw std::invalid_argument("table_size is out of range");
+            }
+            return loc_func_count;
+        }
+
+        /*
+        Computes the locations of item for all location functions into out.
+        */
+        void compute_locations(const item_type &item, location_type *out) const noexcept
+        {
+            hash_funcs_(item, out);
+            for (std::uint32_t i = 0; i < loc_func_count(); i++)
+            {
+                out[i] %= table_size_;
+            }
+        }
+
+        /*
+        Searches the given locations of item and the stash.
+        */
+        QueryResult query_at(const item_type &item, const location_type *locations) const noexcept
+        {
+            const std::uint32_t i = detail::find_at_locations(table_.data(), item, locations, loc_func_count());
+            if (i < loc_func_count())
+            {
+                return { locations[i], i };
+            }
+            const std::size_t position = stash_index_.find(stash_.data(), stash_.size(), item);
+            if (position < stash_.size())
+            {
+                return { static_cast<location_type>(position), ~static_cast<std::uint32_t>(0) };
+            }
+            return { 0, max_loc_func_count };
+        }
+
+        /*
+        The tabulation hash functions over ItemBytes bytes, one per location function.
+        */
+        const BasicHashFuncBank<ItemBytes> hash_funcs_;
+
+        /*
+        The hash table that holds all of the input data.
+        */
+        std::vector<item_type> table_;
+
+        /*
+        The stash.
+        */
+        std::vector<item_type> stash_;
+
+        /*
+        The index of the stash, used by queries instead of scanning a large stash.
+        */
+        detail::StashIndex<item_type> stash_index_;
+
+        /*
+        The size of the table.
+        */
+        const table_size_type table_size_;
+
+        /*
+        The size of the stash.
+        */
+        const table_size_type stash_size_;
+
+        /*
+        Seed for the hash functions
+        */
+        const kuku::item_type loc_func_seed_;
+
+        /*
+        The maximum number of attempts that are made to insert an item.
+        */
+        const std::uint64_t max_probe_;
+
+        /*
+        An item value that denotes an empty item.
+        */
+        const item_type empty_item_;
+
+        /*
+        Storage for an item that was evicted and could not be re-inserted. This is populated when insert fails.
+        */
+        item_type leftover_item_;
+
+        /*
+        The number of items that have been inserted to table or stash.
+        */
+        table_size_type inserted_items_ = 0;
+
+        /*
+        Randomness source for location function sampling.
+        */
+        std::mt19937_64 gen_;
+
+        std::uniform_int_distribution<std::uint32_t> u_;
+    };
+
+    template <std::size_t ItemBytes>
+    bool SizedKukuTable<ItemBytes>::insert(item_type item)
+    {
+        if (is_empty_item(item))
+        {
+            throw std::invalid_argument("item cannot be the empty item");
+        }
+
+        // Check if the item is already inserted
+        std::array<location_type, max_loc_func_count> locations;
+        compute_locations(item, locations.data());
+        if (query_at(item, locations.data()))
+        {
+            return false;
+        }
+
+        const std::uint32_t lfc = loc_func_count();
+        const std::uint64_t steps = detail::random_walk(
+            item, locations.data(), max_probe_,
+            [&](const item_type &walk_item, const location_type *walk_locations) {
+                const std::uint32_t i = detail::find_at_locations(table_.data(), empty_item_, walk_locations, lfc);
+                if (i < lfc)
+                {
+                    table_[walk_locations[i]] = walk_item;
+                    return true;
+                }
+                return false;
+            },
+            [&](item_type &walk_item, const location_type *walk_locations) {
+                std::swap(walk_item, table_[walk_locations[u_(gen_)]]);
+            },
+            [&](const item_type &walk_item, location_type *out) { compute_locations(walk_item, out); });
+        if (steps < max_probe_)
+        {
+            inserted_items_++;
+            return true;
+        }
+
+        // The walk ran out of steps; try stash
+        if (stash_.size() < stash_size_)
+        {
+            stash_.push_back(item);
+            stash_index_.add(stash_.data(), stash_.size() - 1);
+            inserted_items_++;
+            return true;
+        }
+
+        leftover_item_ = item;
+        return false;
+    }
+
+    namespace detail
+    {
+        template <std::size_t ItemBytes>
+        struct basic_kuku_table
+        {
+            using type = SizedKukuTable<ItemBytes>;
+        };
+
+        template <>
+        struct basic_kuku_table<16>
+        {
+            using type = KukuTable;
+        };
+    } // namespace detail
+
+    /**
+    The cuckoo hash table type for items of ItemBytes bytes, where ItemBytes is 8, 16, or 32. For 16-byte items this
+    is KukuTable, which keeps its full interface (batch operations, insert strategies, hash families, and saving);
+    for 8- and 32-byte items it is SizedKukuTable<ItemBytes>. Code that uses only the interface common to both, such
+    as insert, query, location, table, stash, and the accessors, works with any item width.
+    */
+    template <std::size_t ItemBytes>
+    using BasicKukuTable = typename detail::basic_kuku_table<ItemBytes>::type;
+} // namespace kuku
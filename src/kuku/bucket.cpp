@@ -0,0 +1,269 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/bucket.h"
+#include "kuku/internal/simd.h"
+#include "kuku/internal/walk.h"
+#include <algorithm>
+#include <array>
+#include <memory>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KUKU_BUCKET_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+namespace kuku
+{
+    namespace
+    {
+        table_size_type checked_bucket_count(table_size_type bucket_count, uint32_t slot_count)
+        {
+            if (slot_count != 2 && slot_count != 4 && slot_count != 8)
+            {
+                throw invalid_argument("slot_count must be 2, 4, or 8");
+            }
+            if (!bucket_count || bucket_count > max_table_size / slot_count)
+            {
+                throw invalid_argument("bucket_count is out of range");
+            }
+            return bucket_count;
+        }
+
+        /*
+        Returns the index of the lowest pair of consecutive set bits at an even position in mask, that is, the first
+        slot whose two 64-bit halves both compared equal; mask has a bit for each 64-bit lane of the bucket.
+        */
+        inline uint32_t first_equal_slot(unsigned mask, uint32_t slot_count) noexcept
+        {
+            mask &= (mask >> 1) & 0x5555U;
+            if (!mask)
+            {
+                return slot_count;
+            }
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<uint32_t>(__builtin_ctz(mask)) / 2;
+#else
+            uint32_t bit = 0;
+            for (; !(mask & 1U); mask >>= 1)
+            {
+                bit++;
+            }
+            return bit / 2;
+#endif
+        }
+
+        /*
+        The kernels below compare every slot of a bucket with the item and then pick the first match, so that a
+        bucket costs a single branch. They return the index of the first slot holding the item, or slot_count if
+        there is none.
+        */
+#ifndef KUKU_BUCKET_SSE2
+        uint32_t find_slot_scalar(const item_type *slots, uint32_t slot_count, const item_type &item) noexcept
+        {
+            for (uint32_t slot = 0; slot < slot_count; slot++)
+            {
+                if (are_equal_item(slots[slot], item))
+                {
+                    return slot;
+                }
+            }
+            return slot_count;
+        }
+#else
+        /*
+        One comparison per slot.
+        */
+        uint32_t find_slot_sse2(const item_type *slots, uint32_t slot_count, const item_type &item) noexcept
+        {
+            const __m128i key = _mm_loadu_si128(reinterpret_cast<const __m128i *>(item.data()));
+            unsigned mask = 0;
+            for (uint32_t slot = 0; slot < slot_count; slot++)
+            {
+                const __m128i bucket_slot = _mm_load_si128(reinterpret_cast<const __m128i *>(slots + slot));
+                const bool equal = _mm_movemask_epi8(_mm_cmpeq_epi8(bucket_slot, key)) == 0xFFFF;
+                mask |= static_cast<unsigned>(equal) * (3U << (2 * slot));
+            }
+            return first_equal_slot(mask, slot_count);
+        }
+#endif
+
+#ifdef KUKU_SIMD_X64
+        /*
+        One comparison per two slots.
+        */
+        KUKU_TARGET_AVX2 uint32_t find_slot_avx2(
+            const item_type *slots, uint32_t slot_count, const item_type &item) noexcept
+        {
+            const __m256i key =
+                _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(item.data())));
+            unsigned mask = 0;
+            for (uint32_t base = 0; base < slot_count; base += 2)
+            {
+                const __m256i bucket_slots = _mm256_load_si256(reinterpret_cast<const __m256i *>(slots + base));
+                mask |= static_cast<unsigned>(
+                            _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(bucket_slots, key))))
+                        << (2 * base);
+            }
+            return first_equal_slot(mask, slot_count);
+        }
+
+        /*
+        One comparison per four slots, that is, per cache line; slot_count must be 4 or 8.
+        */
+        KUKU_TARGET_AVX512 uint32_t find_slot_avx512(
+            const item_type *slots, uint32_t slot_count, const item_type &item) noexcept
+        {
+            const __m512i key = _mm512_broadcast_i32x4(_mm_loadu_si128(reinterpret_cast<const __m128i *>(item.data())));
+            unsigned mask = 0;
+            for (uint32_t base = 0; base < slot_count; base += 4)
+            {
+                mask |= static_cast<unsigned>(_mm512_cmpeq_epi64_mask(_mm512_load_si512(slots + base), key))
+                        << (2 * base);
+            }
+            return first_equal_slot(mask, slot_count);
+        }
+#endif
+    } // namespace
+
+    BucketKukuTable::BucketKukuTable(
+        table_size_type bucket_count, uint32_t slot_count, table_size_type stash_size, uint32_t loc_func_count,
+        item_type loc_func_seed, uint64_t max_probe, item_type empty_item, LocFuncMode loc_func_mode,
+        HashFamily hash_family)
+        : stash_index_(stash_size),
+          loc_funcs_(
+              checked_bucket_count(bucket_count, slot_count), loc_func_count, loc_func_seed, loc_func_mode,
+              hash_family),
+          bucket_count_(bucket_count), slot_count_(slot_count), find_slot_(select_find_slot(slot_count)),
+          stash_size_(stash_size), loc_func_seed_(loc_func_seed),
+          max_probe_(max_probe), empty_item_(empty_item), leftover_item_(empty_item_), gen_(random_uint64())
+    {
+        // The location (hash) functions have already validated loc_func_count, and the bucket count
+        if (!max_probe)
+        {
+            throw invalid_argument("max_probe cannot be zero");
+        }
+
+        // Allocate the hash table with every bucket aligned to (at least) a cache line boundary
+        const size_t size = static_cast<size_t>(table_size());
+        table_.reset(static_cast<item_type *>(
+            ::operator new[](size * sizeof(item_type), align_val_t(bucket_alignment_))));
+        uninitialized_fill_n(table_.get(), size, empty_item_);
+
+        // Set up the distributions for location function and slot sampling
+        u_ = uniform_int_distribution<uint32_t>(0, loc_func_count - 1);
+        slot_u_ = uniform_int_distribution<uint32_t>(0, slot_count - 1);
+    }
+
+    BucketKukuTable::FindSlot BucketKukuTable::select_find_slot(uint32_t slot_count) noexcept
+    {
+#ifdef KUKU_SIMD_X64
+        switch (detail::simd_level())
+        {
+        case detail::SIMDLevel::avx512:
+            return slot_count >= 4 ? find_slot_avx512 : find_slot_avx2;
+        case detail::SIMDLevel::avx2:
+            return find_slot_avx2;
+        default:
+            break;
+        }
+#else
+        (void)slot_count;
+#endif
+#ifdef KUKU_BUCKET_SSE2
+        return find_slot_sse2;
+#else
+        return find_slot_scalar;
+#endif
+    }
+
+    QueryResult BucketKukuTable::query(item_type item) const
+    {
+        if (is_empty_item(item))
+        {
+            throw invalid_argument("item cannot be the empty item");
+        }
+
+        // Search the buckets
+        array<location_type, max_loc_func_count> buckets;
+        loc_funcs_.locations(item, buckets.data());
+        for (uint32_t i = 0; i < loc_func_count(); i++)
+        {
+            const uint32_t slot = find_in_bucket(buckets[i], item);
+            if (slot < slot_count_)
+            {
+                return { buckets[i] * slot_count_ + slot, i };
+            }
+        }
+
+        // Search the stash
+        const size_t position = stash_index_.find(stash_.data(), stash_.size(), item);
+        if (position < stash_.size())
+        {
+            return { static_cast<location_type>(position), ~static_cast<uint32_t>(0) };
+        }
+
+        // Not found
+        return { 0, max_loc_func_count };
+    }
+
+    void BucketKukuTable::clear_table() noexcept
+    {
+        fill_n(table_.get(), static_cast<size_t>(table_size()), empty_item_);
+        stash_.clear();
+        stash_index_.clear();
+        leftover_item_ = empty_item_;
+        inserted_items_ = 0;
+    }
+
+    bool BucketKukuTable::insert(item_type item)
+    {
+        // Check if the item is already inserted; this also rejects the empty item
+        if (query(item))
+        {
+            return false;
+        }
+
+        const uint32_t lfc = loc_func_count();
+        array<location_type, max_loc_func_count> buckets;
+        loc_funcs_.locations(item, buckets.data());
+        const uint64_t steps = detail::random_walk(
+            item, buckets.data(), max_probe_,
+            [&](const item_type &walk_item, const location_type *walk_buckets) {
+                // Look for an empty slot in all buckets of the item
+                for (uint32_t i = 0; i < lfc; i++)
+                {
+                    const uint32_t slot = find_in_bucket(walk_buckets[i], empty_item_);
+                    if (slot < slot_count_)
+                    {
+                        table_[walk_buckets[i] * slot_count_ + slot] = walk_item;
+                        return true;
+                    }
+                }
+                return false;
+            },
+            [&](item_type &walk_item, const location_type *walk_buckets) {
+                // Swap the item into a random slot of a random bucket
+                std::swap(walk_item, table_[walk_buckets[u_(gen_)] * slot_count_ + slot_u_(gen_)]);
+            },
+            [&](const item_type &walk_item, location_type *out) { loc_funcs_.locations(walk_item, out); });
+        if (steps < max_probe_)
+        {
+            inserted_items_++;
+            return true;
+        }
+
+        // The walk ran out of steps; try stash
+        if (stash_.size() < stash_size_)
+        {
+            stash_.push_back(item);
+            stash_index_.add(stash_.data(), stash_.size() - 1);
+            inserted_items_++;
+            return true;
+        }
+
+        leftover_item_ = item;
+        return false;
+    }
+} // namespace kuku
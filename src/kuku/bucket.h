@@ -0,0 +1,332 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "kuku/common.h"
+#include "kuku/kuku.h"
+#include "kuku/locfunc.h"
+#include "kuku/internal/lookup.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace kuku
+{
+    /**
+    The BucketKukuTable class represents a bucketized cuckoo hash table. The table consists of buckets of 2, 4, or 8
+    slots, and each location function selects a bucket rather than a single slot; an item may be placed in any slot of
+    any of its buckets. Buckets are aligned so that a bucket of up to four slots occupies a single cache line, and a
+    query compares all slots of a bucket at once with SIMD instructions when available. With two location functions,
+    four slots per bucket, and a max_probe of 100, a table can typically be filled to about 92% while every query
+    touches at most two cache lines; eight slots per bucket or three location functions reach about 97%.
+
+    Slots are numbered bucket * slot_count() + slot, and query results refer to slots in this numbering.
+    */
+    class BucketKukuTable
+    {
+    public:
+        /**
+        Creates a new empty bucketized hash table.
+
+        @param[in] bucket_count The number of buckets in the hash table
+        @param[in] slot_count The number of slots per bucket; must be 2, 4, or 8
+        @param[in] stash_size The size of the stash (possibly zero)
+        @param[in] loc_func_count The number of location functions (hash functions) to use
+        @param[in] loc_func_seed The 128-bit seed for the location functions, represented as a hash table item
+        @param[in] max_probe The maximum number of random walk steps taken in attempting to insert an item
+        @param[in] empty_item A hash table item that represents an empty location in the table
+        @param[in] loc_func_mode Whether the location functions use independent hash functions or are derived from
+        two hash functions
+        @param[in] hash_family The family of the hash functions underlying the location functions
+        @throws std::invalid_argument if slot_count is not 2, 4, or 8
+        @throws std::invalid_argument if bucket_count is zero or bucket_count * slot_count is larger than allowed
+        @throws std::invalid_argument if loc_func_count is too large or too small
+        @throws std::invalid_argument if max_probe is zero
+        @throws std::invalid_argument if loc_func_mode or hash_family is invalid
+        */
+        BucketKukuTable(
+            table_size_type bucket_count, std::uint32_t slot_count, table_size_type stash_size,
+            std::uint32_t loc_func_count, item_type loc_func_seed, std::uint64_t max_probe, item_type empty_item,
+            LocFuncMode loc_func_mode = LocFuncMode::independent, HashFamily hash_family = HashFamily::tabulation);
+
+        /**
+        Adds a single item to the hash table. The item is placed in an empty slot of one of its buckets if there is
+        one; otherwise random walk cuckoo hashing evicts an item from a random slot of a random one of its buckets.
+        The return value indicates whether the item was successfully inserted (possibly into the stash) or not.
+
+        @param[in] item The hash table item to insert
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] bool insert(item_type item);
+
+        /**
+        Queries for the presence of a given item in the hash table and stash. The location of a result found in the
+        table is the slot holding the item.
+
+        @param[in] item The hash table item to query
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] QueryResult query(item_type item) const;
+
+        /**
+        Returns the bucket that a given hash table item may be placed in.
+
+        @param[in] item The hash table item for which the bucket is to be obtained
+        @param[in] loc_func_index The index of the location function which to use to compute the bucket
+        @throws std::out_of_range if loc_func_index is out of range
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] location_type bucket(item_type item, std::uint32_t loc_func_index) const
+        {
+            if (loc_func_index >= loc_func_count())
+            {
+                throw std::out_of_range("loc_func_index is out of range");
+            }
+            if (is_empty_item(item))
+            {
+                throw std::invalid_argument("item cannot be the empty item");
+            }
+            return loc_funcs_(item, loc_func_index);
+        }
+
+        /**
+        Clears the hash table by filling every slot with the empty item.
+        */
+        void clear_table() noexcept;
+
+        /**
+        Returns the number of location functions used by the hash table.
+        */
+        [[nodiscard]] std::uint32_t loc_func_count() const noexcept
+        {
+            return loc_funcs_.loc_func_count();
+        }
+
+        /**
+        Returns a reference to a specific slot in the hash table.
+
+        @param[in] index The index of the slot
+        @throws std::out_of_range if index is out of range
+        */
+        [[nodiscard]] const item_type &table(location_type index) const
+        {
+            if (index >= table_size())
+            {
+                throw std::out_of_range("index is out of range");
+            }
+            return table_[index];
+        }
+
+        /**
+        Returns a reference to the stash.
+        */
+        [[nodiscard]] const std::vector<item_type> &stash() const noexcept
+        {
+            return stash_;
+        }
+
+        /**
+        Returns the number of buckets in the hash table.
+        */
+        [[nodiscard]] table_size_type bucket_count() const noexcept
+        {
+            return bucket_count_;
+        }
+
+        /**
+        Returns the number of slots per bucket.
+        */
+        [[nodiscard]] std::uint32_t slot_count() const noexcept
+        {
+            return slot_count_;
+        }
+
+        /**
+        Returns the total number of slots in the hash table.
+        */
+        [[nodiscard]] table_size_type table_size() const noexcept
+        {
+            return bucket_count_ * slot_count_;
+        }
+
+        /**
+        Returns the size of the stash.
+        */
+        [[nodiscard]] table_size_type stash_size() const noexcept
+        {
+            return stash_size_;
+        }
+
+        /**
+        Returns the 128-bit seed used for the location functions, represented as a hash table item.
+        */
+        [[nodiscard]] item_type loc_func_seed() const noexcept
+        {
+            return loc_func_seed_;
+        }
+
+        /**
+        Returns the maximum number of random walk steps taken in attempting to insert an item.
+        */
+        [[nodiscard]] std::uint64_t max_probe() const noexcept
+        {
+            return max_probe_;
+        }
+
+        /**
+        Returns the hash table item that represents an empty location in the table.
+        */
+        [[nodiscard]] const item_type &empty_item() const noexcept
+        {
+            return empty_item_;
+        }
+
+        /**
+        Returns whether a given item is the empty item for this hash table.
+
+        @param[in] item The item to compare to the empty item
+        */
+        [[nodiscard]] bool is_empty_item(const item_type &item) const noexcept
+        {
+            return are_equal_item(item, empty_item_);
+        }
+
+        /**
+        When the insert function fails to insert a hash table item, there is a leftover item that could not be inserted
+        into the table. This function will return the empty item if insertion never failed, and otherwise it will return
+        the latest leftover item.
+        */
+        [[nodiscard]] item_type leftover_item() const noexcept
+        {
+            return leftover_item_;
+        }
+
+        /**
+        Returns the current fill rate of the hash table and stash.
+        */
+        [[nodiscard]] double fill_rate() const noexcept
+        {
+            return static_cast<double>(inserted_items_) /
+                   (static_cast<double>(table_size()) + static_cast<double>(stash_size_));
+        }
+
+        BucketKukuTable(const BucketKukuTable &copy) = delete;
+
+        BucketKukuTable &operator=(const BucketKukuTable &assign) = delete;
+
+    private:
+        /*
+        A kernel that compares the slot_count slots of a bucket with an item and returns the index of the first slot
+        holding the item, or slot_count if there is none.
+        */
+        using FindSlot = std::uint32_t (*)(
+            const item_type *slots, std::uint32_t slot_count, const item_type &item) noexcept;
+
+        /*
+        Selects the widest kernel supported by the CPU for buckets of slot_count slots: AVX-512 compares four slots
+        at a time, AVX2 two, and SSE2 one.
+        */
+        static FindSlot select_find_slot(std::uint32_t slot_count) noexcept;
+
+        /*
+        Returns the index of the first slot of the given bucket that holds the given item, or slot_count_ if there
+        is none.
+        */
+        std::uint32_t find_in_bucket(location_type bucket, const item_type &item) const noexcept
+        {
+            return find_slot_(table_.get() + static_cast<std::size_t>(bucket) * slot_count_, slot_count_, item);
+        }
+
+        /*
+        The alignment of the buckets, one cache line.
+        */
+        static constexpr std::size_t bucket_alignment_ = 64;
+
+        struct AlignedDelete
+        {
+            void operator()(item_type *table) const noexcept
+            {
+                ::operator delete[](table, std::align_val_t(bucket_alignment_));
+            }
+        };
+
+        /*
+        The hash table, bucket after bucket, aligned to bucket_alignment_.
+        */
+        std::unique_ptr<item_type[], AlignedDelete> table_;
+
+        /*
+        The stash.
+        */
+        std::vector<item_type> stash_;
+
+        /*
+        The index of the stash, used by queries instead of scanning a large stash.
+        */
+        detail::StashIndex<item_type> stash_index_;
+
+        /*
+        The hash functions, selecting buckets.
+        */
+        const LocFuncBank loc_funcs_;
+
+        /*
+        The number of buckets.
+        */
+        const table_size_type bucket_count_;
+
+        /*
+        The number of slots per bucket.
+        */
+        const std::uint32_t slot_count_;
+
+        /*
+        The bucket comparison kernel, selected at construction.
+        */
+        const FindSlot find_slot_;
+
+        /*
+        The size of the stash.
+        */
+        const table_size_type stash_size_;
+
+        /*
+        Seed for the hash functions
+        */
+        const item_type loc_func_seed_;
+
+        /*
+        The maximum number of attempts that are made to insert an item.
+        */
+        const std::uint64_t max_probe_;
+
+        /*
+        An item value that denotes an empty item.
+        */
+        const item_type empty_item_;
+
+        /*
+        Storage for an item that was evicted and could not be re-inserted. This is populated when insert fails.
+        */
+        item_type leftover_item_;
+
+        /*
+        The number of items that have been inserted to table or stash.
+        */
+        table_size_type inserted_items_ = 0;
+
+        /*
+        Randomness source for location function and slot sampling.
+        */
+        std::mt19937_64 gen_;
+
+        std::uniform_int_distribution<std::uint32_t> u_;
+
+        std::uniform_int_distribution<std::uint32_t> slot_u_;
+    };
+} // namespace kuku
@@ -2,6 +2,8 @@
 // Licensed under the MIT license.
 
 #include "kuku_ref.h"
+#include <algorithm>
+#include <array>
 #include <set>
 
 // Throwing across an extern "C" boundary is UB. Every entry point that calls
@@ -12,6 +14,36 @@
 // otherwise a null argument leads to UB before the catch block runs, defeating
 // the boundary protection.
 
+namespace
+{
+    // The batch functions convert the items from pairs of words in chunks of this many items on the stack.
+    constexpr std::size_t batch_chunk_size = 256;
+
+    void load_items(const uint64_t *words, std::size_t count, kuku::item_type *items) noexcept
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            items[i] = kuku::make_item(words[2 * i], words[2 * i + 1]);
+        }
+    }
+
+    // Returns whether any of count items, given as pairs of words, is the empty item of the table.
+    bool has_empty_item(const kuku::KukuTable &table, const uint64_t *words, std::size_t count) noexcept
+    {
+        const kuku::item_type empty_item = table.empty_item();
+        const uint64_t empty_low_word = kuku::get_low_word(empty_item);
+        const uint64_t empty_high_word = kuku::get_high_word(empty_item);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (words[2 * i] == empty_low_word && words[2 * i + 1] == empty_high_word)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+} // namespace
+
 KUKU_C_FUNC(void *) KukuTable_Create(
     uint32_t table_size, uint32_t stash_size, uint32_t loc_func_count, uint64_t *loc_func_seed, uint64_t max_probe,
     uint64_t *empty_item)
@@ -91,6 +123,88 @@ KUKU_C_FUNC(bool) KukuTable_Query(void *kuku_table, uint64_t *item, QueryResultD
     }
 }
 
+// Inserts `count` items in order, as KukuTable_Insert on each of them, and writes the success of every insertion to
+// `results`. Returns the number of items inserted. If any item is the empty item, all results are false, 0 is
+// returned, and the table is not modified. If the insertion fails with an exception, the items before the failing
+// one stay inserted with their results; the results of the failing item and all later ones are false.
+KUKU_C_FUNC(uint64_t) KukuTable_InsertMany(void *kuku_table, uint64_t *items, uint64_t count, bool *results)
+{
+    if (!count || nullptr == kuku_table || nullptr == items || nullptr == results)
+    {
+        return 0;
+    }
+
+    // insert_batch writes the result of every item once it is done with it, so on an exception the results written
+    // so far are accurate and the others stay false
+    std::fill_n(results, count, false);
+    try
+    {
+        auto *ptr = reinterpret_cast<kuku::KukuTable *>(kuku_table);
+        if (has_empty_item(*ptr, items, count))
+        {
+            return 0;
+        }
+        std::array<kuku::item_type, batch_chunk_size> kuku_items;
+        for (uint64_t begin = 0; begin < count; begin += batch_chunk_size)
+        {
+            const auto chunk_size = static_cast<std::size_t>(std::min<uint64_t>(count - begin, batch_chunk_size));
+            load_items(items + 2 * begin, chunk_size, kuku_items.data());
+            (void)ptr->insert_batch(kuku_items.data(), chunk_size, results + begin);
+        }
+    }
+    catch (...)
+    {
+        // Report the items inserted before the failure
+    }
+    return static_cast<uint64_t>(std::count(results, results + count, true));
+}
+
+// Queries for `count` items, as KukuTable_Query on each of them, and writes the result for every item to
+// `query_results`. Returns the number of items found. If any item is the empty item, or the query fails with an
+// exception, all results are zeroed and 0 is returned.
+KUKU_C_FUNC(uint64_t)
+KukuTable_QueryMany(void *kuku_table, uint64_t *items, uint64_t count, QueryResultData *query_results)
+{
+    if (!count || nullptr == kuku_table || nullptr == items || nullptr == query_results)
+    {
+        return 0;
+    }
+    try
+    {
+        auto *ptr = reinterpret_cast<kuku::KukuTable *>(kuku_table);
+        if (has_empty_item(*ptr, items, count))
+        {
+            std::fill_n(query_results, count, QueryResultData{});
+            return 0;
+        }
+        std::array<kuku::item_type, batch_chunk_size> kuku_items;
+        std::array<kuku::QueryResult, batch_chunk_size> kuku_results;
+        uint64_t found = 0;
+        for (uint64_t begin = 0; begin < count; begin += batch_chunk_size)
+        {
+            const auto chunk_size = static_cast<std::size_t>(std::min<uint64_t>(count - begin, batch_chunk_size));
+            load_items(items + 2 * begin, chunk_size, kuku_items.data());
+            ptr->query_batch(kuku_items.data(), chunk_size, kuku_results.data());
+            for (std::size_t i = 0; i < chunk_size; i++)
+            {
+                const kuku::QueryResult &res = kuku_results[i];
+                QueryResultData &query_result = query_results[begin + i];
+                query_result.found = !!res;
+                query_result.in_stash = res.in_stash();
+                query_result.location = res.location();
+                query_result.loc_func_index = res.loc_func_index();
+                found += query_result.found ? 1 : 0;
+            }
+        }
+        return found;
+    }
+    catch (...)
+    {
+        std::fill_n(query_results, count, QueryResultData{});
+        return 0;
+    }
+}
+
 KUKU_C_FUNC(bool) KukuTable_IsEmptyItem(void *kuku_table, uint64_t *item)
 {
     if (nullptr == kuku_table || nullptr == item)
@@ -203,6 +317,28 @@ KUKU_C_FUNC(void) KukuTable_Table(void *kuku_table, uint32_t index, uint64_t *it
     }
 }
 
+// Copies the `count` table locations starting at `index` to `items` as 2 * count words, the low word of every item
+// first. Returns false, without writing anything, if the range is out of bounds.
+KUKU_C_FUNC(bool) KukuTable_CopyTable(void *kuku_table, uint32_t index, uint32_t count, uint64_t *items)
+{
+    if (nullptr == kuku_table || (count && nullptr == items))
+    {
+        return false;
+    }
+    auto *ptr = reinterpret_cast<kuku::KukuTable *>(kuku_table);
+    if (static_cast<uint64_t>(index) + count > ptr->table_size())
+    {
+        return false;
+    }
+    const kuku::item_type *table = ptr->table().data() + index;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        items[2 * i] = kuku::get_low_word(table[i]);
+        items[2 * i + 1] = kuku::get_high_word(table[i]);
+    }
+    return true;
+}
+
 KUKU_C_FUNC(uint32_t) KukuTable_TableSize(void *kuku_table)
 {
     if (nullptr == kuku_table)
@@ -240,6 +376,29 @@ KUKU_C_FUNC(void) KukuTable_Stash(void *kuku_table, uint32_t index, uint64_t *it
     }
 }
 
+// Copies the `count` stash locations starting at `index` to `items` like KukuTable_CopyTable; locations past the
+// items in the stash hold the empty item, as with KukuTable_Stash.
+KUKU_C_FUNC(bool) KukuTable_CopyStash(void *kuku_table, uint32_t index, uint32_t count, uint64_t *items)
+{
+    if (nullptr == kuku_table || (count && nullptr == items))
+    {
+        return false;
+    }
+    auto *ptr = reinterpret_cast<kuku::KukuTable *>(kuku_table);
+    if (static_cast<uint64_t>(index) + count > ptr->stash_size())
+    {
+        return false;
+    }
+    const std::vector<kuku::item_type> &stash = ptr->stash();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const kuku::item_type &item = index + i < stash.size() ? stash[index + i] : ptr->empty_item();
+        items[2 * i] = kuku::get_low_word(item);
+        items[2 * i + 1] = kuku::get_high_word(item);
+    }
+    return true;
+}
+
 KUKU_C_FUNC(uint32_t) KukuTable_StashSize(void *kuku_table)
 {
     if (nullptr == kuku_table)
@@ -275,6 +434,45 @@ KUKU_C_FUNC(uint32_t) KukuTable_Location(void *kuku_table, uint64_t *item, uint3
     }
 }
 
+// Writes the location of item i for location function j to `locations[i * loc_func_count + j]`, where
+// `locations` holds `count * loc_func_count` elements, as KukuTable_Location for every item and location function.
+// Returns false, with all locations zeroed, if any item is the empty item or the computation fails with an
+// exception.
+KUKU_C_FUNC(bool) KukuTable_LocationsMany(void *kuku_table, uint64_t *items, uint64_t count, uint32_t *locations)
+{
+    if (!count)
+    {
+        return true;
+    }
+    if (nullptr == kuku_table || nullptr == items || nullptr == locations)
+    {
+        return false;
+    }
+    auto *ptr = reinterpret_cast<kuku::KukuTable *>(kuku_table);
+    const uint32_t loc_func_count = ptr->loc_func_count();
+    try
+    {
+        if (has_empty_item(*ptr, items, count))
+        {
+            std::fill_n(locations, count * loc_func_count, 0U);
+            return false;
+        }
+        std::array<kuku::item_type, batch_chunk_size> kuku_items;
+        for (uint64_t begin = 0; begin < count; begin += batch_chunk_size)
+        {
+            const auto chunk_size = static_cast<std::size_t>(std::min<uint64_t>(count - begin, batch_chunk_size));
+            load_items(items + 2 * begin, chunk_size, kuku_items.data());
+            ptr->locations(kuku_items.data(), chunk_size, locations + begin * loc_func_count);
+        }
+        return true;
+    }
+    catch (...)
+    {
+        std::fill_n(locations, count * loc_func_count, 0U);
+        return false;
+    }
+}
+
 // `count` is in/out: on entry, it is the capacity (in uint32_t elements) of
 // `locations`; on return, it is the number of locations written. If the buffer
 // is too small, no locations are written and `*count` is set to the required
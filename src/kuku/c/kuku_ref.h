@@ -58,6 +58,14 @@ KUKU_C_FUNC(bool) KukuTable_Insert(void *kuku_table, uint64_t *item);
 
 KUKU_C_FUNC(bool) KukuTable_Query(void *kuku_table, uint64_t *item, QueryResultData *query_result);
 
+// The batch functions take `count` items as 2 * count contiguous uint64_t words, the low word of every item first,
+// and process the whole batch in one call with the batch functions of KukuTable.
+
+KUKU_C_FUNC(uint64_t) KukuTable_InsertMany(void *kuku_table, uint64_t *items, uint64_t count, bool *results);
+
+KUKU_C_FUNC(uint64_t)
+KukuTable_QueryMany(void *kuku_table, uint64_t *items, uint64_t count, QueryResultData *query_results);
+
 KUKU_C_FUNC(bool) KukuTable_IsEmptyItem(void *kuku_table, uint64_t *item);
 
 KUKU_C_FUNC(void) KukuTable_EmptyItem(void *kuku_table, uint64_t *item);
@@ -70,14 +78,20 @@ KUKU_C_FUNC(uint32_t) KukuTable_LocFuncCount(void *kuku_table);
 
 KUKU_C_FUNC(void) KukuTable_Table(void *kuku_table, uint32_t index, uint64_t *item);
 
+KUKU_C_FUNC(bool) KukuTable_CopyTable(void *kuku_table, uint32_t index, uint32_t count, uint64_t *items);
+
 KUKU_C_FUNC(uint32_t) KukuTable_TableSize(void *kuku_table);
 
 KUKU_C_FUNC(void) KukuTable_Stash(void *kuku_table, uint32_t index, uint64_t *item);
 
+KUKU_C_FUNC(bool) KukuTable_CopyStash(void *kuku_table, uint32_t index, uint32_t count, uint64_t *items);
+
 KUKU_C_FUNC(uint32_t) KukuTable_StashSize(void *kuku_table);
 
 KUKU_C_FUNC(uint32_t) KukuTable_Location(void *kuku_table, uint64_t *item, uint32_t loc_func_index);
 
+KUKU_C_FUNC(bool) KukuTable_LocationsMany(void *kuku_table, uint64_t *items, uint64_t count, uint32_t *locations);
+
 KUKU_C_FUNC(void) KukuTable_AllLocations(void *kuku_table, uint64_t *item, uint32_t *locations, uint32_t *count);
 
 KUKU_C_FUNC(void) KukuTable_ClearTable(void *kuku_table);
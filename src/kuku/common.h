@@ -25,10 +25,16 @@
 
 namespace kuku
 {
+    /**
+    The type that represents an item of ItemBytes bytes that can be added to a BasicKukuTable<ItemBytes>.
+    */
+    template <std::size_t ItemBytes>
+    using basic_item_type = std::array<unsigned char, ItemBytes>;
+
     /**
     The type that represents a 128-bit item that can be added to the hash table.
     */
-    using item_type = std::array<unsigned char, 16>;
+    using item_type = basic_item_type<16>;
 
     /**
     The type that represents a location in the hash table.
@@ -237,6 +243,31 @@ namespace kuku
         return (get_low_word(in1) == get_low_word(in2)) && (get_high_word(in1) == get_high_word(in2));
     }
 
+    /**
+    Returns whether two hash table items of any width are equal.
+
+    @param[in] in1 The first hash table item
+    @param[in] in2 The second hash table item
+    */
+    template <std::size_t ItemBytes>
+    inline bool are_equal_item(const basic_item_type<ItemBytes> &in1, const basic_item_type<ItemBytes> &in2) noexcept
+    {
+        return !std::memcmp(in1.data(), in2.data(), ItemBytes);
+    }
+
+    /**
+    Creates a new hash table item of ItemBytes bytes and sets its value from a given buffer.
+
+    @param[in] in The buffer of ItemBytes bytes to set the value from
+    */
+    template <std::size_t ItemBytes>
+    inline basic_item_type<ItemBytes> make_item(const unsigned char *in) noexcept
+    {
+        basic_item_type<ItemBytes> out;
+        std::memcpy(out.data(), in, ItemBytes);
+        return out;
+    }
+
     /**
     Sets a given hash table item to a random value.
 
@@ -260,6 +291,24 @@ namespace kuku
         return out;
     }
 
+    /**
+    Creates a random hash table item of ItemBytes bytes.
+
+    @throws std::exception derived if the underlying std::random_device fails
+    */
+    template <std::size_t ItemBytes>
+    inline basic_item_type<ItemBytes> make_random_item()
+    {
+        static_assert(ItemBytes % bytes_per_uint64 == 0, "ItemBytes must be a multiple of 8");
+        basic_item_type<ItemBytes> out;
+        for (std::size_t i = 0; i < ItemBytes; i += bytes_per_uint64)
+        {
+            const std::uint64_t word = random_uint64();
+            std::memcpy(out.data() + i, &word, sizeof(word));
+        }
+        return out;
+    }
+
     /**
     Interprets a hash table item as a 128-bit integer and increments its value by one.
 
@@ -0,0 +1,403 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/concurrent.h"
+#include <algorithm>
+#include <thread>
+
+using namespace std;
+
+namespace kuku
+{
+    ConcurrentKukuTable::StripeLock::StripeLock(
+        const ConcurrentKukuTable &table, const location_type *locations, uint32_t count)
+        : table_(table)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            stripes_[i] = table_.stripe(locations[i]);
+        }
+        sort(stripes_.begin(), stripes_.begin() + count);
+        stripe_count_ = static_cast<uint32_t>(unique(stripes_.begin(), stripes_.begin() + count) - stripes_.begin());
+        for (uint32_t i = 0; i < stripe_count_; i++)
+        {
+            table_.stripes_[stripes_[i]].mutex.lock();
+        }
+    }
+
+    ConcurrentKukuTable::StripeLock::~StripeLock()
+    {
+        for (uint32_t i = stripe_count_; i > 0; i--)
+        {
+            table_.stripes_[stripes_[i - 1]].mutex.unlock();
+        }
+    }
+
+    ConcurrentKukuTable::ConcurrentKukuTable(
+        table_size_type table_size, table_size_type stash_size, uint32_t loc_func_count, item_type loc_func_seed,
+        uint64_t max_probe, item_type empty_item, LocFuncMode loc_func_mode, HashFamily hash_family)
+        : loc_funcs_(table_size, loc_func_count, loc_func_seed, loc_func_mode, hash_family), table_size_(table_size),
+          stash_size_(stash_size), loc_func_seed_(loc_func_seed), max_probe_(max_probe), empty_item_(empty_item)
+    {
+        // The location (hash) functions have already validated loc_func_count and table_size
+        if (!max_probe)
+        {
+            throw invalid_argument("max_probe cannot be zero");
+        }
+
+        // The largest power of two not exceeding the table size, up to max_stripe_count_
+        size_t stripe_count = 1;
+        while (stripe_count < max_stripe_count_ && 2 * stripe_count <= table_size_)
+        {
+            stripe_count *= 2;
+        }
+        stripes_.reset(new Stripe[stripe_count]);
+        stripe_mask_ = stripe_count - 1;
+
+        // Allocate the hash table and the stash
+        words_.reset(new atomic<uint64_t>[2 * static_cast<size_t>(table_size_)]);
+        stash_words_.reset(new atomic<uint64_t>[2 * static_cast<size_t>(stash_size_)]);
+        clear_table();
+    }
+
+    void ConcurrentKukuTable::clear_table() noexcept
+    {
+        for (location_type loc = 0; loc < table_size_; loc++)
+        {
+            store(loc, empty_item_);
+        }
+        stash_count_.store(0, memory_order_relaxed);
+        inserted_items_.store(0, memory_order_relaxed);
+    }
+
+    item_type ConcurrentKukuTable::table(location_type index) const
+    {
+        if (index >= table_size_)
+        {
+            throw out_of_range("index is out of range");
+        }
+        uint64_t version;
+        for (;;)
+        {
+            if (!read_begin(&index, 1, &version))
+            {
+                continue;
+            }
+            const item_type item = load(index);
+            if (read_validate(&index, 1, &version))
+            {
+                return item;
+            }
+        }
+    }
+
+    vector<item_type> ConcurrentKukuTable::stash() const
+    {
+        const table_size_type count = stash_count_.load(memory_order_acquire);
+        vector<item_type> stash;
+        stash.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            stash.push_back(make_item(
+                stash_words_[2 * i].load(memory_order_relaxed), stash_words_[2 * i + 1].load(memory_order_relaxed)));
+        }
+        return stash;
+    }
+
+    bool ConcurrentKukuTable::read_begin(
+        const location_type *locations, uint32_t count, uint64_t *versions) const noexcept
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            versions[i] = stripes_[stripe(locations[i])].version.load(memory_order_acquire);
+            if (versions[i] & 1)
+            {
+                // A writer holds the stripe for a few instructions only; let it finish if it shares our core
+                this_thread::yield();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ConcurrentKukuTable::read_validate(
+        const location_type *locations, uint32_t count, const uint64_t *versions) const noexcept
+    {
+        atomic_thread_fence(memory_order_acquire);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            if (stripes_[stripe(locations[i])].version.load(memory_order_relaxed) != versions[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    QueryResult ConcurrentKukuTable::query(item_type item) const
+    {
+        if (is_empty_item(item))
+        {
+            throw invalid_argument("item cannot be the empty item");
+        }
+
+        array<location_type, max_loc_func_count> locations;
+        loc_funcs_.locations(item, locations.data());
+
+        // Search the hash table; the item can only move between its own locations, so if none of their stripes
+        // was written during the search, the result is exact
+        const uint32_t lfc = loc_func_count();
+        array<uint64_t, max_loc_func_count> versions;
+        for (;;)
+        {
+            if (!read_begin(locations.data(), lfc, versions.data()))
+            {
+                continue;
+            }
+            uint32_t found = lfc;
+            for (uint32_t i = 0; i < lfc; i++)
+            {
+                if (are_equal_item(load(locations[i]), item))
+                {
+                    found = i;
+                    break;
+                }
+            }
+            if (!read_validate(locations.data(), lfc, versions.data()))
+            {
+                continue;
+            }
+            if (found < lfc)
+            {
+                return { locations[found], found };
+            }
+            break;
+        }
+
+        // Search the stash; stashed items never move
+        const table_size_type stash_count = stash_count_.load(memory_order_acquire);
+        const table_size_type loc = find_in_stash(item, stash_count);
+        if (loc < stash_count)
+        {
+            return { loc, ~static_cast<uint32_t>(0) };
+        }
+
+        // Not found
+        return { 0, max_loc_func_count };
+    }
+
+    bool ConcurrentKukuTable::insert(item_type item)
+    {
+        if (is_empty_item(item))
+        {
+            throw invalid_argument("item cannot be the empty item");
+        }
+
+        array<location_type, max_loc_func_count> locations;
+        loc_funcs_.locations(item, locations.data());
+        for (int attempt = 0; attempt < max_attempts_; attempt++)
+        {
+            switch (try_insert(item, locations.data()))
+            {
+            case Attempt::inserted:
+                return true;
+            case Attempt::duplicate:
+                return false;
+            case Attempt::retry:
+                continue;
+            case Attempt::exhausted:
+                return insert_stash(item, locations.data());
+            }
+        }
+        return insert_stash(item, locations.data());
+    }
+
+    bool ConcurrentKukuTable::move(location_type from, location_type to, const item_type &item)
+    {
+        const array<location_type, 2> locations{ from, to };
+        StripeLock lock(*this, locations.data(), 2);
+        if (!are_equal_item(load(from), item) || !is_empty_item(load(to)))
+        {
+            return false;
+        }
+
+        // Copy before clearing, so that the item is never absent from the table
+        store(to, item);
+        store(from, empty_item_);
+        return true;
+    }
+
+    ConcurrentKukuTable::Attempt ConcurrentKukuTable::try_insert(
+        const item_type &item, const location_type *locations)
+    {
+        const uint32_t lfc = loc_func_count();
+        {
+            StripeLock lock(*this, locations, lfc);
+            if (contains_locked(item, locations))
+            {
+                return Attempt::duplicate;
+            }
+            for (uint32_t i = 0; i < lfc; i++)
+            {
+                if (is_empty_item(load(locations[i])))
+                {
+                    store(locations[i], item);
+                    inserted_items_.fetch_add(1, memory_order_relaxed);
+                    return Attempt::inserted;
+                }
+            }
+        }
+
+        // Search for a chain of moves without holding any locks; the search state is kept per thread, and released
+        // after a search that outgrew bfs_retained_nodes_ so that an idle thread does not hold on to it
+        thread_local vector<BFSNode> nodes;
+        struct ReleaseNodes
+        {
+            ~ReleaseNodes()
+            {
+                if (nodes.capacity() > bfs_retained_nodes_)
+                {
+                    nodes = vector<BFSNode>();
+                }
+            }
+        } release_nodes;
+        const uint64_t max_expansions = min<uint64_t>(max_probe_, table_size_);
+        const size_t max_nodes =
+            static_cast<size_t>(min<uint64_t>(max_expansions * (lfc - 1) + lfc, bfs_no_parent_));
+        nodes.clear();
+        nodes.reserve(min(max_nodes, bfs_retained_nodes_));
+        for (uint32_t i = 0; i < lfc; i++)
+        {
+            if (find(locations, locations + i, locations[i]) == locations + i)
+            {
+                nodes.push_back({ locations[i], bfs_no_parent_, load(locations[i]) });
+            }
+        }
+
+        auto on_path = [&](uint32_t node, location_type loc) {
+            for (; node != bfs_no_parent_; node = nodes[node].parent)
+            {
+                if (nodes[node].location == loc)
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        array<location_type, max_loc_func_count> alt_locations;
+        for (uint32_t head = 0; head < nodes.size() && head < max_expansions; head++)
+        {
+            const BFSNode node = nodes[head];
+            if (is_empty_item(node.item))
+            {
+                // A location read as empty was filled concurrently, or a root was emptied; search again
+                return Attempt::retry;
+            }
+
+            loc_funcs_.locations(node.item, alt_locations.data());
+            for (uint32_t i = 0; i < lfc; i++)
+            {
+                const location_type loc = alt_locations[i];
+                if (loc == node.location || on_path(head, loc))
+                {
+                    continue;
+                }
+
+                const item_type occupant = load(loc);
+                if (is_empty_item(occupant))
+                {
+                    // Perform the moves from the empty end of the chain back to the root
+                    location_type to = loc;
+                    for (uint32_t n = head; n != bfs_no_parent_; n = nodes[n].parent)
+                    {
+                        if (!move(nodes[n].location, to, nodes[n].item))
+                        {
+                            return Attempt::retry;
+                        }
+                        to = nodes[n].location;
+                    }
+
+                    // The root is now free unless another thread took it
+                    StripeLock lock(*this, locations, lfc);
+                    if (contains_locked(item, locations))
+                    {
+                        return Attempt::duplicate;
+                    }
+                    if (!is_empty_item(load(to)))
+                    {
+                        return Attempt::retry;
+                    }
+                    store(to, item);
+                    inserted_items_.fetch_add(1, memory_order_relaxed);
+                    return Attempt::inserted;
+                }
+
+                if (nodes.size() < max_nodes)
+                {
+                    nodes.push_back({ loc, head, occupant });
+                }
+            }
+        }
+        return Attempt::exhausted;
+    }
+
+    table_size_type ConcurrentKukuTable::find_in_stash(
+        const item_type &item, table_size_type stash_count) const noexcept
+    {
+        for (table_size_type loc = 0; loc < stash_count; loc++)
+        {
+            if (get_low_word(item) == stash_words_[2 * static_cast<size_t>(loc)].load(memory_order_relaxed) &&
+                get_high_word(item) == stash_words_[2 * static_cast<size_t>(loc) + 1].load(memory_order_relaxed))
+            {
+                return loc;
+            }
+        }
+        return stash_count;
+    }
+
+    bool ConcurrentKukuTable::contains_locked(const item_type &item, const location_type *locations) const noexcept
+    {
+        for (uint32_t i = 0; i < loc_func_count(); i++)
+        {
+            if (are_equal_item(load(locations[i]), item))
+            {
+                return true;
+            }
+        }
+
+        // An item is stashed only while its stripes are held, so the stash count read here covers every stash
+        // insert of this item that completed before the stripes were acquired
+        const table_size_type stash_count = stash_count_.load(memory_order_acquire);
+        return find_in_stash(item, stash_count) < stash_count;
+    }
+
+    bool ConcurrentKukuTable::insert_stash(const item_type &item, const location_type *locations)
+    {
+        // Hold the stripes of the item so that it cannot be placed in the table concurrently
+        StripeLock table_lock(*this, locations, loc_func_count());
+        for (uint32_t i = 0; i < loc_func_count(); i++)
+        {
+            if (are_equal_item(load(locations[i]), item))
+            {
+                return false;
+            }
+        }
+
+        lock_guard<mutex> lock(stash_mutex_);
+        const table_size_type stash_count = stash_count_.load(memory_order_relaxed);
+        if (find_in_stash(item, stash_count) < stash_count)
+        {
+            return false;
+        }
+        if (stash_count < stash_size_)
+        {
+            stash_words_[2 * static_cast<size_t>(stash_count)].store(get_low_word(item), memory_order_relaxed);
+            stash_words_[2 * static_cast<size_t>(stash_count) + 1].store(get_high_word(item), memory_order_relaxed);
+            stash_count_.store(stash_count + 1, memory_order_release);
+            inserted_items_.fetch_add(1, memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+} // namespace kuku
@@ -0,0 +1,413 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "kuku/common.h"
+#include "kuku/kuku.h"
+#include "kuku/locfunc.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace kuku
+{
+    /**
+    The ConcurrentKukuTable class represents a cuckoo hash table that any number of threads may insert into and query
+    at the same time. Table locations are protected by a fixed number of striped locks: location i belongs to stripe
+    i % stripe_count().
+
+    An insert first tries to place the item at one of its empty locations while holding the locks of all of them.
+    Otherwise it searches breadth-first, without holding any locks, for a chain of moves that ends at an empty location
+    (as KukuTable with InsertStrategy::bfs does), and then performs the moves from the empty end of the chain backwards.
+    Every move locks only the two stripes involved, copies the item to its new location before clearing the old one,
+    and is validated first, so a chain invalidated by another thread is abandoned and the search repeated. There is no
+    shared random number generator; the only shared counter is the atomic number of inserted items.
+
+    Queries never take a lock. Every stripe has a version counter that a writer makes odd before and even again after
+    each write to a location of the stripe (a seqlock). A query reads the versions of the stripes of all locations of
+    the queried item, reads the locations, and starts over if any of the versions was odd or has changed since. Since
+    an item is only ever moved between its own locations, a query that sees no write to them cannot miss it, so
+    readers running alongside one or more writers never report a false miss.
+
+    Items that cannot be placed in the table go to the stash, which has a lock of its own for writers and is also read
+    without locking. Unlike KukuTable, a failed insert never moves an item out of the table, so the leftover item is
+    always the item passed to insert.
+    */
+    class ConcurrentKukuTable
+    {
+    public:
+        /**
+        Creates a new empty concurrent hash table.
+
+        @param[in] table_size The size of the hash table
+        @param[in] stash_size The size of the stash (possibly zero)
+        @param[in] loc_func_count The number of location functions (hash functions) to use
+        @param[in] loc_func_seed The 128-bit seed for the location functions, represented as a hash table item
+        @param[in] max_probe The maximum number of items expanded by the breadth-first search in attempting to insert
+        an item
+        @param[in] empty_item A hash table item that represents an empty location in the table
+        @param[in] loc_func_mode Whether the location functions use independent hash functions or are derived from
+        two hash functions
+        @param[in] hash_family The family of the hash functions underlying the location functions
+        @throws std::invalid_argument if loc_func_count is too large or too small
+        @throws std::invalid_argument if table_size is too large or too small
+        @throws std::invalid_argument if max_probe is zero
+        @throws std::invalid_argument if loc_func_mode or hash_family is invalid
+        */
+        ConcurrentKukuTable(
+            table_size_type table_size, table_size_type stash_size, std::uint32_t loc_func_count,
+            item_type loc_func_seed, std::uint64_t max_probe, item_type empty_item,
+            LocFuncMode loc_func_mode = LocFuncMode::independent, HashFamily hash_family = HashFamily::tabulation);
+
+        /**
+        Adds a single item to the hash table. The return value indicates whether the item was successfully inserted
+        (possibly into the stash) or not; it is false if the item is already in the table. Thread-safe.
+
+        @param[in] item The hash table item to insert
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] bool insert(item_type item);
+
+        /**
+        Queries for the presence of a given item in the hash table and stash. Thread-safe and lock-free; retries
+        while a location of the item is being written.
+
+        @param[in] item The hash table item to query
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] QueryResult query(item_type item) const;
+
+        /**
+        Returns a location that a given hash table item may be placed at.
+
+        @param[in] item The hash table item for which the location is to be obtained
+        @param[in] loc_func_index The index of the location function which to use to compute the location
+        @throws std::out_of_range if loc_func_index is out of range
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] location_type location(item_type item, std::uint32_t loc_func_index) const
+        {
+            if (loc_func_index >= loc_func_count())
+            {
+                throw std::out_of_range("loc_func_index is out of range");
+            }
+            if (is_empty_item(item))
+            {
+                throw std::invalid_argument("item cannot be the empty item");
+            }
+            return loc_funcs_(item, loc_func_index);
+        }
+
+        /**
+        Clears the hash table by filling every location with the empty item. Must not be called concurrently with
+        any other member function.
+        */
+        void clear_table() noexcept;
+
+        /**
+        Returns the number of location functions used by the hash table.
+        */
+        [[nodiscard]] std::uint32_t loc_func_count() const noexcept
+        {
+            return loc_funcs_.loc_func_count();
+        }
+
+        /**
+        Returns the item at a specific location in the hash table. Thread-safe and lock-free.
+
+        @param[in] index The index in the hash table
+        @throws std::out_of_range if index is out of range
+        */
+        [[nodiscard]] item_type table(location_type index) const;
+
+        /**
+        Returns a copy of the items in the stash. Thread-safe.
+        */
+        [[nodiscard]] std::vector<item_type> stash() const;
+
+        /**
+        Returns the size of the hash table.
+        */
+        [[nodiscard]] table_size_type table_size() const noexcept
+        {
+            return table_size_;
+        }
+
+        /**
+        Returns the size of the stash.
+        */
+        [[nodiscard]] table_size_type stash_size() const noexcept
+        {
+            return stash_size_;
+        }
+
+        /**
+        Returns the number of lock stripes protecting the table locations.
+        */
+        [[nodiscard]] std::size_t stripe_count() const noexcept
+        {
+            return stripe_mask_ + 1;
+        }
+
+        /**
+        Returns the 128-bit seed used for the location functions, represented as a hash table item.
+        */
+        [[nodiscard]] item_type loc_func_seed() const noexcept
+        {
+            return loc_func_seed_;
+        }
+
+        /**
+        Returns the maximum number of items expanded by the breadth-first search in attempting to insert an item.
+        */
+        [[nodiscard]] std::uint64_t max_probe() const noexcept
+        {
+            return max_probe_;
+        }
+
+        /**
+        Returns the hash table item that represents an empty location in the table.
+        */
+        [[nodiscard]] const item_type &empty_item() const noexcept
+        {
+            return empty_item_;
+        }
+
+        /**
+        Returns whether a given item is the empty item for this hash table.
+
+        @param[in] item The item to compare to the empty item
+        */
+        [[nodiscard]] bool is_empty_item(const item_type &item) const noexcept
+        {
+            return are_equal_item(item, empty_item_);
+        }
+
+        /**
+        Returns the current fill rate of the hash table and stash. Thread-safe.
+        */
+        [[nodiscard]] double fill_rate() const noexcept
+        {
+            return static_cast<double>(inserted_items_.load(std::memory_order_relaxed)) /
+                   (static_cast<double>(table_size_) + static_cast<double>(stash_size_));
+        }
+
+        ConcurrentKukuTable(const ConcurrentKukuTable &copy) = delete;
+
+        ConcurrentKukuTable &operator=(const ConcurrentKukuTable &assign) = delete;
+
+    private:
+        /*
+        The outcome of one attempt to insert an item.
+        */
+        enum class Attempt
+        {
+            // The item was placed in the table
+            inserted,
+
+            // The item was already in the table or stash
+            duplicate,
+
+            // A chain was found but invalidated by another thread before it was completed
+            retry,
+
+            // No chain was found within max_probe expansions
+            exhausted
+        };
+
+        /*
+        Makes one attempt to place an item, whose locations have already been computed, in the table.
+        */
+        Attempt try_insert(const item_type &item, const location_type *locations);
+
+        /*
+        Returns the position of an item among the first stash_count items of the stash, or stash_count if it is not
+        there.
+        */
+        table_size_type find_in_stash(const item_type &item, table_size_type stash_count) const noexcept;
+
+        /*
+        Returns whether an item is at one of its locations or in the stash. The caller holds the stripes of the
+        locations, which keeps the item from being placed or stashed concurrently.
+        */
+        bool contains_locked(const item_type &item, const location_type *locations) const noexcept;
+
+        /*
+        Places an item that could not be placed in the table into the stash if it is not full.
+        */
+        bool insert_stash(const item_type &item, const location_type *locations);
+
+        /*
+        A location in the breadth-first search tree of try_insert with the item read from it during the search, and
+        the index of its parent; the roots are the locations of the item being inserted.
+        */
+        struct BFSNode
+        {
+            location_type location;
+
+            std::uint32_t parent;
+
+            item_type item;
+        };
+
+        static constexpr std::uint32_t bfs_no_parent_ = ~std::uint32_t(0);
+
+        /*
+        The largest number of search nodes a thread keeps allocated between calls to try_insert; a larger search
+        allocates its nodes as it grows and frees them when it ends.
+        */
+        static constexpr std::size_t bfs_retained_nodes_ = std::size_t(1) << 12;
+
+        /*
+        Moves an item from one location to another if the item is still at from and to is still empty.
+        */
+        bool move(location_type from, location_type to, const item_type &item);
+
+        /*
+        A mutex and the seqlock version of its locations, padded to their own cache line so that neighboring stripes
+        do not share one. The version is odd while a location of the stripe is being written.
+        */
+        struct alignas(64) Stripe
+        {
+            std::mutex mutex;
+
+            std::atomic<std::uint64_t> version{ 0 };
+        };
+
+        /*
+        Locks the stripes of a set of locations in increasing order, so that lockers cannot deadlock, and unlocks
+        them on destruction.
+        */
+        class StripeLock
+        {
+        public:
+            StripeLock(const ConcurrentKukuTable &table, const location_type *locations, std::uint32_t count);
+
+            ~StripeLock();
+
+            StripeLock(const StripeLock &copy) = delete;
+
+            StripeLock &operator=(const StripeLock &assign) = delete;
+
+        private:
+            const ConcurrentKukuTable &table_;
+
+            std::array<std::size_t, max_loc_func_count> stripes_;
+
+            std::uint32_t stripe_count_ = 0;
+        };
+
+        std::size_t stripe(location_type location) const noexcept
+        {
+            return static_cast<std::size_t>(location) & stripe_mask_;
+        }
+
+        /*
+        Reads and writes a table location; each location is stored as two atomic 64-bit words so that the lock-free
+        reads are well defined. A read without the stripe lock may be torn, which only causes a later validation to
+        fail. A write must hold the stripe lock of the location and advances the version of the stripe.
+        */
+        item_type load(location_type location) const noexcept
+        {
+            return make_item(
+                words_[2 * static_cast<std::size_t>(location)].load(std::memory_order_relaxed),
+                words_[2 * static_cast<std::size_t>(location) + 1].load(std::memory_order_relaxed));
+        }
+
+        void store(location_type location, const item_type &item) noexcept
+        {
+            std::atomic<std::uint64_t> &version = stripes_[stripe(location)].version;
+            const std::uint64_t start = version.load(std::memory_order_relaxed);
+            version.store(start + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            words_[2 * static_cast<std::size_t>(location)].store(get_low_word(item), std::memory_order_relaxed);
+            words_[2 * static_cast<std::size_t>(location) + 1].store(get_high_word(item), std::memory_order_relaxed);
+            version.store(start + 2, std::memory_order_release);
+        }
+
+        /*
+        Begins a lock-free read of a set of locations by recording the versions of their stripes; returns false if
+        any of the stripes is being written.
+        */
+        bool read_begin(const location_type *locations, std::uint32_t count, std::uint64_t *versions) const noexcept;
+
+        /*
+        Returns whether none of the stripes recorded by read_begin has been written since, so that everything read
+        in between is consistent.
+        */
+        bool read_validate(
+            const location_type *locations, std::uint32_t count, const std::uint64_t *versions) const noexcept;
+
+        /*
+        The maximum number of stripes; tables smaller than this use one stripe per location.
+        */
+        static constexpr std::size_t max_stripe_count_ = std::size_t(1) << 12;
+
+        /*
+        The number of times an insert whose chain was invalidated searches again before giving up on the table.
+        */
+        static constexpr int max_attempts_ = 16;
+
+        /*
+        The hash table, two words per location.
+        */
+        std::unique_ptr<std::atomic<std::uint64_t>[]> words_;
+
+        /*
+        The stash, two words per item, and the number of items in it. Writers hold the lock; the count is published
+        after the item so that lock-free readers never see an incomplete item.
+        */
+        std::unique_ptr<std::atomic<std::uint64_t>[]> stash_words_;
+
+        std::atomic<table_size_type> stash_count_{ 0 };
+
+        std::mutex stash_mutex_;
+
+        /*
+        The lock stripes.
+        */
+        std::unique_ptr<Stripe[]> stripes_;
+
+        std::size_t stripe_mask_ = 0;
+
+        /*
+        The hash functions.
+        */
+        const LocFuncBank loc_funcs_;
+
+        /*
+        The size of the table.
+        */
+        const table_size_type table_size_;
+
+        /*
+        The size of the stash.
+        */
+        const table_size_type stash_size_;
+
+        /*
+        Seed for the hash functions
+        */
+        const item_type loc_func_seed_;
+
+        /*
+        The maximum number of items expanded in attempting to insert an item.
+        */
+        const std::uint64_t max_probe_;
+
+        /*
+        An item value that denotes an empty item.
+        */
+        const item_type empty_item_;
+
+        /*
+        The number of items that have been inserted to table or stash.
+        */
+        std::atomic<table_size_type> inserted_items_{ 0 };
+    };
+} // namespace kuku
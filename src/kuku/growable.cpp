@@ -0,0 +1,213 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/growable.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+namespace kuku
+{
+    GrowableKukuTable::GrowableKukuTable(
+        table_size_type table_size, table_size_type stash_size, uint32_t loc_func_count, item_type loc_func_seed,
+        uint64_t max_probe, item_type empty_item, double max_fill_rate, double growth_factor, size_t migration_step)
+        : stash_size_(stash_size), loc_func_count_(loc_func_count), loc_func_seed_(loc_func_seed),
+          max_probe_(max_probe), empty_item_(empty_item), max_fill_rate_(max_fill_rate),
+          growth_factor_(growth_factor), migration_step_(migration_step), leftover_item_(empty_item)
+    {
+        if (!(max_fill_rate > 0.0 && max_fill_rate <= 1.0))
+        {
+            throw invalid_argument("max_fill_rate is out of range");
+        }
+        if (!(growth_factor > 1.0))
+        {
+            throw invalid_argument("growth_factor must be greater than one");
+        }
+        if (!migration_step)
+        {
+            throw invalid_argument("migration_step cannot be zero");
+        }
+
+        // The table validates the remaining parameters
+        table_ = make_table(table_size);
+    }
+
+    unique_ptr<KukuTable> GrowableKukuTable::make_table(table_size_type table_size)
+    {
+        const item_type seed = make_item(get_low_word(loc_func_seed_), get_high_word(loc_func_seed_) + generation_);
+        return make_unique<KukuTable>(table_size, stash_size_, loc_func_count_, seed, max_probe_, empty_item_);
+    }
+
+    table_size_type GrowableKukuTable::grown_size(table_size_type table_size) const noexcept
+    {
+        const double grown = ceil(static_cast<double>(table_size) * growth_factor_);
+        if (grown >= static_cast<double>(max_table_size))
+        {
+            return max_table_size;
+        }
+        return max(static_cast<table_size_type>(grown), table_size + 1);
+    }
+
+    bool GrowableKukuTable::insert(item_type item)
+    {
+        if (query(item))
+        {
+            return false;
+        }
+
+        migrate(migration_step_);
+        if (!migrating() && table_->fill_rate() >= max_fill_rate_)
+        {
+            start_migration();
+        }
+        if (!place(item))
+        {
+            return false;
+        }
+        item_count_++;
+        return true;
+    }
+
+    bool GrowableKukuTable::query(item_type item) const
+    {
+        return table_->query(item) || (old_table_ && old_table_->query(item));
+    }
+
+    bool GrowableKukuTable::erase(item_type item)
+    {
+        // An item that was already migrated is in both tables
+        bool erased = table_->erase(item);
+        if (old_table_ && old_table_->erase(item))
+        {
+            erased = true;
+        }
+        if (erased)
+        {
+            item_count_--;
+        }
+
+        migrate(migration_step_);
+        return erased;
+    }
+
+    void GrowableKukuTable::finish_migration()
+    {
+        migrate(numeric_limits<size_t>::max());
+    }
+
+    void GrowableKukuTable::start_migration()
+    {
+        const table_size_type table_size = grown_size(table_->table_size());
+        if (table_size == table_->table_size())
+        {
+            return;
+        }
+
+        generation_++;
+        old_table_ = move(table_);
+        table_ = make_table(table_size);
+        migration_cursor_ = 0;
+
+        // Migrate the stash right away: it is small, and erasing from the old table may move stash items to table
+        // locations the migration has already passed
+        const vector<item_type> stash = old_table_->stash();
+        for (const auto &item : stash)
+        {
+            if (!table_->query(item) && !place(item))
+            {
+                item_count_--;
+            }
+        }
+    }
+
+    void GrowableKukuTable::migrate(size_t step_count)
+    {
+        for (; old_table_ && step_count && migration_cursor_ < old_table_->table_size(); step_count--)
+        {
+            const item_type item = old_table_->table(static_cast<location_type>(migration_cursor_++));
+
+            // The item may be migrated already if it was moved out of the stash of the old table
+            if (!is_empty_item(item) && !table_->query(item) && !place(item))
+            {
+                item_count_--;
+            }
+        }
+        if (old_table_ && migration_cursor_ == old_table_->table_size())
+        {
+            old_table_.reset();
+            migration_cursor_ = 0;
+        }
+    }
+
+    bool GrowableKukuTable::place(item_type item)
+    {
+        if (table_->insert(item))
+        {
+            return true;
+        }
+
+        // The item or another one that it evicted is left over; migrate to a larger table to make room for it
+        const item_type leftover = table_->leftover_item();
+        if (migrating())
+        {
+            return rebuild(leftover);
+        }
+        start_migration();
+        if (!migrating())
+        {
+            leftover_item_ = leftover;
+            return false;
+        }
+        return table_->insert(leftover) || rebuild(table_->leftover_item());
+    }
+
+    bool GrowableKukuTable::rebuild(item_type extra_item)
+    {
+        // The items of the current table, the items of the old table that have not been migrated yet, and the extra
+        // item; the old table may contain migrated items again, which are skipped when inserting
+        vector<item_type> items = table_->stash();
+        for (location_type loc = 0; loc < table_->table_size(); loc++)
+        {
+            if (!table_->is_empty(loc))
+            {
+                items.push_back(table_->table(loc));
+            }
+        }
+        if (old_table_)
+        {
+            for (size_t loc = migration_cursor_; loc < old_table_->table_size(); loc++)
+            {
+                const item_type &item = old_table_->table(static_cast<location_type>(loc));
+                if (!is_empty_item(item))
+                {
+                    items.push_back(item);
+                }
+            }
+        }
+        items.push_back(extra_item);
+
+        table_size_type table_size = table_->table_size();
+        while (grown_size(table_size) != table_size)
+        {
+            table_size = grown_size(table_size);
+            generation_++;
+            auto table = make_table(table_size);
+            const bool success = all_of(items.begin(), items.end(), [&](const item_type &item) {
+                return table->query(item) || table->insert(item);
+            });
+            if (success)
+            {
+                table_ = move(table);
+                old_table_.reset();
+                migration_cursor_ = 0;
+                return true;
+            }
+        }
+
+        leftover_item_ = extra_item;
+        return false;
+    }
+} // namespace kuku
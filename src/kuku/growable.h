@@ -0,0 +1,241 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "kuku/common.h"
+#include "kuku/kuku.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace kuku
+{
+    /**
+    The GrowableKukuTable class represents a cuckoo hash table that grows as items are inserted. It holds a KukuTable,
+    and when the fill rate of that table reaches a threshold, or an insertion into it fails, it creates a larger
+    KukuTable with new location functions and migrates the items into it. The migration is incremental: every
+    subsequent insert or erase moves the items of a fixed number of locations of the old table, so that no single
+    call pays for rehashing the whole table. Until the migration is complete, queries consult both tables.
+
+    The table of generation g (starting from zero) uses the location function seed whose high word is that of the
+    initial seed plus g. If an insertion fails while a migration is still in progress, the remaining items are
+    migrated at once into a table that is larger still; with the default parameters this does not happen in
+    practice.
+    */
+    class GrowableKukuTable
+    {
+    public:
+        /**
+        Creates a new empty growable hash table.
+
+        @param[in] table_size The initial size of the hash table
+        @param[in] stash_size The size of the stash of every table (possibly zero)
+        @param[in] loc_func_count The number of location functions (hash functions) to use
+        @param[in] loc_func_seed The 128-bit seed for the location functions of the initial table, represented as a
+        hash table item
+        @param[in] max_probe The maximum number of random walk steps taken in attempting to insert an item
+        @param[in] empty_item A hash table item that represents an empty location in the table
+        @param[in] max_fill_rate The fill rate at which the table starts to grow
+        @param[in] growth_factor The ratio of the size of a new table to the size of the table it replaces
+        @param[in] migration_step The number of locations of the old table migrated by every insert or erase
+        @throws std::invalid_argument if loc_func_count is too large or too small
+        @throws std::invalid_argument if table_size is too large or too small
+        @throws std::invalid_argument if max_probe or migration_step is zero
+        @throws std::invalid_argument if max_fill_rate is not in (0, 1] or growth_factor is not greater than 1
+        */
+        GrowableKukuTable(
+            table_size_type table_size, table_size_type stash_size, std::uint32_t loc_func_count,
+            item_type loc_func_seed, std::uint64_t max_probe, item_type empty_item, double max_fill_rate = 0.9,
+            double growth_factor = 2.0, std::size_t migration_step = 16);
+
+        /**
+        Adds a single item to the hash table, growing it if needed. The return value indicates whether the item was
+        successfully inserted or not; insertion fails only if the item is already in the table, or if the table has
+        reached the largest allowed size and is full, in which case the leftover item can be read with
+        leftover_item().
+
+        @param[in] item The hash table item to insert
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] bool insert(item_type item);
+
+        /**
+        Queries for the presence of a given item in the current table and, during a migration, in the old table.
+
+        @param[in] item The hash table item to query
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] bool query(item_type item) const;
+
+        /**
+        Removes a single item from the hash table. The return value indicates whether the item was found and removed.
+
+        @param[in] item The hash table item to remove
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        bool erase(item_type item);
+
+        /**
+        Migrates all remaining items of the old table at once, for example when the caller is idle. Does nothing if no
+        migration is in progress.
+        */
+        void finish_migration();
+
+        /**
+        Returns whether a migration to a larger table is in progress.
+        */
+        [[nodiscard]] bool migrating() const noexcept
+        {
+            return old_table_ != nullptr;
+        }
+
+        /**
+        Returns a reference to the current table, into which new items are inserted.
+        */
+        [[nodiscard]] const KukuTable &table() const noexcept
+        {
+            return *table_;
+        }
+
+        /**
+        Returns the size of the current table.
+        */
+        [[nodiscard]] table_size_type table_size() const noexcept
+        {
+            return table_->table_size();
+        }
+
+        /**
+        Returns the number of items in the hash table.
+        */
+        [[nodiscard]] std::size_t size() const noexcept
+        {
+            return item_count_;
+        }
+
+        /**
+        Returns the number of times the hash table has grown.
+        */
+        [[nodiscard]] std::uint64_t generation() const noexcept
+        {
+            return generation_;
+        }
+
+        /**
+        Returns the hash table item that represents an empty location in the table.
+        */
+        [[nodiscard]] const item_type &empty_item() const noexcept
+        {
+            return empty_item_;
+        }
+
+        /**
+        Returns whether a given item is the empty item for this hash table.
+
+        @param[in] item The item to compare to the empty item
+        */
+        [[nodiscard]] bool is_empty_item(const item_type &item) const noexcept
+        {
+            return are_equal_item(item, empty_item_);
+        }
+
+        /**
+        When the insert function fails to insert a hash table item into a table of the largest allowed size, there is a
+        leftover item that could not be inserted. This function will return the empty item if insertion never failed,
+        and otherwise it will return the latest leftover item.
+        */
+        [[nodiscard]] item_type leftover_item() const noexcept
+        {
+            return leftover_item_;
+        }
+
+        /**
+        Returns the number of items in the hash table divided by the size of the current table and stash.
+        */
+        [[nodiscard]] double fill_rate() const noexcept
+        {
+            return static_cast<double>(item_count_) /
+                   (static_cast<double>(table_->table_size()) + static_cast<double>(stash_size_));
+        }
+
+        GrowableKukuTable(const GrowableKukuTable &copy) = delete;
+
+        GrowableKukuTable &operator=(const GrowableKukuTable &assign) = delete;
+
+    private:
+        /*
+        Creates an empty table of the given size for the next generation.
+        */
+        std::unique_ptr<KukuTable> make_table(table_size_type table_size);
+
+        /*
+        Returns the size of the table that replaces one of the given size, or table_size if it cannot grow.
+        */
+        table_size_type grown_size(table_size_type table_size) const noexcept;
+
+        /*
+        Makes the current table the old table and starts migrating its items to a new, larger table.
+        */
+        void start_migration();
+
+        /*
+        Migrates the items at the next step_count locations of the old table.
+        */
+        void migrate(std::size_t step_count);
+
+        /*
+        Inserts an item that is in neither table into the current table, growing as needed. Returns false if the table
+        cannot grow any further, in which case leftover_item_ is set.
+        */
+        bool place(item_type item);
+
+        /*
+        Replaces both tables with a single larger table holding all of their items and the given extra item. Returns
+        false if the table cannot grow any further, in which case leftover_item_ is set.
+        */
+        bool rebuild(item_type extra_item);
+
+        /*
+        The table into which new items are inserted.
+        */
+        std::unique_ptr<KukuTable> table_;
+
+        /*
+        The table being migrated from, or null if no migration is in progress. Items are left in place when they are
+        migrated; the table is discarded when the migration completes.
+        */
+        std::unique_ptr<KukuTable> old_table_;
+
+        /*
+        The next location of the old table to migrate; locations past the table size refer to the stash.
+        */
+        std::size_t migration_cursor_ = 0;
+
+        const table_size_type stash_size_;
+
+        const std::uint32_t loc_func_count_;
+
+        const item_type loc_func_seed_;
+
+        const std::uint64_t max_probe_;
+
+        const item_type empty_item_;
+
+        const double max_fill_rate_;
+
+        const double growth_factor_;
+
+        const std::size_t migration_step_;
+
+        item_type leftover_item_;
+
+        /*
+        The number of items in the hash table, counting migrated items once.
+        */
+        std::size_t item_count_ = 0;
+
+        std::uint64_t generation_ = 0;
+    };
+} // namespace kuku
@@ -0,0 +1,197 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/internal/hash.h"
+#include "kuku/internal/simd.h"
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+namespace kuku
+{
+    namespace detail
+    {
+#ifdef KUKU_SIMD_X64
+        namespace
+        {
+            /*
+            The number of 256-entry blocks of a tabulation random array, and the number of 32-bit words of an item.
+            */
+            template <size_t ItemBytes>
+            struct TabulationShape
+            {
+                static constexpr int block_value_count = 256;
+
+                static constexpr size_t word_count = ItemBytes / 4;
+            };
+
+            /*
+            Hashes 16 items at a time: the items are gathered four bytes per lane, and every table lookup is one
+            gather. Returns the number of items hashed.
+            */
+            template <size_t ItemBytes>
+            KUKU_TARGET_AVX512 size_t tabulation_hash_avx512(
+                const unsigned char *items, size_t count, const location_type *random_array,
+                location_type *out) noexcept
+            {
+                using shape = TabulationShape<ItemBytes>;
+                const __m512i item_offsets = _mm512_mullo_epi32(
+                    _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                    _mm512_set1_epi32(static_cast<int>(shape::word_count)));
+                const __m512i byte_mask = _mm512_set1_epi32(0xFF);
+                size_t i = 0;
+                for (; i + 16 <= count; i += 16)
+                {
+                    const unsigned char *base = items + i * ItemBytes;
+                    __m512i hash = _mm512_setzero_si512();
+                    for (size_t word = 0; word < shape::word_count; word++)
+                    {
+                        const __m512i item_words = _mm512_i32gather_epi32(item_offsets, base + 4 * word, 4);
+                        for (size_t byte = 0; byte < 4; byte++)
+                        {
+                            const __m512i index = _mm512_add_epi32(
+                                _mm512_and_si512(
+                                    _mm512_srli_epi32(item_words, static_cast<unsigned>(8 * byte)), byte_mask),
+                                _mm512_set1_epi32(static_cast<int>((4 * word + byte) * shape::block_value_count)));
+                            hash = _mm512_xor_si512(hash, _mm512_i32gather_epi32(index, random_array, 4));
+                        }
+                    }
+                    _mm512_storeu_si512(out + i, hash);
+                }
+                return i;
+            }
+
+            /*
+            Hashes 8 items at a time like tabulation_hash_avx512. Returns the number of items hashed.
+            */
+            template <size_t ItemBytes>
+            KUKU_TARGET_AVX2 size_t tabulation_hash_avx2(
+                const unsigned char *items, size_t count, const location_type *random_array,
+                location_type *out) noexcept
+            {
+                using shape = TabulationShape<ItemBytes>;
+                const __m256i item_offsets = _mm256_mullo_epi32(
+                    _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(shape::word_count)));
+                const __m256i byte_mask = _mm256_set1_epi32(0xFF);
+                const auto *table = reinterpret_cast<const int *>(random_array);
+                size_t i = 0;
+                for (; i + 8 <= count; i += 8)
+                {
+                    const unsigned char *base = items + i * ItemBytes;
+                    __m256i hash = _mm256_setzero_si256();
+                    for (size_t word = 0; word < shape::word_count; word++)
+                    {
+                        const __m256i item_words =
+                            _mm256_i32gather_epi32(reinterpret_cast<const int *>(base + 4 * word), item_offsets, 4);
+                        for (size_t byte = 0; byte < 4; byte++)
+                        {
+                            const __m256i index = _mm256_add_epi32(
+                                _mm256_and_si256(
+                                    _mm256_srli_epi32(item_words, static_cast<int>(8 * byte)), byte_mask),
+                                _mm256_set1_epi32(static_cast<int>((4 * word + byte) * shape::block_value_count)));
+                            hash = _mm256_xor_si256(hash, _mm256_i32gather_epi32(table, index, 4));
+                        }
+                    }
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), hash);
+                }
+                return i;
+            }
+
+            SIMDLevel detect_simd_level() noexcept
+            {
+#ifdef _MSC_VER
+                int info[4];
+                __cpuid(info, 0);
+                if (info[0] < 7)
+                {
+                    return SIMDLevel::none;
+                }
+                __cpuid(info, 1);
+                const bool osxsave = (info[2] & (1 << 27)) != 0;
+                const bool avx = (info[2] & (1 << 28)) != 0;
+                if (!osxsave || !avx)
+                {
+                    return SIMDLevel::none;
+                }
+                const unsigned long long xcr0 = _xgetbv(0);
+                __cpuidex(info, 7, 0);
+                if ((info[1] & (1 << 16)) && (xcr0 & 0xE6) == 0xE6)
+                {
+                    return SIMDLevel::avx512;
+                }
+                if ((info[1] & (1 << 5)) && (xcr0 & 0x6) == 0x6)
+                {
+                    return SIMDLevel::avx2;
+                }
+                return SIMDLevel::none;
+#else
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx512f"))
+                {
+                    return SIMDLevel::avx512;
+                }
+                if (__builtin_cpu_supports("avx2"))
+                {
+                    return SIMDLevel::avx2;
+                }
+                return SIMDLevel::none;
+#endif
+            }
+
+            template <size_t ItemBytes>
+            size_t tabulation_hash_dispatch(
+                SIMDLevel level, const unsigned char *items, size_t count, const location_type *random_array,
+                location_type *out) noexcept
+            {
+                switch (level)
+                {
+                case SIMDLevel::avx512:
+                    return tabulation_hash_avx512<ItemBytes>(items, count, random_array, out);
+                case SIMDLevel::avx2:
+                    return tabulation_hash_avx2<ItemBytes>(items, count, random_array, out);
+                default:
+                    return 0;
+                }
+            }
+        } // namespace
+#endif
+
+        SIMDLevel simd_level() noexcept
+        {
+#ifdef KUKU_SIMD_X64
+            static const SIMDLevel level = detect_simd_level();
+            return level;
+#else
+            return SIMDLevel::none;
+#endif
+        }
+
+        size_t tabulation_hash_simd(
+            const unsigned char *items, size_t item_bytes, size_t count, const location_type *random_array,
+            location_type *out) noexcept
+        {
+#ifdef KUKU_SIMD_X64
+            const SIMDLevel level = simd_level();
+            switch (item_bytes)
+            {
+            case 8:
+                return tabulation_hash_dispatch<8>(level, items, count, random_array, out);
+            case 16:
+                return tabulation_hash_dispatch<16>(level, items, count, random_array, out);
+            case 32:
+                return tabulation_hash_dispatch<32>(level, items, count, random_array, out);
+            default:
+                return 0;
+            }
+#else
+            (void)items;
+            (void)item_bytes;
+            (void)count;
+            (void)random_array;
+            (void)out;
+            return 0;
+#endif
+        }
+    } // namespace detail
+} // namespace kuku
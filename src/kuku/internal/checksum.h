@@ -0,0 +1,108 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace kuku
+{
+    namespace detail
+    {
+        constexpr std::uint64_t xxhash64_prime1 = 11400714785074694791ULL;
+        constexpr std::uint64_t xxhash64_prime2 = 14029467366897019727ULL;
+        constexpr std::uint64_t xxhash64_prime3 = 1609587929392839161ULL;
+        constexpr std::uint64_t xxhash64_prime4 = 9650029242287828579ULL;
+        constexpr std::uint64_t xxhash64_prime5 = 2870177450012600261ULL;
+
+        inline std::uint64_t rotl64(std::uint64_t value, int bits) noexcept
+        {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        inline std::uint64_t read_le64(const unsigned char *in) noexcept
+        {
+            std::uint64_t value = 0;
+            for (int i = 0; i < 8; i++)
+            {
+                value |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+            }
+            return value;
+        }
+
+        inline std::uint64_t xxhash64_round(std::uint64_t acc, std::uint64_t input) noexcept
+        {
+            return rotl64(acc + input * xxhash64_prime2, 31) * xxhash64_prime1;
+        }
+
+        inline std::uint64_t xxhash64_merge_round(std::uint64_t acc, std::uint64_t value) noexcept
+        {
+            return (acc ^ xxhash64_round(0, value)) * xxhash64_prime1 + xxhash64_prime4;
+        }
+    } // namespace detail
+
+    /*
+    Computes the XXH64 hash of a buffer. This is a fast non-cryptographic checksum that detects accidental corruption
+    of saved hash tables at several GB/s, much faster than BLAKE2b.
+    */
+    inline std::uint64_t xxhash64(const void *data, std::size_t size, std::uint64_t seed = 0) noexcept
+    {
+        using namespace detail;
+
+        auto in = static_cast<const unsigned char *>(data);
+        const unsigned char *const end = in + size;
+        std::uint64_t hash;
+        if (size >= 32)
+        {
+            std::uint64_t v1 = seed + xxhash64_prime1 + xxhash64_prime2;
+            std::uint64_t v2 = seed + xxhash64_prime2;
+            std::uint64_t v3 = seed;
+            std::uint64_t v4 = seed - xxhash64_prime1;
+            for (; end - in >= 32; in += 32)
+            {
+                v1 = xxhash64_round(v1, read_le64(in));
+                v2 = xxhash64_round(v2, read_le64(in + 8));
+                v3 = xxhash64_round(v3, read_le64(in + 16));
+                v4 = xxhash64_round(v4, read_le64(in + 24));
+            }
+            hash = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+            hash = xxhash64_merge_round(hash, v1);
+            hash = xxhash64_merge_round(hash, v2);
+            hash = xxhash64_merge_round(hash, v3);
+            hash = xxhash64_merge_round(hash, v4);
+        }
+        else
+        {
+            hash = seed + xxhash64_prime5;
+        }
+        hash += static_cast<std::uint64_t>(size);
+
+        for (; end - in >= 8; in += 8)
+        {
+            hash ^= xxhash64_round(0, read_le64(in));
+            hash = rotl64(hash, 27) * xxhash64_prime1 + xxhash64_prime4;
+        }
+        if (end - in >= 4)
+        {
+            const std::uint64_t word = static_cast<std::uint64_t>(in[0]) | (static_cast<std::uint64_t>(in[1]) << 8) |
+                                       (static_cast<std::uint64_t>(in[2]) << 16) |
+                                       (static_cast<std::uint64_t>(in[3]) << 24);
+            hash ^= word * xxhash64_prime1;
+            hash = rotl64(hash, 23) * xxhash64_prime2 + xxhash64_prime3;
+            in += 4;
+        }
+        for (; in < end; in++)
+        {
+            hash ^= static_cast<std::uint64_t>(*in) * xxhash64_prime5;
+            hash = rotl64(hash, 11) * xxhash64_prime1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= xxhash64_prime2;
+        hash ^= hash >> 29;
+        hash *= xxhash64_prime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+} // namespace kuku
@@ -12,17 +12,49 @@
 #ifdef _MSC_VER
 #   pragma warning(pop)
 #endif
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 #include <stdexcept>
+#include <vector>
+#if defined(__AES__)
+#   include <immintrin.h>
+#endif
 
 namespace kuku
 {
-    class HashFunc
+    namespace detail
+    {
+        /*
+        Hashes the leading items of count consecutive items of item_bytes bytes (8, 16, or 32) into out with the
+        tabulation hash function whose random array starts at random_array. The AVX-512 or AVX2 kernel, which hashes 16
+        or 8 items at a time with gathers, is selected once at runtime by the features of the CPU. Returns the number of
+        items hashed; the caller hashes the remaining ones. Returns zero if the CPU has neither, the target is not
+        x86-64, or Kuku is built with KUKU_USE_SIMD=OFF.
+        */
+        std::size_t tabulation_hash_simd(
+            const unsigned char *items, std::size_t item_bytes, std::size_t count, const location_type *random_array,
+            location_type *out) noexcept;
+    } // namespace detail
+
+    /*
+    A tabulation hash function over items of ItemBytes bytes: every byte of the item selects a random 32-bit word from
+    its own table of 256 words, and the hash is the XOR of the selected words. Hashing costs one table lookup per item
+    byte, so hashing 8-byte items takes half the work of hashing 16-byte items. The supported item widths are 8, 16,
+    and 32 bytes; HashFunc is the 16-byte instance used by KukuTable.
+    */
+    template <std::size_t ItemBytes>
+    class BasicHashFunc
     {
+        template <std::size_t>
+        friend class BasicHashFuncBank;
+
+        static_assert(ItemBytes == 8 || ItemBytes == 16 || ItemBytes == 32, "ItemBytes must be 8, 16, or 32");
+
     public:
-        HashFunc(item_type seed)
+        BasicHashFunc(item_type seed)
         {
             if (blake2xb(
                 random_array_.data(),
@@ -35,31 +67,46 @@ namespace kuku
             }
         }
 
-        location_type operator ()(item_type item) const noexcept
+        location_type operator ()(const basic_item_type<ItemBytes> &item) const noexcept
         {
-            return
-                random_array_[(0 * block_value_count_) + static_cast<std::size_t>(item[0])] ^
-                random_array_[(1 * block_value_count_) + static_cast<std::size_t>(item[1])] ^
-                random_array_[(2 * block_value_count_) + static_cast<std::size_t>(item[2])] ^
-                random_array_[(3 * block_value_count_) + static_cast<std::size_t>(item[3])] ^
-                random_array_[(4 * block_value_count_) + static_cast<std::size_t>(item[4])] ^
-                random_array_[(5 * block_value_count_) + static_cast<std::size_t>(item[5])] ^
-                random_array_[(6 * block_value_count_) + static_cast<std::size_t>(item[6])] ^
-                random_array_[(7 * block_value_count_) + static_cast<std::size_t>(item[7])] ^
-                random_array_[(8 * block_value_count_) + static_cast<std::size_t>(item[8])] ^
-                random_array_[(9 * block_value_count_) + static_cast<std::size_t>(item[9])] ^
-                random_array_[(10 * block_value_count_) + static_cast<std::size_t>(item[10])] ^
-                random_array_[(11 * block_value_count_) + static_cast<std::size_t>(item[11])] ^
-                random_array_[(12 * block_value_count_) + static_cast<std::size_t>(item[12])] ^
-                random_array_[(13 * block_value_count_) + static_cast<std::size_t>(item[13])] ^
-                random_array_[(14 * block_value_count_) + static_cast<std::size_t>(item[14])] ^
-                random_array_[(15 * block_value_count_) + static_cast<std::size_t>(item[15])];
+            location_type hash = 0;
+            for (std::size_t block = 0; block < block_count_; block++)
+            {
+                hash ^= random_array_[(block * block_value_count_) + static_cast<std::size_t>(item[block])];
+            }
+            return hash;
+        }
+
+        /*
+        Computes the hash of count consecutive items into out. On x86-64 CPUs with AVX-512 or AVX2, 16 or 8 items are
+        hashed at once (see detail::tabulation_hash_simd). The results are identical to calling operator() on each
+        item.
+        */
+        void operator ()(const basic_item_type<ItemBytes> *items, std::size_t count, location_type *out) const noexcept
+        {
+            std::size_t i = detail::tabulation_hash_simd(
+                reinterpret_cast<const unsigned char *>(items), ItemBytes, count, random_array_.data(), out);
+            for (; i < count; i++)
+            {
+                // Extract the bytes from word loads rather than loading every byte separately; the table lookups are
+                // then the only loads left.
+                std::array<std::uint64_t, ItemBytes / 8> words;
+                std::memcpy(words.data(), items[i].data(), ItemBytes);
+                location_type hash = 0;
+                for (std::size_t block = 0; block < block_count_; block++)
+                {
+                    hash ^= random_array_
+                        [(block * block_value_count_) +
+                         static_cast<std::size_t>((words[block / 8] >> (8 * (block % 8))) & block_mask_)];
+                }
+                out[i] = hash;
+            }
         }
 
     private:
         static constexpr std::size_t block_size_ = 1;
 
-        static constexpr std::size_t block_count_ = sizeof(item_type);
+        static constexpr std::size_t block_count_ = ItemBytes;
 
         static constexpr std::size_t block_value_count_ = (static_cast<std::size_t>(1) << (8 * block_size_));
 
@@ -68,6 +115,258 @@ namespace kuku
         static constexpr std::uint32_t block_mask_ =
             static_cast<std::uint32_t>(block_value_count_ - 1);
 
+        static_assert(
+            sizeof(basic_item_type<ItemBytes>) == block_count_, "items must be tightly packed for the batch kernels");
+
         std::array<location_type, random_array_size_> random_array_{};
     };
+
+    /*
+    The tabulation hash function over 16-byte items.
+    */
+    using HashFunc = BasicHashFunc<16>;
+
+    /*
+    A multiply-shift hash function: the item is split into four 32-bit words x_0, ..., x_3 and hashed to the high 32
+    bits of a_0 * x_0 + ... + a_3 * x_3 + b (modulo 2^64) for random 64-bit a_0, ..., a_3, b. The family is
+    2-independent and costs four multiplications.
+    */
+    class MultiplyShiftHashFunc
+    {
+    public:
+        MultiplyShiftHashFunc(item_type seed)
+        {
+            if (blake2xb(keys_.data(), sizeof(keys_), seed.data(), sizeof(seed), nullptr, 0) != 0)
+            {
+                throw std::runtime_error("blake2xb failed");
+            }
+        }
+
+        location_type operator ()(item_type item) const noexcept
+        {
+            const std::uint64_t low_word = get_low_word(item);
+            const std::uint64_t high_word = get_high_word(item);
+            const std::uint64_t hash = keys_[0] * (low_word & 0xFFFFFFFFULL) + keys_[1] * (low_word >> 32) +
+                keys_[2] * (high_word & 0xFFFFFFFFULL) + keys_[3] * (high_word >> 32) + keys_[4];
+            return static_cast<location_type>(hash >> 32);
+        }
+
+    private:
+        std::array<std::uint64_t, 5> keys_{};
+    };
+
+    /*
+    A hash function made of two AES rounds: the item is XORed with a random key and encrypted with two AES rounds
+    (AESENC) under two further random round keys; the hash is the lowest 32 bits of the result. After two rounds every
+    output byte depends on every input byte. The AES-NI instruction is used when compiling for a target that has it
+    (e.g., with -maes or -march=native); otherwise an equivalent portable implementation computes identical hashes.
+    */
+    class AESHashFunc
+    {
+    public:
+        AESHashFunc(item_type seed)
+        {
+            if (blake2xb(round_keys_.data(), sizeof(round_keys_), seed.data(), sizeof(seed), nullptr, 0) != 0)
+            {
+                throw std::runtime_error("blake2xb failed");
+            }
+        }
+
+        location_type operator ()(item_type item) const noexcept
+        {
+            item_type state = encrypt_round(encrypt_round(xor_item(item, round_keys_[0]), round_keys_[1]),
+                round_keys_[2]);
+            location_type hash = 0;
+            std::memcpy(&hash, state.data(), sizeof(hash));
+            return hash;
+        }
+
+        /*
+        One AES encryption round (ShiftRows, SubBytes, MixColumns, AddRoundKey), identical to the AESENC instruction.
+        */
+        static item_type encrypt_round(const item_type &state, const item_type &round_key) noexcept
+        {
+#if defined(__AES__)
+            __m128i result = _mm_aesenc_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(state.data())),
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(round_key.data())));
+            item_type out;
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out.data()), result);
+            return out;
+#else
+            return encrypt_round_portable(state, round_key);
+#endif
+        }
+
+        /*
+        The portable implementation of encrypt_round. The state is in the column-major byte order used by AES-NI.
+        */
+        static item_type encrypt_round_portable(const item_type &state, const item_type &round_key) noexcept
+        {
+            // ShiftRows and SubBytes; row r of column c comes from column c + r
+            item_type shifted;
+            for (std::size_t column = 0; column < 4; column++)
+            {
+                for (std::size_t row = 0; row < 4; row++)
+                {
+                    shifted[4 * column + row] = sbox_[state[4 * ((column + row) % 4) + row]];
+                }
+            }
+
+            // MixColumns and AddRoundKey
+            item_type out;
+            for (std::size_t column = 0; column < 4; column++)
+            {
+                const unsigned char *a = shifted.data() + 4 * column;
+                const unsigned char x0 = xtime(a[0]), x1 = xtime(a[1]), x2 = xtime(a[2]), x3 = xtime(a[3]);
+                out[4 * column + 0] = static_cast<unsigned char>(x0 ^ x1 ^ a[1] ^ a[2] ^ a[3]);
+                out[4 * column + 1] = static_cast<unsigned char>(a[0] ^ x1 ^ x2 ^ a[2] ^ a[3]);
+                out[4 * column + 2] = static_cast<unsigned char>(a[0] ^ a[1] ^ x2 ^ x3 ^ a[3]);
+                out[4 * column + 3] = static_cast<unsigned char>(x0 ^ a[0] ^ a[1] ^ a[2] ^ x3);
+            }
+            return xor_item(out, round_key);
+        }
+
+    private:
+        static item_type xor_item(const item_type &in1, const item_type &in2) noexcept
+        {
+            return make_item(get_low_word(in1) ^ get_low_word(in2), get_high_word(in1) ^ get_high_word(in2));
+        }
+
+        static unsigned char xtime(unsigned char value) noexcept
+        {
+            return static_cast<unsigned char>((value << 1) ^ ((value & 0x80) ? 0x1B : 0x00));
+        }
+
+        static constexpr std::array<unsigned char, 256> sbox_{
+            0x63, 0x7C, 0x77, 0x7B, 0xF2, 0x6B, 0x6F, 0xC5, 0x30, 0x01, 0x67, 0x2B, 0xFE, 0xD7, 0xAB, 0x76,
+            0xCA, 0x82, 0xC9, 0x7D, 0xFA, 0x59, 0x47, 0xF0, 0xAD, 0xD4, 0xA2, 0xAF, 0x9C, 0xA4, 0x72, 0xC0,
+            0xB7, 0xFD, 0x93, 0x26, 0x36, 0x3F, 0xF7, 0xCC, 0x34, 0xA5, 0xE5, 0xF1, 0x71, 0xD8, 0x31, 0x15,
+            0x04, 0xC7, 0x23, 0xC3, 0x18, 0x96, 0x05, 0x9A, 0x07, 0x12, 0x80, 0xE2, 0xEB, 0x27, 0xB2, 0x75,
+            0x09, 0x83, 0x2C, 0x1A, 0x1B, 0x6E, 0x5A, 0xA0, 0x52, 0x3B, 0xD6, 0xB3, 0x29, 0xE3, 0x2F, 0x84,
+            0x53, 0xD1, 0x00, 0xED, 0x20, 0xFC, 0xB1, 0x5B, 0x6A, 0xCB, 0xBE, 0x39, 0x4A, 0x4C, 0x58, 0xCF,
+            0xD0, 0xEF, 0xAA, 0xFB, 0x43, 0x4D, 0x33, 0x85, 0x45, 0xF9, 0x02, 0x7F, 0x50, 0x3C, 0x9F, 0xA8,
+            0x51, 0xA3, 0x40, 0x8F, 0x92, 0x9D, 0x38, 0xF5, 0xBC, 0xB6, 0xDA, 0x21, 0x10, 0xFF, 0xF3, 0xD2,
+            0xCD, 0x0C, 0x13, 0xEC, 0x5F, 0x97, 0x44, 0x17, 0xC4, 0xA7, 0x7E, 0x3D, 0x64, 0x5D, 0x19, 0x73,
+            0x60, 0x81, 0x4F, 0xDC, 0x22, 0x2A, 0x90, 0x88, 0x46, 0xEE, 0xB8, 0x14, 0xDE, 0x5E, 0x0B, 0xDB,
+            0xE0, 0x32, 0x3A, 0x0A, 0x49, 0x06, 0x24, 0x5C, 0xC2, 0xD3, 0xAC, 0x62, 0x91, 0x95, 0xE4, 0x79,
+            0xE7, 0xC8, 0x37, 0x6D, 0x8D, 0xD5, 0x4E, 0xA9, 0x6C, 0x56, 0xF4, 0xEA, 0x65, 0x7A, 0xAE, 0x08,
+            0xBA, 0x78, 0x25, 0x2E, 0x1C, 0xA6, 0xB4, 0xC6, 0xE8, 0xDD, 0x74, 0x1F, 0x4B, 0xBD, 0x8B, 0x8A,
+            0x70, 0x3E, 0xB5, 0x66, 0x48, 0x03, 0xF6, 0x0E, 0x61, 0x35, 0x57, 0xB9, 0x86, 0xC1, 0x1D, 0x9E,
+            0xE1, 0xF8, 0x98, 0x11, 0x69, 0xD9, 0x8E, 0x94, 0x9B, 0x1E, 0x87, 0xE9, 0xCE, 0x55, 0x28, 0xDF,
+            0x8C, 0xA1, 0x89, 0x0D, 0xBF, 0xE6, 0x42, 0x68, 0x41, 0x99, 0x2D, 0x0F, 0xB0, 0x54, 0xBB, 0x16
+        };
+
+        std::array<item_type, 3> round_keys_{};
+    };
+
+    /*
+    A bank of count tabulation hash functions seeded with seed, seed + 1, ..., seed + count - 1, that is, the hash
+    function with index i is identical to BasicHashFunc<ItemBytes>(seed + i). The random arrays of all functions are
+    interleaved so that the entries for a given (block, block value) pair are contiguous: hashing an item with all
+    functions touches ItemBytes short runs of memory rather than ItemBytes * count scattered words, and the XOR over
+    all functions vectorizes. HashFuncBank is the 16-byte instance used by LocFuncBank.
+    */
+    template <std::size_t ItemBytes>
+    class BasicHashFuncBank
+    {
+    public:
+        BasicHashFuncBank(std::uint32_t count, item_type seed)
+            : count_(count), random_array_(hash_func_type::random_array_size_ * static_cast<std::size_t>(count))
+        {
+            for (std::size_t func = 0; func < count_; func++)
+            {
+                hash_func_type hf(seed);
+                for (std::size_t entry = 0; entry < hash_func_type::random_array_size_; entry++)
+                {
+                    random_array_[entry * count_ + func] = hf.random_array_[entry];
+                }
+                increment_item(seed);
+            }
+        }
+
+        std::uint32_t count() const noexcept
+        {
+            return count_;
+        }
+
+        /*
+        Returns the hash of item with the function of the given index.
+        */
+        location_type operator ()(const basic_item_type<ItemBytes> &item, std::uint32_t index) const noexcept
+        {
+            location_type hash = 0;
+            for (std::size_t block = 0; block < hash_func_type::block_count_; block++)
+            {
+                hash ^= row(block, item[block])[index];
+            }
+            return hash;
+        }
+
+        /*
+        Computes the hash of item with every function of the bank into out[0], ..., out[count() - 1].
+        */
+        void operator ()(const basic_item_type<ItemBytes> &item, location_type *out) const noexcept
+        {
+            // Fixed counts let the compiler keep all hashes in registers
+            switch (count_)
+            {
+            case 1:
+                hash_all<1>(item, out);
+                break;
+            case 2:
+                hash_all<2>(item, out);
+                break;
+            case 3:
+                hash_all<3>(item, out);
+                break;
+            case 4:
+                hash_all<4>(item, out);
+                break;
+            case 8:
+                hash_all<8>(item, out);
+                break;
+            default:
+                hash_all<max_loc_func_count>(item, out);
+                break;
+            }
+        }
+
+    private:
+        using hash_func_type = BasicHashFunc<ItemBytes>;
+
+        const location_type *row(std::size_t block, unsigned char value) const noexcept
+        {
+            return random_array_.data() +
+                ((block * hash_func_type::block_value_count_) + static_cast<std::size_t>(value)) * count_;
+        }
+
+        /*
+        Hashes with the first min(Count, count()) functions; Count is an upper bound known at compile time.
+        */
+        template <std::uint32_t Count>
+        void hash_all(const basic_item_type<ItemBytes> &item, location_type *out) const noexcept
+        {
+            const std::uint32_t count = Count < count_ ? Count : count_;
+            std::array<location_type, Count> hashes{};
+            for (std::size_t block = 0; block < hash_func_type::block_count_; block++)
+            {
+                const location_type *entries = row(block, item[block]);
+                for (std::uint32_t func = 0; func < count; func++)
+                {
+                    hashes[func] ^= entries[func];
+                }
+            }
+            std::copy_n(hashes.begin(), count, out);
+        }
+
+        std::uint32_t count_;
+
+        std::vector<location_type> random_array_;
+    };
+
+    /*
+    The bank of tabulation hash functions over 16-byte items.
+    */
+    using HashFuncBank = BasicHashFuncBank<16>;
 }
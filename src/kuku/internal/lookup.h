@@ -0,0 +1,173 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "kuku/common.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace kuku
+{
+    namespace detail
+    {
+        /*
+        Returns the index of the first of the lfc given locations in table that holds target, or lfc if there is none.
+        A query looks for the item itself, and an insert for the empty item.
+        */
+        template <typename Item>
+        std::uint32_t find_at_locations(
+            const Item *table, const Item &target, const location_type *locations, std::uint32_t lfc) noexcept
+        {
+            for (std::uint32_t i = 0; i < lfc; i++)
+            {
+                if (are_equal_item(table[locations[i]], target))
+                {
+                    return i;
+                }
+            }
+            return lfc;
+        }
+
+        /*
+        An open-addressing index of a stash of Item, used instead of scanning the stash when the stash size is larger
+        than scan_max_size. Every slot holds zero, or the upper 32 bits of the hash of an item in the high word and one
+        plus its position in the stash in the low word. The index has a power-of-two size of at least twice the stash
+        size, so a query that misses probes only a few slots. The stash itself is kept by the table, which passes it
+        to every call.
+        */
+        template <typename Item>
+        class StashIndex
+        {
+        public:
+            /*
+            The largest stash size for which queries scan the stash instead of using the index.
+            */
+            static constexpr std::size_t scan_max_size = 8;
+
+            StashIndex() = default;
+
+            /*
+            Creates an empty index for a stash that holds at most stash_size items.
+            */
+            explicit StashIndex(std::size_t stash_size)
+            {
+                if (stash_size > scan_max_size)
+                {
+                    std::size_t index_size = 1;
+                    while (index_size < 2 * stash_size)
+                    {
+                        index_size <<= 1;
+                    }
+                    slots_.resize(index_size, 0);
+                }
+            }
+
+            /*
+            Searches the stash for an item; returns its position in the stash or stash_count if it is not there.
+            */
+            std::size_t find(const Item *stash, std::size_t stash_count, const Item &item) const noexcept
+            {
+                if (slots_.empty())
+                {
+                    for (std::size_t position = 0; position < stash_count; position++)
+                    {
+                        if (are_equal_item(stash[position], item))
+                        {
+                            return position;
+                        }
+                    }
+                    return stash_count;
+                }
+                if (!stash_count)
+                {
+                    return 0;
+                }
+
+                // Probe until an empty slot; only items with a matching fingerprint are compared
+                const std::uint64_t item_hash = hash(item);
+                const std::uint64_t fingerprint = item_hash & 0xFFFFFFFF00000000ULL;
+                const std::size_t mask = slots_.size() - 1;
+                for (std::size_t slot = static_cast<std::size_t>(item_hash) & mask;; slot = (slot + 1) & mask)
+                {
+                    const std::uint64_t entry = slots_[slot];
+                    if (!entry)
+                    {
+                        return stash_count;
+                    }
+                    const std::size_t position = static_cast<std::size_t>(entry & 0xFFFFFFFFULL) - 1;
+                    if ((entry & 0xFFFFFFFF00000000ULL) == fingerprint && are_equal_item(stash[position], item))
+                    {
+                        return position;
+                    }
+                }
+            }
+
+            /*
+            Adds the stash item at the given position to the index.
+            */
+            void add(const Item *stash, std::size_t position) noexcept
+            {
+                if (slots_.empty())
+                {
+                    return;
+                }
+                const std::uint64_t item_hash = hash(stash[position]);
+                const std::size_t mask = slots_.size() - 1;
+                std::size_t slot = static_cast<std::size_t>(item_hash) & mask;
+                while (slots_[slot])
+                {
+                    slot = (slot + 1) & mask;
+                }
+                slots_[slot] = (item_hash & 0xFFFFFFFF00000000ULL) | (static_cast<std::uint64_t>(position) + 1);
+            }
+
+            /*
+            Rebuilds the index from the stash, after items were removed from it or it was loaded.
+            */
+            void rebuild(const Item *stash, std::size_t stash_count) noexcept
+            {
+                if (slots_.empty())
+                {
+                    return;
+                }
+                clear();
+                for (std::size_t position = 0; position < stash_count; position++)
+                {
+                    add(stash, position);
+                }
+            }
+
+            /*
+            Empties the index, along with the stash.
+            */
+            void clear() noexcept
+            {
+                std::fill(slots_.begin(), slots_.end(), std::uint64_t(0));
+            }
+
+        private:
+            /*
+            Hashes an item; the bits are mixed so that structured items spread evenly.
+            */
+            static std::uint64_t hash(const Item &item) noexcept
+            {
+                std::uint64_t result = 0;
+                for (std::size_t offset = 0; offset < sizeof(Item); offset += sizeof(std::uint64_t))
+                {
+                    std::uint64_t word;
+                    std::memcpy(&word, item.data() + offset, sizeof(word));
+                    result = (result ^ word) * 0x9E3779B97F4A7C15ULL;
+                }
+                result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                result = (result ^ (result >> 27)) * 0x94D049BB133111EBULL;
+                return result ^ (result >> 31);
+            }
+
+            std::vector<std::uint64_t> slots_;
+        };
+    } // namespace detail
+} // namespace kuku
@@ -0,0 +1,26 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+namespace kuku
+{
+    /*
+    Hints the processor to bring the cache line holding the given address into the cache. This is purely a
+    performance hint: it never faults and is a no-op on toolchains without a prefetch intrinsic.
+    */
+    inline void prefetch(const void *address) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        _mm_prefetch(static_cast<const char *>(address), _MM_HINT_T0);
+#else
+        (void)address;
+#endif
+    }
+} // namespace kuku
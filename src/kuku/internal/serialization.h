@@ -0,0 +1,184 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "kuku/common.h"
+#include "kuku/kuku.h"
+#include "kuku/locfunc.h"
+#include "kuku/internal/checksum.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace kuku
+{
+    /*
+    Little-endian encoding of the integers in the format written by KukuTable::save.
+    */
+    template <typename T>
+    void write_le(unsigned char *&out, T value) noexcept
+    {
+        for (std::size_t i = 0; i < sizeof(T); i++)
+        {
+            *out++ = static_cast<unsigned char>(static_cast<std::uint64_t>(value) >> (8 * i));
+        }
+    }
+
+    template <typename T>
+    T read_le(const unsigned char *&in) noexcept
+    {
+        std::uint64_t value = 0;
+        for (std::size_t i = 0; i < sizeof(T); i++)
+        {
+            value |= static_cast<std::uint64_t>(*in++) << (8 * i);
+        }
+        return static_cast<T>(value);
+    }
+
+    inline void write_item(unsigned char *&out, const item_type &item) noexcept
+    {
+        std::copy(item.begin(), item.end(), out);
+        out += bytes_per_item;
+    }
+
+    inline item_type read_item(const unsigned char *&in) noexcept
+    {
+        item_type item;
+        std::copy(in, in + bytes_per_item, item.begin());
+        in += bytes_per_item;
+        return item;
+    }
+
+    /*
+    The header of the format written by KukuTable::save. All integers are little-endian; items are stored as their 16
+    bytes. The layout is
+
+        offset  size  field
+             0     4  magic "KUKU"
+             4     4  format version
+             8     4  table size
+            12     4  stash size
+            16     4  location function count
+            20     1  LocFuncMode
+            21     1  HashFamily
+            22     1  InsertStrategy
+            23     1  reserved, zero
+            24     8  max_probe
+            32    16  location function seed
+            48    16  empty item
+            64    16  leftover item
+            80     4  number of inserted items
+            84     4  number of items in the stash
+
+    followed by the table, the items in the stash, and a 64-bit checksum of everything before it (see save_checksum).
+    */
+    struct SaveHeader
+    {
+        static constexpr std::array<unsigned char, 4> magic{ 'K', 'U', 'K', 'U' };
+
+        static constexpr std::uint32_t format_version = 1;
+
+        static constexpr std::size_t size = 88;
+
+        static constexpr std::size_t checksum_size = sizeof(std::uint64_t);
+
+        table_size_type table_size;
+
+        table_size_type stash_size;
+
+        std::uint32_t loc_func_count;
+
+        LocFuncMode loc_func_mode;
+
+        HashFamily hash_family;
+
+        InsertStrategy insert_strategy;
+
+        std::uint64_t max_probe;
+
+        item_type loc_func_seed;
+
+        item_type empty_item;
+
+        item_type leftover_item;
+
+        table_size_type inserted_items;
+
+        table_size_type stash_count;
+
+        /*
+        The size of the table and stash contents that follow the header.
+        */
+        std::size_t body_size() const noexcept
+        {
+            return (static_cast<std::size_t>(table_size) + static_cast<std::size_t>(stash_count)) * bytes_per_item;
+        }
+
+        void write(unsigned char *out) const noexcept
+        {
+            out = std::copy(magic.begin(), magic.end(), out);
+            write_le(out, format_version);
+            write_le(out, table_size);
+            write_le(out, stash_size);
+            write_le(out, loc_func_count);
+            write_le(out, static_cast<std::uint8_t>(loc_func_mode));
+            write_le(out, static_cast<std::uint8_t>(hash_family));
+            write_le(out, static_cast<std::uint8_t>(insert_strategy));
+            write_le(out, std::uint8_t(0));
+            write_le(out, max_probe);
+            write_item(out, loc_func_seed);
+            write_item(out, empty_item);
+            write_item(out, leftover_item);
+            write_le(out, inserted_items);
+            write_le(out, stash_count);
+        }
+
+        static SaveHeader read(const unsigned char *in)
+        {
+            if (!std::equal(magic.begin(), magic.end(), in))
+            {
+                throw std::invalid_argument("data is not a saved KukuTable");
+            }
+            in += magic.size();
+            if (read_le<std::uint32_t>(in) != format_version)
+            {
+                throw std::invalid_argument("unsupported KukuTable format version");
+            }
+
+            SaveHeader header;
+            header.table_size = read_le<table_size_type>(in);
+            header.stash_size = read_le<table_size_type>(in);
+            header.loc_func_count = read_le<std::uint32_t>(in);
+            header.loc_func_mode = static_cast<LocFuncMode>(read_le<std::uint8_t>(in));
+            header.hash_family = static_cast<HashFamily>(read_le<std::uint8_t>(in));
+            header.insert_strategy = static_cast<InsertStrategy>(read_le<std::uint8_t>(in));
+            in++;
+            header.max_probe = read_le<std::uint64_t>(in);
+            header.loc_func_seed = read_item(in);
+            header.empty_item = read_item(in);
+            header.leftover_item = read_item(in);
+            header.inserted_items = read_le<table_size_type>(in);
+            header.stash_count = read_le<table_size_type>(in);
+            return header;
+        }
+    };
+
+    /*
+    The checksum of a saved hash table: the XXH64 hash of the little-endian XXH64 hashes of the header, the table,
+    and the stash, so that the three parts can be hashed where they are.
+    */
+    inline std::uint64_t save_checksum(
+        const unsigned char *header, const item_type *table, std::size_t table_count, const item_type *stash,
+        std::size_t stash_count) noexcept
+    {
+        std::array<unsigned char, 3 * sizeof(std::uint64_t)> digests;
+        unsigned char *out = digests.data();
+        write_le(out, xxhash64(header, SaveHeader::size));
+        write_le(out, xxhash64(table, table_count * bytes_per_item));
+        write_le(out, xxhash64(stash, stash_count * bytes_per_item));
+        return xxhash64(digests.data(), digests.size());
+    }
+} // namespace kuku
@@ -0,0 +1,45 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "kuku/common.h"
+
+#if defined(KUKU_USE_SIMD) && (defined(__x86_64__) || defined(_M_X64))
+#define KUKU_SIMD_X64
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC compiles intrinsics for any x64 target; GCC and Clang compile them only in functions that target the feature
+#if defined(KUKU_SIMD_X64) && !defined(_MSC_VER)
+#define KUKU_TARGET_AVX2 __attribute__((target("avx2")))
+#define KUKU_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define KUKU_TARGET_AVX2
+#define KUKU_TARGET_AVX512
+#endif
+
+namespace kuku
+{
+    namespace detail
+    {
+        /*
+        The widest vector instructions that kernels selected at runtime may use.
+        */
+        enum class SIMDLevel
+        {
+            none,
+            avx2,
+            avx512
+        };
+
+        /*
+        Returns the widest vector instructions supported by the CPU and the operating system; they are detected once.
+        Returns SIMDLevel::none if the target is not x86-64, or Kuku is built with KUKU_USE_SIMD=OFF.
+        */
+        SIMDLevel simd_level() noexcept;
+    } // namespace detail
+} // namespace kuku
@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace kuku
+{
+    /*
+    Calls func(thread_index) for every thread index below thread_count, on new threads except for index zero, which
+    runs on the calling thread, and waits for all of them.
+    */
+    template <typename Func>
+    void run_threads(std::size_t thread_count, Func &&func)
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        for (std::size_t t = 1; t < thread_count; t++)
+        {
+            threads.emplace_back(func, t);
+        }
+        func(std::size_t(0));
+        for (auto &th : threads)
+        {
+            th.join();
+        }
+    }
+} // namespace kuku
@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "kuku/common.h"
+#include <array>
+#include <cstdint>
+
+namespace kuku
+{
+    namespace detail
+    {
+        /*
+        Runs the random walk of cuckoo hashing for an item that is not in the table, starting from the given locations
+        of the item. In every step, try_place(item, locations) stores the item and returns true if one of its
+        locations has room; otherwise evict(item, locations) swaps the item into one of its locations chosen at
+        random, leaving the displaced item in item, and compute_locations(item, out) computes the locations of the
+        displaced item for the next step. The table types differ only in what a location is (a slot or a bucket) and
+        in what moves along with an item, so they all insert through this function.
+
+        Returns the number of evictions made. This is less than max_probe if an item was placed; otherwise it is
+        max_probe, and item holds the item that is left without a location.
+        */
+        template <typename Item, typename TryPlace, typename Evict, typename ComputeLocations>
+        std::uint64_t random_walk(
+            Item &item, const location_type *locations, std::uint64_t max_probe, TryPlace &&try_place, Evict &&evict,
+            ComputeLocations &&compute_locations)
+        {
+            std::array<location_type, max_loc_func_count> evicted_locations;
+            for (std::uint64_t steps = 0; steps < max_probe; steps++)
+            {
+                if (try_place(item, locations))
+                {
+                    return steps;
+                }
+
+                // Swap in the current item and in next round try the popped out item, which has different locations
+                evict(item, locations);
+                compute_locations(item, evicted_locations.data());
+                locations = evicted_locations.data();
+            }
+            return max_probe;
+        }
+    } // namespace detail
+} // namespace kuku
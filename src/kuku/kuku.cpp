@@ -2,6 +2,21 @@
 // Licensed under the MIT license.
 
 #include "kuku/kuku.h"
+#include "kuku/internal/prefetch.h"
+#include "kuku/internal/serialization.h"
+#include "kuku/internal/threads.h"
+#include "kuku/internal/walk.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <ostream>
+#include <thread>
 
 using namespace std;
 
@@ -14,53 +29,91 @@ namespace kuku
             throw invalid_argument("item cannot be the empty item");
         }
 
+        array<location_type, max_loc_func_count> locations;
+        loc_funcs_.locations(item, locations.data());
+        return query_at(item, locations.data());
+    }
+
+    QueryResult KukuTable::query_at(const item_type &item, const location_type *locations) const noexcept
+    {
         // Search the hash table
-        for (uint32_t i = 0; i < loc_func_count(); i++)
+        const uint32_t i = detail::find_at_locations(table_.data(), item, locations, loc_func_count());
+        if (i < loc_func_count())
         {
-            auto loc = location(item, i);
-            if (are_equal_item(table_[loc], item))
-            {
-                return { loc, i };
-            }
+            return { locations[i], i };
         }
 
         // Search the stash
-        for (location_type loc = 0; loc < stash_.size(); loc++)
+        const size_t position = stash_index_.find(stash_.data(), stash_.size(), item);
+        if (position < stash_.size())
         {
-            if (are_equal_item(stash_[loc], item))
-            {
-                return { loc, ~static_cast<uint32_t>(0) };
-            }
+            return { static_cast<location_type>(position), ~static_cast<uint32_t>(0) };
         }
 
         // Not found
         return { 0, max_loc_func_count };
     }
 
-    KukuTable::KukuTable(
-        table_size_type table_size, table_size_type stash_size, uint32_t loc_func_count, item_type loc_func_seed,
-        uint64_t max_probe, item_type empty_item)
-        : table_size_(table_size), stash_size_(stash_size), loc_func_seed_(loc_func_seed), max_probe_(max_probe),
-          empty_item_(empty_item), leftover_item_(empty_item_), gen_(random_uint64())
+    void KukuTable::query_batch(const item_type *items, size_t count, QueryResult *out) const
     {
-        if (loc_func_count < min_loc_func_count || loc_func_count > max_loc_func_count)
+        if (count && (nullptr == items || nullptr == out))
         {
-            throw invalid_argument("loc_func_count is out of range");
+            throw invalid_argument("items and out cannot be null");
         }
-        if (table_size < min_table_size || table_size > max_table_size)
+
+        const uint32_t lfc = loc_func_count();
+        vector<location_type> group_locations(query_batch_group_size_ * lfc);
+        for (size_t group_start = 0; group_start < count; group_start += query_batch_group_size_)
         {
-            throw invalid_argument("table_size is out of range");
+            const size_t group_count = min(query_batch_group_size_, count - group_start);
+            const item_type *group_items = items + group_start;
+
+            // Stage 1: hash the whole group and issue the loads for all of its locations
+            if (any_of(group_items, group_items + group_count, [&](const item_type &item) {
+                    return is_empty_item(item);
+                }))
+            {
+                throw invalid_argument("item cannot be the empty item");
+            }
+            loc_funcs_.locations(group_items, group_count, group_locations.data());
+            for (size_t j = 0; j < group_count * lfc; j++)
+            {
+                prefetch(table_.data() + group_locations[j]);
+            }
+
+            // Stage 2: by now the locations of the first items have arrived; compare
+            for (size_t j = 0; j < group_count; j++)
+            {
+                out[group_start + j] = query_at(group_items[j], group_locations.data() + j * lfc);
+            }
         }
+    }
+
+    KukuTable::KukuTable(
+        table_size_type table_size, table_size_type stash_size, uint32_t loc_func_count, item_type loc_func_seed,
+        uint64_t max_probe, item_type empty_item, LocFuncMode loc_func_mode, HashFamily hash_family)
+        : KukuTable(
+              table_size, stash_size, loc_func_count, loc_func_seed, max_probe, empty_item, loc_func_mode, hash_family,
+              vector<item_type>())
+    {}
+
+    KukuTable::KukuTable(
+        table_size_type table_size, table_size_type stash_size, uint32_t loc_func_count, item_type loc_func_seed,
+        uint64_t max_probe, item_type empty_item, LocFuncMode loc_func_mode, HashFamily hash_family,
+        vector<item_type> &&table_storage)
+        : table_(move(table_storage)), stash_index_(stash_size),
+          loc_funcs_(table_size, loc_func_count, loc_func_seed, loc_func_mode, hash_family), table_size_(table_size),
+          stash_size_(stash_size), loc_func_seed_(loc_func_seed), max_probe_(max_probe), empty_item_(empty_item),
+          leftover_item_(empty_item_), gen_(random_uint64())
+    {
+        // The location (hash) functions have already validated loc_func_count and table_size
         if (!max_probe)
         {
             throw invalid_argument("max_probe cannot be zero");
         }
 
-        // Allocate the hash table
-        table_.resize(table_size_, empty_item_);
-
-        // Create the location (hash) functions
-        generate_loc_funcs(loc_func_count, loc_func_seed_);
+        // Allocate the hash table, or reuse the given storage if it is large enough
+        table_.assign(table_size_, empty_item_);
 
         // Set up the distribution for location function sampling
         u_ = std::uniform_int_distribution<uint32_t>(0, loc_func_count - 1);
@@ -73,68 +126,806 @@ namespace kuku
             throw invalid_argument("item cannot be the empty item");
         }
 
-        set<location_type> result;
-        for (auto lf : loc_funcs_)
+        array<location_type, max_loc_func_count> locations;
+        loc_funcs_.locations(item, locations.data());
+        return { locations.begin(), locations.begin() + loc_func_count() };
+    }
+
+    void KukuTable::locations(const item_type *items, size_t count, location_type *out) const
+    {
+        if (count && (nullptr == items || nullptr == out))
         {
-            result.emplace(lf(item));
+            throw invalid_argument("items and out cannot be null");
         }
-        return result;
+        if (any_of(items, items + count, [&](const item_type &item) { return is_empty_item(item); }))
+        {
+            throw invalid_argument("item cannot be the empty item");
+        }
+
+        loc_funcs_.locations(items, count, out);
     }
 
     void KukuTable::clear_table() noexcept
     {
         std::fill(table_.begin(), table_.end(), empty_item_);
         stash_.clear();
+        stash_index_.clear();
         leftover_item_ = empty_item_;
         inserted_items_ = 0;
     }
 
-    void KukuTable::generate_loc_funcs(uint32_t loc_func_count, item_type seed)
+    SaveHeader KukuTable::save_header() const noexcept
+    {
+        SaveHeader header;
+        header.table_size = table_size_;
+        header.stash_size = stash_size_;
+        header.loc_func_count = loc_func_count();
+        header.loc_func_mode = loc_func_mode();
+        header.hash_family = hash_family();
+        header.insert_strategy = insert_strategy_;
+        header.max_probe = max_probe_;
+        header.loc_func_seed = loc_func_seed_;
+        header.empty_item = empty_item_;
+        header.leftover_item = leftover_item_;
+        header.inserted_items = inserted_items_;
+        header.stash_count = static_cast<table_size_type>(stash_.size());
+        return header;
+    }
+
+    unique_ptr<KukuTable> KukuTable::from_save_header(const SaveHeader &header)
+    {
+        // The constructor validates the parameters of the table
+        auto table = make_unique<KukuTable>(
+            header.table_size, header.stash_size, header.loc_func_count, header.loc_func_seed, header.max_probe,
+            header.empty_item, header.loc_func_mode, header.hash_family);
+        table->set_insert_strategy(header.insert_strategy);
+        if (header.stash_count > header.stash_size ||
+            static_cast<uint64_t>(header.inserted_items) >
+                static_cast<uint64_t>(header.table_size) + static_cast<uint64_t>(header.stash_count))
+        {
+            throw invalid_argument("saved KukuTable is invalid");
+        }
+        table->stash_.resize(header.stash_count);
+        table->leftover_item_ = header.leftover_item;
+        table->inserted_items_ = header.inserted_items;
+        return table;
+    }
+
+    size_t KukuTable::save_size() const noexcept
+    {
+        return SaveHeader::size + (table_.size() + stash_.size()) * bytes_per_item + SaveHeader::checksum_size;
+    }
+
+    size_t KukuTable::save(ostream &stream) const
+    {
+        array<unsigned char, SaveHeader::size + SaveHeader::checksum_size> header;
+        save_header().write(header.data());
+
+        // The checksum follows the stash; stage it behind the header to write it from the same buffer
+        unsigned char *checksum = header.data() + SaveHeader::size;
+        write_le(checksum, save_checksum(header.data(), table_.data(), table_.size(), stash_.data(), stash_.size()));
+
+        stream.write(reinterpret_cast<const char *>(header.data()), static_cast<streamsize>(SaveHeader::size));
+        stream.write(
+            reinterpret_cast<const char *>(table_.data()), static_cast<streamsize>(table_.size() * bytes_per_item));
+        stream.write(
+            reinterpret_cast<const char *>(stash_.data()), static_cast<streamsize>(stash_.size() * bytes_per_item));
+        stream.write(
+            reinterpret_cast<const char *>(header.data() + SaveHeader::size),
+            static_cast<streamsize>(SaveHeader::checksum_size));
+        if (!stream)
+        {
+            throw runtime_error("failed to write KukuTable to stream");
+        }
+        return save_size();
+    }
+
+    size_t KukuTable::save(byte *out, size_t size) const
     {
-        loc_funcs_.clear();
-        while (loc_func_count--)
+        if (nullptr == out)
+        {
+            throw invalid_argument("out cannot be null");
+        }
+        if (size < save_size())
         {
-            loc_funcs_.emplace_back(table_size_, seed);
-            increment_item(seed);
+            throw invalid_argument("size is too small");
         }
+
+        auto ptr = reinterpret_cast<unsigned char *>(out);
+        save_header().write(ptr);
+        const uint64_t checksum = save_checksum(ptr, table_.data(), table_.size(), stash_.data(), stash_.size());
+        ptr += SaveHeader::size;
+        memcpy(ptr, table_.data(), table_.size() * bytes_per_item);
+        ptr += table_.size() * bytes_per_item;
+        if (!stash_.empty())
+        {
+            memcpy(ptr, stash_.data(), stash_.size() * bytes_per_item);
+            ptr += stash_.size() * bytes_per_item;
+        }
+        write_le(ptr, checksum);
+        return save_size();
+    }
+
+    unique_ptr<KukuTable> KukuTable::load(istream &stream)
+    {
+        array<unsigned char, SaveHeader::size> header_data;
+        stream.read(reinterpret_cast<char *>(header_data.data()), static_cast<streamsize>(header_data.size()));
+        if (!stream)
+        {
+            throw runtime_error("failed to read KukuTable from stream");
+        }
+        auto table = from_save_header(SaveHeader::read(header_data.data()));
+
+        // Read the table and stash directly into place
+        array<unsigned char, SaveHeader::checksum_size> checksum_data;
+        stream.read(
+            reinterpret_cast<char *>(table->table_.data()),
+            static_cast<streamsize>(table->table_.size() * bytes_per_item));
+        stream.read(
+            reinterpret_cast<char *>(table->stash_.data()),
+            static_cast<streamsize>(table->stash_.size() * bytes_per_item));
+        stream.read(reinterpret_cast<char *>(checksum_data.data()), static_cast<streamsize>(checksum_data.size()));
+        if (!stream)
+        {
+            throw runtime_error("failed to read KukuTable from stream");
+        }
+
+        const unsigned char *checksum = checksum_data.data();
+        if (read_le<uint64_t>(checksum) !=
+            save_checksum(
+                header_data.data(), table->table_.data(), table->table_.size(), table->stash_.data(),
+                table->stash_.size()))
+        {
+            throw invalid_argument("KukuTable checksum does not match");
+        }
+        table->stash_index_.rebuild(table->stash_.data(), table->stash_.size());
+        return table;
+    }
+
+    unique_ptr<KukuTable> KukuTable::load(const byte *in, size_t size)
+    {
+        if (nullptr == in)
+        {
+            throw invalid_argument("in cannot be null");
+        }
+        if (size < SaveHeader::size + SaveHeader::checksum_size)
+        {
+            throw invalid_argument("size is too small");
+        }
+
+        auto ptr = reinterpret_cast<const unsigned char *>(in);
+        const SaveHeader header = SaveHeader::read(ptr);
+        if (size < SaveHeader::size + header.body_size() + SaveHeader::checksum_size)
+        {
+            throw invalid_argument("size is too small");
+        }
+
+        auto table = from_save_header(header);
+        const unsigned char *header_data = ptr;
+        ptr += SaveHeader::size;
+        memcpy(table->table_.data(), ptr, table->table_.size() * bytes_per_item);
+        ptr += table->table_.size() * bytes_per_item;
+        if (!table->stash_.empty())
+        {
+            memcpy(table->stash_.data(), ptr, table->stash_.size() * bytes_per_item);
+            ptr += table->stash_.size() * bytes_per_item;
+        }
+        if (read_le<uint64_t>(ptr) !=
+            save_checksum(
+                header_data, table->table_.data(), table->table_.size(), table->stash_.data(), table->stash_.size()))
+        {
+            throw invalid_argument("KukuTable checksum does not match");
+        }
+        table->stash_index_.rebuild(table->stash_.data(), table->stash_.size());
+        return table;
     }
 
     bool KukuTable::insert(item_type item)
     {
-        // Check if the item is already inserted or is the empty item
-        if (query(item))
+        if (is_empty_item(item))
+        {
+            throw invalid_argument("item cannot be the empty item");
+        }
+
+        // Check if the item is already inserted
+        array<location_type, max_loc_func_count> locations;
+        loc_funcs_.locations(item, locations.data());
+        if (query_at(item, locations.data()))
         {
             return false;
         }
 
-        uint64_t level = max_probe_;
-        while (level--)
+        return insert_new(item, locations.data());
+    }
+
+    vector<item_type> KukuTable::insert_batch(const item_type *items, size_t count, bool *results)
+    {
+        if (count && (nullptr == items || nullptr == results))
         {
-            // Loop over all possible locations
-            for (uint32_t i = 0; i < loc_func_count(); i++)
+            throw invalid_argument("items and results cannot be null");
+        }
+
+        // Reject the empty item up front so that a bad batch leaves the table untouched
+        if (any_of(items, items + count, [&](const item_type &item) { return is_empty_item(item); }))
+        {
+            throw invalid_argument("item cannot be the empty item");
+        }
+
+        // Ring buffer holding the locations of the items in the prefetch window
+        const uint32_t lfc = loc_func_count();
+        vector<location_type> window(insert_batch_prefetch_distance_ * lfc);
+        auto prefetch_item = [&](size_t index) {
+            location_type *locations = window.data() + (index % insert_batch_prefetch_distance_) * lfc;
+            loc_funcs_.locations(items[index], locations);
+            for (uint32_t i = 0; i < lfc; i++)
+            {
+                prefetch(table_.data() + locations[i]);
+            }
+        };
+
+        for (size_t index = 0; index < min(count, insert_batch_prefetch_distance_); index++)
+        {
+            prefetch_item(index);
+        }
+
+        vector<item_type> leftover_items;
+        for (size_t index = 0; index < count; index++)
+        {
+            const location_type *locations = window.data() + (index % insert_batch_prefetch_distance_) * lfc;
+            if (query_at(items[index], locations))
+            {
+                results[index] = false;
+            }
+            else
+            {
+                results[index] = insert_new(items[index], locations);
+                if (!results[index])
+                {
+                    leftover_items.push_back(leftover_item_);
+                }
+            }
+
+            // The window slot for this item is free again; start fetching the item that reuses it
+            if (index + insert_batch_prefetch_distance_ < count)
+            {
+                prefetch_item(index + insert_batch_prefetch_distance_);
+            }
+        }
+
+        return leftover_items;
+    }
+
+    vector<item_type> KukuTable::build_parallel(
+        const item_type *items, size_t count, size_t thread_count, bool *results)
+    {
+        if (count && (nullptr == items || nullptr == results))
+        {
+            throw invalid_argument("items and results cannot be null");
+        }
+        if (any_of(items, items + count, [&](const item_type &item) { return is_empty_item(item); }))
+        {
+            throw invalid_argument("item cannot be the empty item");
+        }
+
+        if (!thread_count)
+        {
+            thread_count = max<size_t>(thread::hardware_concurrency(), 1);
+        }
+        thread_count = max<size_t>(min(thread_count, count / build_parallel_min_items_per_thread_), 1);
+        if (thread_count == 1)
+        {
+            // Claiming locations first only pays off when the claims are made in parallel
+            return insert_batch(items, count, results);
+        }
+        auto range_begin = [&](size_t t) { return count * t / thread_count; };
+
+        // The owner of every location is one plus the index of the item that claimed it, or zero; the upper bits
+        // hold a fingerprint of the item so that phase 2 rarely needs to read another item to detect duplicates
+        constexpr int owner_index_bits = 40;
+        constexpr uint64_t owner_index_mask = (uint64_t(1) << owner_index_bits) - 1;
+        if (static_cast<uint64_t>(count) >= owner_index_mask)
+        {
+            throw invalid_argument("count is too large");
+        }
+        auto owner_of = [&](size_t index) {
+            const uint64_t fingerprint = get_low_word(items[index]) ^ get_high_word(items[index]);
+            return (fingerprint << owner_index_bits) | (static_cast<uint64_t>(index) + 1);
+        };
+        unique_ptr<atomic<uint64_t>[]> owners(new atomic<uint64_t>[table_size_]());
+        vector<vector<size_t>> deferred(thread_count);
+        const uint32_t lfc = loc_func_count();
+
+        // Calls body(index, locations) for the items of a thread (only for those with results[index] set if
+        // claimed_only), computing the locations of upcoming items ahead of time and prefetching them as
+        // insert_batch does
+        auto for_each_prefetched = [&](size_t t, bool claimed_only, auto &&body) {
+            const size_t begin = range_begin(t);
+            const size_t end = range_begin(t + 1);
+            vector<location_type> window(insert_batch_prefetch_distance_ * lfc);
+            auto prefetch_item = [&](size_t index) {
+                if (claimed_only && !results[index])
+                {
+                    return;
+                }
+                location_type *locations = window.data() + (index % insert_batch_prefetch_distance_) * lfc;
+                loc_funcs_.locations(items[index], locations);
+                for (uint32_t i = 0; i < lfc; i++)
+                {
+                    prefetch(table_.data() + locations[i]);
+                    prefetch(owners.get() + locations[i]);
+                }
+            };
+            for (size_t index = begin; index < min(end, begin + insert_batch_prefetch_distance_); index++)
+            {
+                prefetch_item(index);
+            }
+            for (size_t index = begin; index < end; index++)
+            {
+                if (!claimed_only || results[index])
+                {
+                    body(index, window.data() + (index % insert_batch_prefetch_distance_) * lfc);
+                }
+                if (index + insert_batch_prefetch_distance_ < end)
+                {
+                    prefetch_item(index + insert_batch_prefetch_distance_);
+                }
+            }
+        };
+
+        // Phase 1: every thread claims an empty location for each of its items; the table is only read
+        run_threads(thread_count, [&](size_t t) {
+            for_each_prefetched(t, false, [&](size_t index, const location_type *locations) {
+                results[index] = false;
+                if (query_at(items[index], locations))
+                {
+                    return;
+                }
+                for (uint32_t i = 0; i < lfc && !results[index]; i++)
+                {
+                    uint64_t owner = 0;
+                    results[index] = is_empty_item(table_[locations[i]]) &&
+                                     !owners[locations[i]].load(memory_order_relaxed) &&
+                                     owners[locations[i]].compare_exchange_strong(
+                                         owner, owner_of(index), memory_order_relaxed);
+                }
+                if (!results[index])
+                {
+                    deferred[t].push_back(index);
+                }
+            });
+        });
+
+        // Phase 2: every thread writes its claimed items to the table; of several equal items that claimed a
+        // location, all share the same locations and only the one with the smallest index is kept
+        vector<table_size_type> placed(thread_count, 0);
+        run_threads(thread_count, [&](size_t t) {
+            for_each_prefetched(t, true, [&](size_t index, const location_type *locations) {
+                const uint64_t own = owner_of(index);
+                location_type claimed = 0;
+                for (uint32_t i = 0; i < lfc; i++)
+                {
+                    const uint64_t owner = owners[locations[i]].load(memory_order_relaxed);
+                    const uint64_t owner_index = (owner & owner_index_mask) - 1;
+                    if (owner == own)
+                    {
+                        claimed = locations[i];
+                    }
+                    else if (
+                        owner && (owner >> owner_index_bits) == (own >> owner_index_bits) && owner_index < index &&
+                        are_equal_item(items[owner_index], items[index]))
+                    {
+                        results[index] = false;
+                        return;
+                    }
+                }
+                table_[claimed] = items[index];
+                placed[t]++;
+            });
+        });
+        owners.reset();
+
+        const table_size_type placed_count = accumulate(placed.begin(), placed.end(), table_size_type(0));
+        inserted_items_ += placed_count;
+#ifdef KUKU_USE_STATS
+        stats_.walk_histogram[0] += placed_count;
+#endif
+
+        // Phase 3: insert the remaining items in order on this thread
+        vector<item_type> leftover_items;
+        array<location_type, max_loc_func_count> locations;
+        for (const auto &thread_deferred : deferred)
+        {
+            for (size_t index : thread_deferred)
+            {
+                loc_funcs_.locations(items[index], locations.data());
+                if (query_at(items[index], locations.data()))
+                {
+                    continue;
+                }
+                results[index] = insert_new(items[index], locations.data());
+                if (!results[index])
+                {
+                    leftover_items.push_back(leftover_item_);
+                }
+            }
+        }
+
+        return leftover_items;
+    }
+
+    unique_ptr<KukuTable> KukuTable::build_with_seeds(
+        table_size_type table_size, table_size_type stash_size, uint32_t loc_func_count,
+        const item_type *loc_func_seeds, size_t seed_count, uint64_t max_probe, item_type empty_item,
+        const item_type *items, size_t count, size_t thread_count, LocFuncMode loc_func_mode, HashFamily hash_family)
+    {
+        if (nullptr == loc_func_seeds || !seed_count)
+        {
+            throw invalid_argument("loc_func_seeds cannot be null or empty");
+        }
+        if (count && nullptr == items)
+        {
+            throw invalid_argument("items cannot be null");
+        }
+        if (any_of(items, items + count, [&](const item_type &item) { return are_equal_item(item, empty_item); }))
+        {
+            throw invalid_argument("item cannot be the empty item");
+        }
+
+        if (!thread_count)
+        {
+            thread_count = max<size_t>(thread::hardware_concurrency(), 1);
+        }
+        thread_count = min(thread_count, seed_count);
+
+        // Every thread takes the next untried seed until some build succeeds or fails with an exception
+        atomic<size_t> next_seed(0);
+        atomic<bool> done(false);
+        unique_ptr<KukuTable> winner;
+        exception_ptr error;
+        mutex winner_mutex;
+
+        run_threads(thread_count, [&](size_t) {
+            try
+            {
+                vector<item_type> table_storage;
+                unique_ptr<bool[]> results(new bool[min(count, build_with_seeds_chunk_size_)]);
+                for (size_t seed = next_seed++; seed < seed_count && !done.load(memory_order_relaxed);
+                     seed = next_seed++)
+                {
+                    unique_ptr<KukuTable> table(new KukuTable(
+                        table_size, stash_size, loc_func_count, loc_func_seeds[seed], max_probe, empty_item,
+                        loc_func_mode, hash_family, move(table_storage)));
+
+                    // Insert in chunks, checking for cancellation in between
+                    bool failed = false;
+                    for (size_t begin = 0; begin < count && !failed && !done.load(memory_order_relaxed);
+                         begin += build_with_seeds_chunk_size_)
+                    {
+                        const size_t chunk_size = min(count - begin, build_with_seeds_chunk_size_);
+                        failed = !table->insert_batch(items + begin, chunk_size, results.get()).empty();
+                    }
+                    if (!failed && !done.exchange(true))
+                    {
+                        lock_guard<mutex> lock(winner_mutex);
+                        winner = move(table);
+                        return;
+                    }
+
+                    // Reuse the allocation for the next seed
+                    table_storage = move(table->table_);
+                }
+            }
+            catch (...)
+            {
+                lock_guard<mutex> lock(winner_mutex);
+                if (!error)
+                {
+                    error = current_exception();
+                }
+                done = true;
+            }
+        });
+
+        if (!winner && error)
+        {
+            rethrow_exception(error);
+        }
+        return winner;
+    }
+
+    void KukuTable::set_insert_strategy(InsertStrategy insert_strategy)
+    {
+        switch (insert_strategy)
+        {
+        case InsertStrategy::random_walk:
+            bfs_nodes_ = vector<BFSNode>();
+            bfs_max_expansions_ = 0;
+            break;
+        case InsertStrategy::bfs:
+        {
+            bfs_max_expansions_ = min<uint64_t>(max_probe_, table_size_);
+            // Every expanded item adds at most loc_func_count - 1 alternative locations; node indices must fit in
+            // 32 bits
+            const uint64_t max_nodes =
+                min<uint64_t>(bfs_max_expansions_ * (loc_func_count() - 1) + loc_func_count(), bfs_no_parent_);
+            bfs_nodes_.clear();
+            bfs_nodes_.reserve(static_cast<size_t>(max_nodes));
+            break;
+        }
+        default:
+            throw invalid_argument("insert_strategy is invalid");
+        }
+        insert_strategy_ = insert_strategy;
+    }
+
+    bool KukuTable::insert_new(item_type item, const location_type *locations)
+    {
+        if (insert_strategy_ == InsertStrategy::bfs)
+        {
+            return insert_bfs(item, locations);
+        }
+        return insert_random_walk(item, locations);
+    }
+
+    bool KukuTable::insert_random_walk(item_type item, const location_type *locations)
+    {
+        const uint32_t lfc = loc_func_count();
+        const uint64_t steps = detail::random_walk(
+            item, locations, max_probe_,
+            [&](const item_type &walk_item, const location_type *walk_locations) {
+                const uint32_t i = detail::find_at_locations(table_.data(), empty_item_, walk_locations, lfc);
+                if (i < lfc)
+                {
+                    table_[walk_locations[i]] = walk_item;
+                    return true;
+                }
+                return false;
+            },
+            [&](item_type &walk_item, const location_type *walk_locations) {
+                walk_item = swap(walk_item, walk_locations[u_(gen_)]);
+            },
+            [&](const item_type &walk_item, location_type *out) { loc_funcs_.locations(walk_item, out); });
+#ifdef KUKU_USE_STATS
+        stats_.evictions += steps;
+        record_walk(steps);
+#endif
+        if (steps < max_probe_)
+        {
+            inserted_items_++;
+            return true;
+        }
+
+        // The walk ran out of steps; try stash
+        return insert_stash(item);
+    }
+
+    bool KukuTable::insert_bfs(item_type item, const location_type *locations)
+    {
+        const uint32_t lfc = loc_func_count();
+        for (uint32_t i = 0; i < lfc; i++)
+        {
+            if (is_empty_item(table_[locations[i]]))
             {
-                location_type loc = location(item, i);
+                table_[locations[i]] = item;
+                inserted_items_++;
+#ifdef KUKU_USE_STATS
+                record_walk(0);
+#endif
+                return true;
+            }
+        }
+
+        // The roots of the search are the distinct locations of the item
+        bfs_nodes_.clear();
+        for (uint32_t i = 0; i < lfc; i++)
+        {
+            if (find(locations, locations + i, locations[i]) == locations + i)
+            {
+                bfs_nodes_.push_back({ locations[i], bfs_no_parent_ });
+            }
+        }
+
+        // A location already on the path from the root to a node cannot be reused on the same path
+        auto on_path = [&](uint32_t node, location_type loc) {
+            for (; node != bfs_no_parent_; node = bfs_nodes_[node].parent)
+            {
+                if (bfs_nodes_[node].location == loc)
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        array<location_type, max_loc_func_count> alt_locations;
+        for (uint32_t head = 0; head < bfs_nodes_.size() && head < bfs_max_expansions_; head++)
+        {
+            const location_type node_location = bfs_nodes_[head].location;
+            loc_funcs_.locations(table_[node_location], alt_locations.data());
+            for (uint32_t i = 0; i < lfc; i++)
+            {
+                const location_type loc = alt_locations[i];
+                if (loc == node_location || on_path(head, loc))
+                {
+                    continue;
+                }
+
                 if (is_empty_item(table_[loc]))
                 {
-                    table_[loc] = item;
+                    // Move every item on the path one step towards the empty location, then place the new item
+                    location_type to = loc;
+                    uint64_t moves = 0;
+                    for (uint32_t node = head; node != bfs_no_parent_; node = bfs_nodes_[node].parent)
+                    {
+                        table_[to] = table_[bfs_nodes_[node].location];
+                        to = bfs_nodes_[node].location;
+                        moves++;
+                    }
+                    table_[to] = item;
                     inserted_items_++;
+#ifdef KUKU_USE_STATS
+                    stats_.evictions += moves;
+                    record_walk(moves);
+#endif
                     return true;
                 }
-            }
 
-            // Swap in the current item and in next round try the popped out item
-            item = swap(item, location(item, static_cast<uint32_t>(u_(gen_))));
+                if (bfs_nodes_.size() < bfs_nodes_.capacity())
+                {
+                    bfs_nodes_.push_back({ loc, head });
+                }
+            }
         }
 
-        // level reached zero; try stash
+#ifdef KUKU_USE_STATS
+        record_walk(0);
+#endif
+
+        // No path was found and nothing was moved; try stash
+        return insert_stash(item);
+    }
+
+    bool KukuTable::insert_stash(item_type item)
+    {
         if (stash_.size() < stash_size_)
         {
             stash_.push_back(item);
+            stash_index_.add(stash_.data(), stash_.size() - 1);
             inserted_items_++;
+#ifdef KUKU_USE_STATS
+            stats_.stash_inserts++;
+#endif
             return true;
         }
 
         leftover_item_ = item;
+#ifdef KUKU_USE_STATS
+        stats_.failed_inserts++;
+#endif
         return false;
     }
+
+    bool KukuTable::erase(item_type item)
+    {
+        const QueryResult result = query(item);
+        if (!result)
+        {
+            return false;
+        }
+
+        erase_at(result);
+        if (!result.in_stash())
+        {
+            backfill_stash();
+        }
+        return true;
+    }
+
+    size_t KukuTable::erase_batch(const item_type *items, size_t count, bool *results)
+    {
+        if (count && (nullptr == items || nullptr == results))
+        {
+            throw invalid_argument("items and results cannot be null");
+        }
+        if (any_of(items, items + count, [&](const item_type &item) { return is_empty_item(item); }))
+        {
+            throw invalid_argument("item cannot be the empty item");
+        }
+
+        const uint32_t lfc = loc_func_count();
+        vector<location_type> group_locations(query_batch_group_size_ * lfc);
+        size_t erased = 0;
+        for (size_t group_start = 0; group_start < count; group_start += query_batch_group_size_)
+        {
+            const size_t group_count = min(query_batch_group_size_, count - group_start);
+            const item_type *group_items = items + group_start;
+            loc_funcs_.locations(group_items, group_count, group_locations.data());
+            for (size_t j = 0; j < group_count * lfc; j++)
+            {
+                prefetch(table_.data() + group_locations[j]);
+            }
+
+            // Erase in order, so that of several equal items in the batch only the first is reported as erased
+            for (size_t j = 0; j < group_count; j++)
+            {
+                const QueryResult result = query_at(group_items[j], group_locations.data() + j * lfc);
+                results[group_start + j] = result.found();
+                if (result)
+                {
+                    erase_at(result);
+                    erased++;
+                }
+            }
+        }
+
+        backfill_stash();
+        return erased;
+    }
+
+    void KukuTable::erase_at(const QueryResult &result) noexcept
+    {
+        if (result.in_stash())
+        {
+            stash_.erase(stash_.begin() + static_cast<ptrdiff_t>(result.location()));
+            stash_index_.rebuild(stash_.data(), stash_.size());
+        }
+        else
+        {
+            table_[result.location()] = empty_item_;
+        }
+        inserted_items_--;
+    }
+
+    void KukuTable::backfill_stash() noexcept
+    {
+        array<location_type, max_loc_func_count> locations;
+        const size_t stash_count = stash_.size();
+        for (size_t index = 0; index < stash_.size();)
+        {
+            loc_funcs_.locations(stash_[index], locations.data());
+            const auto loc = find_if(locations.begin(), locations.begin() + loc_func_count(), [&](location_type l) {
+                return is_empty_item(table_[l]);
+            });
+            if (loc == locations.begin() + loc_func_count())
+            {
+                index++;
+                continue;
+            }
+
+            table_[*loc] = stash_[index];
+            stash_.erase(stash_.begin() + static_cast<ptrdiff_t>(index));
+        }
+        if (stash_.size() != stash_count)
+        {
+            stash_index_.rebuild(stash_.data(), stash_.size());
+        }
+    }
+
+#ifdef KUKU_USE_STATS
+    KukuTableStats KukuTable::stats() const
+    {
+        KukuTableStats result = stats_;
+        result.loc_func_occupancy.assign(loc_func_count(), 0);
+
+        array<location_type, max_loc_func_count> locations;
+        for (location_type loc = 0; loc < table_size_; loc++)
+        {
+            if (is_empty_item(table_[loc]))
+            {
+                continue;
+            }
+
+            loc_funcs_.locations(table_[loc], locations.data());
+            for (uint32_t i = 0; i < loc_func_count(); i++)
+            {
+                if (locations[i] == loc)
+                {
+                    result.loc_func_occupancy[i]++;
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+#endif
 } // namespace kuku
@@ -5,6 +5,10 @@
 
 #include "kuku/common.h"
 #include "kuku/locfunc.h"
+#include "kuku/internal/lookup.h"
+#include <array>
+#include <cstddef>
+#include <iosfwd>
 #include <memory>
 #include <random>
 #include <set>
@@ -15,6 +19,76 @@ namespace kuku
 {
     class QueryResult;
 
+    struct SaveHeader;
+
+    template <std::size_t ItemBytes>
+    class SizedKukuTable;
+
+    /**
+    Specifies how KukuTable finds room for a new item whose locations are all occupied.
+    */
+    enum class InsertStrategy : std::uint8_t
+    {
+        /**
+        Random walk cuckoo hashing: the item is swapped into a uniformly random one of its locations, and the evicted
+        item is re-inserted the same way, for at most max_probe steps. Every step writes to the table.
+        */
+        random_walk = 0,
+
+        /**
+        Breadth-first search: the items occupying the locations of the new item, then the items occupying their
+        alternative locations, and so on, are searched for the shortest chain of moves that ends at an empty location.
+        The search expands at most max_probe items and moves nothing until a chain is found, so an insert moves as few
+        items as possible and a failed insert leaves the table untouched.
+        */
+        bfs = 1
+    };
+
+#ifdef KUKU_USE_STATS
+    /**
+    Insertion statistics of a KukuTable, returned by KukuTable::stats(). The counters cover all calls to insert and
+    insert_batch for items not already in the table since the table was created or reset_stats() was last called;
+    clear_table() does not reset them. Statistics are available only when Kuku is built with KUKU_USE_STATS=ON.
+    */
+    struct KukuTableStats
+    {
+        /**
+        The number of buckets in walk_histogram.
+        */
+        static constexpr std::size_t walk_histogram_size = 65;
+
+        /**
+        A histogram of the number of random walk steps (evictions) taken per insert. Bucket 0 counts the inserts that
+        took no steps and bucket i > 0 counts the inserts that took between 2^(i - 1) and 2^i - 1 steps. With
+        InsertStrategy::random_walk, inserts that ended in the stash or failed took max_probe steps; with
+        InsertStrategy::bfs they took none.
+        */
+        std::array<std::uint64_t, walk_histogram_size> walk_histogram{};
+
+        /**
+        The total number of items evicted from their location during random walks or moved along BFS paths.
+        */
+        std::uint64_t evictions = 0;
+
+        /**
+        The number of inserts that placed an item in the stash.
+        */
+        std::uint64_t stash_inserts = 0;
+
+        /**
+        The number of inserts that failed and produced a leftover item.
+        */
+        std::uint64_t failed_inserts = 0;
+
+        /**
+        The number of items in the table, not counting the stash, placed at the location given by each location
+        function; entry i is for the location function of index i. An item at a location given by more than one
+        location function is counted for the lowest such index. This reflects the current table contents.
+        */
+        std::vector<std::uint64_t> loc_func_occupancy;
+    };
+#endif
+
     /**
     The KukuTable class represents a cuckoo hash table. It includes information about the location functions (hash
     functions) and holds the items inserted into the table.
@@ -29,25 +103,137 @@ namespace kuku
         @param[in] stash_size The size of the stash (possibly zero)
         @param[in] loc_func_count The number of location functions (hash functions) to use
         @param[in] loc_func_seed The 128-bit seed for the location functions, represented as a hash table item
-        @param[in] max_probe The maximum number of random walk steps taken in attempting to insert an item
+        @param[in] max_probe The maximum number of random walk steps taken, or of items expanded by the breadth-first
+        search (see InsertStrategy), in attempting to insert an item
         @param[in] empty_item A hash table item that represents an empty location in the table
+        @param[in] loc_func_mode Whether the location functions use independent hash functions or are derived from
+        two hash functions; the latter reduces memory and hashing work when loc_func_count is large
+        @param[in] hash_family The family of the hash functions underlying the location functions; the non-default
+        families hash faster at the cost of weaker independence guarantees
         @throws std::invalid_argument if loc_func_count is too large or too small
         @throws std::invalid_argument if table_size is too large or too small
         @throws std::invalid_argument if max_probe is zero
+        @throws std::invalid_argument if loc_func_mode or hash_family is invalid
         */
         KukuTable(
             table_size_type table_size, table_size_type stash_size, std::uint32_t loc_func_count,
-            item_type loc_func_seed, std::uint64_t max_probe, item_type empty_item);
+            item_type loc_func_seed, std::uint64_t max_probe, item_type empty_item,
+            LocFuncMode loc_func_mode = LocFuncMode::independent, HashFamily hash_family = HashFamily::tabulation);
 
         /**
-        Adds a single item to the hash table using random walk cuckoo hashing. The return value indicates whether
-        the item was successfully inserted (possibly into the stash) or not.
+        Adds a single item to the hash table using cuckoo hashing with the current insert strategy (random walk by
+        default). The return value indicates whether the item was successfully inserted (possibly into the stash) or
+        not.
 
         @param[in] item The hash table item to insert
         @throws std::invalid_argument if the given item is the empty item for this hash table
         */
         [[nodiscard]] bool insert(item_type item);
 
+        /**
+        Adds a batch of items to the hash table. The items are inserted in order with the same semantics as calling
+        insert on each of them, but the locations of upcoming items are computed ahead of time and their table
+        locations are prefetched, so that the cache misses of consecutive insertions overlap.
+
+        For every item whose insertion fails, the resulting leftover item (see leftover_item()) is appended to the
+        returned vector. Items that are already present in the table are reported as unsuccessful in results but do
+        not produce a leftover item.
+
+        @param[in] items Pointer to the items to insert
+        @param[in] count The number of items to insert
+        @param[out] results Pointer to an array of count booleans indicating per-item success
+        @throws std::invalid_argument if items or results is null and count is non-zero
+        @throws std::invalid_argument if any of the given items is the empty item for this hash table; in this case
+        the hash table is not modified
+        */
+        std::vector<item_type> insert_batch(const item_type *items, std::size_t count, bool *results);
+
+        /**
+        Adds a large batch of items to the hash table using multiple threads. First, the threads concurrently claim
+        an empty location for every item by an atomic compare-and-swap on a per-location owner array, and write the
+        items whose claim succeeded to the table; then the remaining items, whose locations were all occupied or
+        claimed, are inserted one by one with the current insert strategy on the calling thread. The location
+        functions are the same as for insert, so the resulting table can be queried as usual, but the placement of
+        items generally differs from inserting them in order.
+
+        For every item whose insertion fails, the resulting leftover item (see leftover_item()) is appended to the
+        returned vector. Items that are already present in the table are reported as unsuccessful in results but do
+        not produce a leftover item; of several equal items in the batch, exactly one is reported as successful. The
+        hash table must not be accessed by other threads during the call.
+
+        @param[in] items Pointer to the items to insert
+        @param[in] count The number of items to insert
+        @param[in] thread_count The number of threads to use; zero uses one thread per hardware thread
+        @param[out] results Pointer to an array of count booleans indicating per-item success
+        @throws std::invalid_argument if items or results is null and count is non-zero
+        @throws std::invalid_argument if count is 2^40 or more
+        @throws std::invalid_argument if any of the given items is the empty item for this hash table; in this case
+        the hash table is not modified
+        */
+        std::vector<item_type> build_parallel(
+            const item_type *items, std::size_t count, std::size_t thread_count, bool *results);
+
+        /**
+        Builds a hash table holding a given set of items when the location function seed is not fixed, such as when
+        insertion fails for one seed and the table size cannot change. Candidate tables for the given seeds are built
+        concurrently, every thread taking the next untried seed when its build fails. The first build that inserts
+        every item wins and the builds still in progress are cancelled; the seeds are therefore not necessarily tried
+        in order, and the seed of the returned table can be read with loc_func_seed(). Every thread reuses the table
+        allocation of its failed builds. Returns null if the build fails for every seed.
+
+        The items are inserted with the random walk insert strategy as by insert_batch; repeated items are inserted
+        once.
+
+        @param[in] table_size The size of the hash table
+        @param[in] stash_size The size of the stash (possibly zero)
+        @param[in] loc_func_count The number of location functions (hash functions) to use
+        @param[in] loc_func_seeds Pointer to the candidate 128-bit seeds for the location functions
+        @param[in] seed_count The number of candidate seeds
+        @param[in] max_probe The maximum number of random walk steps taken in attempting to insert an item
+        @param[in] empty_item A hash table item that represents an empty location in the table
+        @param[in] items Pointer to the items to insert
+        @param[in] count The number of items to insert
+        @param[in] thread_count The number of threads to use; zero uses one thread per hardware thread
+        @param[in] loc_func_mode Whether the location functions use independent hash functions or are derived from
+        two hash functions
+        @param[in] hash_family The family of the hash functions underlying the location functions
+        @throws std::invalid_argument if loc_func_seeds is null or seed_count is zero
+        @throws std::invalid_argument if items is null and count is non-zero
+        @throws std::invalid_argument if any of the given items is the empty item
+        @throws std::invalid_argument if the remaining parameters are invalid as for the constructor
+        */
+        [[nodiscard]] static std::unique_ptr<KukuTable> build_with_seeds(
+            table_size_type table_size, table_size_type stash_size, std::uint32_t loc_func_count,
+            const item_type *loc_func_seeds, std::size_t seed_count, std::uint64_t max_probe, item_type empty_item,
+            const item_type *items, std::size_t count, std::size_t thread_count = 0,
+            LocFuncMode loc_func_mode = LocFuncMode::independent, HashFamily hash_family = HashFamily::tabulation);
+
+        /**
+        Removes a single item from the hash table or stash. The return value indicates whether the item was found and
+        removed. After removing an item from the table, every stash item that has an empty location is moved back
+        into the table, so that the stash stays small and queries stay cheap. The fill rate is updated accordingly;
+        the leftover item is not affected.
+
+        @param[in] item The hash table item to remove
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        bool erase(item_type item);
+
+        /**
+        Removes a batch of items from the hash table and stash. The items are removed in order with the same semantics
+        as calling erase on each of them, except that stash items are moved back into the table only once, after all
+        items have been removed. The locations of the items are computed and prefetched in groups, as in query_batch.
+        The return value is the number of items that were found and removed.
+
+        @param[in] items Pointer to the items to remove
+        @param[in] count The number of items to remove
+        @param[out] results Pointer to an array of count booleans indicating per-item success
+        @throws std::invalid_argument if items or results is null and count is non-zero
+        @throws std::invalid_argument if any of the given items is the empty item for this hash table; in this case
+        the hash table is not modified
+        */
+        std::size_t erase_batch(const item_type *items, std::size_t count, bool *results);
+
         /**
         Queries for the presence of a given item in the hash table and stash.
 
@@ -56,6 +242,20 @@ namespace kuku
         */
         [[nodiscard]] QueryResult query(item_type item) const;
 
+        /**
+        Queries for the presence of a batch of items in the hash table and stash. The result for items[i] is written
+        to out[i] and is identical to the result of query(items[i]). The items are processed in groups: the locations
+        of every item in a group are computed and prefetched before any of them is compared, so that the table
+        accesses of the whole group are in flight at the same time.
+
+        @param[in] items Pointer to the items to query
+        @param[in] count The number of items to query
+        @param[out] out Pointer to an array of count query results
+        @throws std::invalid_argument if items or out is null and count is non-zero
+        @throws std::invalid_argument if any of the given items is the empty item for this hash table
+        */
+        void query_batch(const item_type *items, std::size_t count, QueryResult *out) const;
+
         /**
         Returns a location that a given hash table item may be placed at.
 
@@ -66,7 +266,7 @@ namespace kuku
         */
         [[nodiscard]] location_type location(item_type item, std::uint32_t loc_func_index) const
         {
-            if (loc_func_index >= loc_funcs_.size())
+            if (loc_func_index >= loc_func_count())
             {
                 throw std::out_of_range("loc_func_index is out of range");
             }
@@ -74,9 +274,23 @@ namespace kuku
             {
                 throw std::invalid_argument("item cannot be the empty item");
             }
-            return loc_funcs_[loc_func_index](item);
+            return loc_funcs_(item, loc_func_index);
         }
 
+        /**
+        Computes the locations of a batch of items for all location functions. The location of items[i] for location
+        function j is written to out[i * loc_func_count() + j]. Every item is hashed with all location functions in one
+        pass over the interleaved hash tables of the location functions (see LocFuncBank), which is faster than calling
+        location for every item and location function.
+
+        @param[in] items Pointer to the hash table items for which the locations are to be computed
+        @param[in] count The number of items
+        @param[out] out Pointer to an array of count * loc_func_count() locations
+        @throws std::invalid_argument if items or out is null and count is non-zero
+        @throws std::invalid_argument if any of the given items is the empty item for this hash table
+        */
+        void locations(const item_type *items, std::size_t count, location_type *out) const;
+
         /**
         Returns all hash table locations that this item may be placed at.
 
@@ -89,12 +303,59 @@ namespace kuku
         */
         void clear_table() noexcept;
 
+        /**
+        Returns the number of bytes that save writes for the hash table in its current state.
+        */
+        [[nodiscard]] std::size_t save_size() const noexcept;
+
+        /**
+        Saves the hash table to a stream in a versioned little-endian binary format: a header with the parameters of
+        the table, the raw contents of the table and stash, and an XXH64 checksum of everything before it. Returns
+        the number of bytes written. Insertion statistics are not saved.
+
+        @param[out] stream The stream to save the hash table to
+        @throws std::runtime_error if writing to the stream fails
+        */
+        std::size_t save(std::ostream &stream) const;
+
+        /**
+        Saves the hash table to a buffer in the format written by save(std::ostream &). Returns the number of bytes
+        written, which is save_size().
+
+        @param[out] out The buffer to save the hash table to
+        @param[in] size The size of the buffer in bytes
+        @throws std::invalid_argument if out is null or size is smaller than save_size()
+        */
+        std::size_t save(std::byte *out, std::size_t size) const;
+
+        /**
+        Loads a hash table saved with save from a stream. The table and stash are read directly into place; no item
+        is re-inserted.
+
+        @param[in] stream The stream to load the hash table from
+        @throws std::invalid_argument if the data is not a saved hash table, has an unsupported version, or its
+        checksum does not match
+        @throws std::runtime_error if reading from the stream fails
+        */
+        [[nodiscard]] static std::unique_ptr<KukuTable> load(std::istream &stream);
+
+        /**
+        Loads a hash table saved with save from a buffer. The table and stash are copied directly into place; no item
+        is re-inserted.
+
+        @param[in] in The buffer to load the hash table from
+        @param[in] size The size of the buffer in bytes
+        @throws std::invalid_argument if in is null, or the data is not a saved hash table, has an unsupported
+        version, is truncated, or its checksum does not match
+        */
+        [[nodiscard]] static std::unique_ptr<KukuTable> load(const std::byte *in, std::size_t size);
+
         /**
         Returns the number of location functions used by the hash table.
         */
         [[nodiscard]] std::uint32_t loc_func_count() const noexcept
         {
-            return static_cast<std::uint32_t>(loc_funcs_.size());
+            return loc_funcs_.loc_func_count();
         }
 
         /**
@@ -177,6 +438,22 @@ namespace kuku
             return loc_func_seed_;
         }
 
+        /**
+        Returns how the location functions are obtained from the seed.
+        */
+        [[nodiscard]] LocFuncMode loc_func_mode() const noexcept
+        {
+            return loc_funcs_.mode();
+        }
+
+        /**
+        Returns the family of the hash functions underlying the location functions.
+        */
+        [[nodiscard]] HashFamily hash_family() const noexcept
+        {
+            return loc_funcs_.hash_family();
+        }
+
         /**
         Returns the maximum number of random walk steps taken in attempting to insert an item.
         */
@@ -185,6 +462,24 @@ namespace kuku
             return max_probe_;
         }
 
+        /**
+        Returns the strategy used to insert items whose locations are all occupied.
+        */
+        [[nodiscard]] InsertStrategy insert_strategy() const noexcept
+        {
+            return insert_strategy_;
+        }
+
+        /**
+        Sets the strategy used to insert items whose locations are all occupied. Switching to InsertStrategy::bfs
+        allocates the search state, which holds up to max_probe * (loc_func_count - 1) + loc_func_count locations
+        (bounded by the table size).
+
+        @param[in] insert_strategy The insert strategy
+        @throws std::invalid_argument if insert_strategy is invalid
+        */
+        void set_insert_strategy(InsertStrategy insert_strategy);
+
         /**
         Returns the hash table item that represents an empty location in the table.
         */
@@ -234,12 +529,115 @@ namespace kuku
                    (static_cast<double>(table_size()) + static_cast<double>(stash_size_));
         }
 
+#ifdef KUKU_USE_STATS
+        /**
+        Returns the insertion statistics of the hash table. Computing the per-location-function occupancy requires a
+        pass over the table and is linear in its size.
+        */
+        [[nodiscard]] KukuTableStats stats() const;
+
+        /**
+        Resets the insertion statistics of the hash table to zero.
+        */
+        void reset_stats() noexcept
+        {
+            stats_ = KukuTableStats{};
+        }
+#endif
+
         KukuTable(const KukuTable &copy) = delete;
 
         KukuTable &operator=(const KukuTable &assign) = delete;
 
     private:
-        void generate_loc_funcs(std::uint32_t loc_func_count, item_type seed);
+        /*
+        Queries for a given item whose locations have already been computed.
+        */
+        QueryResult query_at(const item_type &item, const location_type *locations) const noexcept;
+
+        /*
+        Inserts a given item that is known not to be in the hash table and whose locations have already been
+        computed.
+        */
+        bool insert_new(item_type item, const location_type *locations);
+
+        /*
+        The random walk strategy of insert_new.
+        */
+        bool insert_random_walk(item_type item, const location_type *locations);
+
+        /*
+        The breadth-first search strategy of insert_new.
+        */
+        bool insert_bfs(item_type item, const location_type *locations);
+
+        /*
+        Tries to place an item for which no table location was found into the stash; otherwise it becomes the
+        leftover item.
+        */
+        bool insert_stash(item_type item);
+
+        /*
+        Removes the item found at result from the table or stash.
+        */
+        void erase_at(const QueryResult &result) noexcept;
+
+        /*
+        Moves every stash item that has an empty location in the table to that location.
+        */
+        void backfill_stash() noexcept;
+
+        /*
+        A location in the breadth-first search tree of insert_bfs, together with the index of its parent in
+        bfs_nodes_; the roots are the locations of the item being inserted.
+        */
+        struct BFSNode
+        {
+            location_type location;
+
+            std::uint32_t parent;
+        };
+
+        static constexpr std::uint32_t bfs_no_parent_ = ~std::uint32_t(0);
+
+        /*
+        The number of items ahead whose table locations insert_batch prefetches.
+        */
+        static constexpr std::size_t insert_batch_prefetch_distance_ = 8;
+
+        /*
+        The number of items whose table locations query_batch prefetches together.
+        */
+        static constexpr std::size_t query_batch_group_size_ = 16;
+
+        /*
+        Fills in the header of the saved format (see kuku/internal/serialization.h) for the hash table in its current
+        state.
+        */
+        SaveHeader save_header() const noexcept;
+
+        /*
+        Creates a hash table with the parameters of a header and the state that is not stored in the table or stash.
+        */
+        static std::unique_ptr<KukuTable> from_save_header(const SaveHeader &header);
+
+        /*
+        Creates a new empty hash table as the public constructor does, reusing the given storage for the table.
+        */
+        KukuTable(
+            table_size_type table_size, table_size_type stash_size, std::uint32_t loc_func_count,
+            item_type loc_func_seed, std::uint64_t max_probe, item_type empty_item, LocFuncMode loc_func_mode,
+            HashFamily hash_family, std::vector<item_type> &&table_storage);
+
+        /*
+        The number of items build_with_seeds inserts between checks for cancellation.
+        */
+        static constexpr std::size_t build_with_seeds_chunk_size_ = std::size_t(1) << 12;
+
+        /*
+        The minimum number of items per thread for build_parallel to start another thread.
+        */
+        static constexpr std::size_t build_parallel_min_items_per_thread_ = std::size_t(1) << 12;
 
         /*
         Swap an item in the table with a given item.
@@ -261,10 +659,15 @@ namespace kuku
         */
         std::vector<item_type> stash_;
 
+        /*
+        The index of the stash, used by queries instead of scanning a large stash.
+        */
+        detail::StashIndex<item_type> stash_index_;
+
         /*
         The hash functions.
         */
-        std::vector<LocFunc> loc_funcs_;
+        const LocFuncBank loc_funcs_;
 
         /*
         The size of the table.
@@ -308,18 +711,61 @@ namespace kuku
         std::mt19937_64 gen_;
 
         std::uniform_int_distribution<std::uint32_t> u_;
+
+        InsertStrategy insert_strategy_ = InsertStrategy::random_walk;
+
+        /*
+        The preallocated search state of insert_bfs.
+        */
+        std::vector<BFSNode> bfs_nodes_;
+
+        /*
+        The maximum number of items insert_bfs expands.
+        */
+        std::uint64_t bfs_max_expansions_ = 0;
+
+#ifdef KUKU_USE_STATS
+        /*
+        Records the outcome of an insert that took the given number of random walk steps.
+        */
+        void record_walk(std::uint64_t steps) noexcept
+        {
+            std::size_t bucket = 0;
+            for (; steps; steps >>= 1)
+            {
+                bucket++;
+            }
+            stats_.walk_histogram[bucket]++;
+        }
+
+        /*
+        The insertion counters; loc_func_occupancy is computed on demand by stats().
+        */
+        KukuTableStats stats_;
+#endif
     };
 
     /**
     The QueryResult class represents the result of a hash table query. It includes information about whether a queried
     item was found in the hash table, its location in the hash table or stash (if found), and the index of the location
-    function (hash function) that was used to insert it. QueryResult objects are returned by the KukuTable::query
-    function.
+    function (hash function) that was used to insert it. QueryResult objects are returned by the query functions of
+    KukuTable, SizedKukuTable, KukuMap, BucketKukuTable, ConcurrentKukuTable, and KukuTableView.
     */
     class QueryResult
     {
         friend class KukuTable;
 
+        friend class BucketKukuTable;
+
+        friend class ConcurrentKukuTable;
+
+        friend class KukuTableView;
+
+        friend class KukuMap;
+
+        template <std::size_t ItemBytes>
+        friend class SizedKukuTable;
+
     public:
         /**
         Creates a QueryResult object.
@@ -5,10 +5,90 @@
 
 #include "kuku/common.h"
 #include "kuku/internal/hash.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
+#include <variant>
+#include <vector>
 
 namespace kuku
 {
+    /**
+    Specifies how a LocFuncBank obtains its location functions.
+    */
+    enum class LocFuncMode : std::uint8_t
+    {
+        /**
+        Every location function uses its own independently seeded tabulation hash function. Memory and hashing work
+        grow linearly with the number of location functions.
+        */
+        independent = 0,
+
+        /**
+        All location functions are derived from two independently seeded tabulation hash functions h1 and h2 by
+        enhanced double hashing: location function i evaluates h1 + i * h2 + (i^3 - i) / 6 (modulo 2^32) and reduces
+        the result modulo the table size. Memory and hashing work are independent of the number of location functions.
+        */
+        derived = 1
+    };
+
+    /**
+    Specifies the family of hash functions underlying the location functions.
+    */
+    enum class HashFamily : std::uint8_t
+    {
+        /**
+        Tabulation hashing over the 16 bytes of the item, reduced modulo the table size. This is the strongest (3-wise
+        independent) and the slowest family, and the one used by earlier versions of Kuku.
+        */
+        tabulation = 0,
+
+        /**
+        Two AES encryption rounds with random round keys; uses the AES-NI instructions when compiling for a target that
+        has them. The hash is reduced to the table size with a multiply-high instead of a modulo.
+        */
+        aes = 1,
+
+        /**
+        Multiply-shift hashing over the four 32-bit words of the item; 2-independent and the fastest family. The hash
+        is reduced to the table size with a multiply-high instead of a modulo.
+        */
+        multiply_shift = 2
+    };
+
+    namespace detail
+    {
+        /*
+        Maps a 32-bit hash to [0, table_size) as floor(hash * table_size / 2^32).
+        */
+        inline location_type multiply_high(location_type hash, table_size_type table_size) noexcept
+        {
+            return static_cast<location_type>((static_cast<std::uint64_t>(hash) * table_size) >> 32);
+        }
+
+        /*
+        Maps a 32-bit hash to [0, table_size). Tabulation keeps the modulo for compatibility with tables built by
+        earlier versions; the other families use the multiply-high reduction, which needs no division.
+        */
+        inline location_type reduce(location_type hash, table_size_type table_size, HashFamily family) noexcept
+        {
+            if (family == HashFamily::tabulation)
+            {
+                return hash % table_size;
+            }
+            return multiply_high(hash, table_size);
+        }
+
+        inline void validate_hash_family(HashFamily family)
+        {
+            if (family != HashFamily::tabulation && family != HashFamily::aes && family != HashFamily::multiply_shift)
+            {
+                throw std::invalid_argument("hash_family is invalid");
+            }
+        }
+    } // namespace detail
+
     /**
     An instance of the LocFunc class represents a location function (hash function) used by the KukuTable class to
     insert an item in the hash table. The location functions are automatically created by the KukuTable class instance
@@ -23,15 +103,13 @@ namespace kuku
 
         @param[in] table_size The size of the hash table that this location function is for
         @param[in] seed The seed for randomness
+        @param[in] family The family of the underlying hash function
         @throws std::invalid_argument if the table_size is larger or smaller than allowed
+        @throws std::invalid_argument if family is invalid
         */
-        LocFunc(table_size_type table_size, item_type seed) : table_size_(table_size), hf_(seed)
-        {
-            if (table_size < min_table_size || table_size > max_table_size)
-            {
-                throw std::invalid_argument("table_size is out of range");
-            }
-        }
+        LocFunc(table_size_type table_size, item_type seed, HashFamily family = HashFamily::tabulation)
+            : table_size_(table_size), family_(family), hf_(make_hash_func(table_size, seed, family))
+        {}
 
         /**
         Creates a copy of a given location function.
@@ -51,12 +129,333 @@ namespace kuku
         */
         location_type operator()(item_type item) const noexcept
         {
-            return hf_(item) % table_size_;
+            switch (family_)
+            {
+            case HashFamily::aes:
+                return detail::reduce(std::get<AESHashFunc>(hf_)(item), table_size_, family_);
+            case HashFamily::multiply_shift:
+                return detail::reduce(std::get<MultiplyShiftHashFunc>(hf_)(item), table_size_, family_);
+            default:
+                return detail::reduce(std::get<HashFunc>(hf_)(item), table_size_, family_);
+            }
+        }
+
+        /**
+        Computes the locations for count consecutive items. The location of items[i] is written to out[i] and is
+        identical to the result of operator() on items[i], but the hashing is vectorized when possible.
+
+        @param[in] items Pointer to the hash table items for which to compute the locations
+        @param[in] count The number of items
+        @param[out] out Pointer to an array of count locations
+        */
+        void operator()(const item_type *items, std::size_t count, location_type *out) const noexcept
+        {
+            if (family_ != HashFamily::tabulation)
+            {
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    out[i] = operator()(items[i]);
+                }
+                return;
+            }
+
+            std::get<HashFunc>(hf_)(items, count, out);
+            for (std::size_t i = 0; i < count; i++)
+            {
+                out[i] %= table_size_;
+            }
+        }
+
+        /**
+        Returns the family of the underlying hash function.
+        */
+        [[nodiscard]] HashFamily hash_family() const noexcept
+        {
+            return family_;
         }
 
     private:
+        using hash_func_type = std::variant<HashFunc, AESHashFunc, MultiplyShiftHashFunc>;
+
+        static hash_func_type make_hash_func(table_size_type table_size, item_type seed, HashFamily family)
+        {
+            if (table_size < min_table_size || table_size > max_table_size)
+            {
+                throw std::invalid_argument("table_size is out of range");
+            }
+            detail::validate_hash_family(family);
+            switch (family)
+            {
+            case HashFamily::aes:
+                return AESHashFunc(seed);
+            case HashFamily::multiply_shift:
+                return MultiplyShiftHashFunc(seed);
+            default:
+                return HashFunc(seed);
+            }
+        }
+
         table_size_type table_size_;
 
-        HashFunc hf_;
+        HashFamily family_;
+
+        hash_func_type hf_;
+    };
+
+    /**
+    An instance of the LocFuncBank class represents a fixed number of location functions for a table of given size,
+    evaluated together. In LocFuncMode::independent the location function with index i is identical to
+    LocFunc(table_size, seed + i), but the underlying hash tables of all functions are stored interleaved, so computing
+    all locations of an item costs about as many cache lines as computing one. In LocFuncMode::derived the location
+    functions are computed from only two hash functions (see LocFuncMode). In either mode the hash functions belong to
+    the given HashFamily. The KukuTable class uses a LocFuncBank for its location functions.
+    */
+    class LocFuncBank
+    {
+    public:
+        /**
+        Creates a new bank of location functions for a table of given size.
+
+        @param[in] table_size The size of the hash table that the location functions are for
+        @param[in] loc_func_count The number of location functions
+        @param[in] seed The seed for randomness; the hash functions use seed, seed + 1, and so on
+        @param[in] mode Whether the location functions are independent or derived from two hash functions
+        @param[in] family The family of the underlying hash functions
+        @throws std::invalid_argument if loc_func_count is too large or too small
+        @throws std::invalid_argument if the table_size is larger or smaller than allowed
+        @throws std::invalid_argument if mode or family is invalid
+        */
+        LocFuncBank(
+            table_size_type table_size, std::uint32_t loc_func_count, item_type seed,
+            LocFuncMode mode = LocFuncMode::independent, HashFamily family = HashFamily::tabulation)
+            : table_size_(table_size), loc_func_count_(loc_func_count), mode_(mode), family_(family),
+              hfs_(make_hash_funcs(hash_func_count(table_size, loc_func_count, mode), seed, family))
+        {}
+
+        /**
+        Creates a copy of a given location function bank.
+
+        @param[in] copy The location function bank to copy from
+        */
+        LocFuncBank(const LocFuncBank &copy) = default;
+
+        LocFuncBank &operator=(const LocFuncBank &assign) = delete;
+
+        /**
+        Returns the number of location functions in the bank.
+        */
+        [[nodiscard]] std::uint32_t loc_func_count() const noexcept
+        {
+            return loc_func_count_;
+        }
+
+        /**
+        Returns how the location functions are obtained.
+        */
+        [[nodiscard]] LocFuncMode mode() const noexcept
+        {
+            return mode_;
+        }
+
+        /**
+        Returns the family of the underlying hash functions.
+        */
+        [[nodiscard]] HashFamily hash_family() const noexcept
+        {
+            return family_;
+        }
+
+        /**
+        Returns the location for a given item using the location function of the given index.
+
+        @param[in] item The hash table item for which to compute the location
+        @param[in] loc_func_index The index of the location function; must be less than loc_func_count()
+        */
+        location_type operator()(item_type item, std::uint32_t loc_func_index) const noexcept
+        {
+            if (mode_ == LocFuncMode::independent)
+            {
+                return detail::reduce(hash(item, loc_func_index), table_size_, family_);
+            }
+
+            std::array<location_type, 2> base{};
+            hash_all(item, base.data());
+            return detail::reduce(derive(base, loc_func_index), table_size_, family_);
+        }
+
+        /**
+        Computes the locations for a given item using all location functions.
+
+        @param[in] item The hash table item for which to compute the locations
+        @param[out] out Pointer to an array of loc_func_count() locations
+        */
+        void locations(const item_type &item, location_type *out) const noexcept
+        {
+            if (mode_ == LocFuncMode::independent)
+            {
+                switch (family_)
+                {
+                case HashFamily::aes:
+                    hash_all_reduced(std::get<std::vector<AESHashFunc>>(hfs_), item, out);
+                    return;
+                case HashFamily::multiply_shift:
+                    hash_all_reduced(std::get<std::vector<MultiplyShiftHashFunc>>(hfs_), item, out);
+                    return;
+                default:
+                    std::get<HashFuncBank>(hfs_)(item, out);
+                    for (std::uint32_t i = 0; i < loc_func_count_; i++)
+                    {
+                        out[i] %= table_size_;
+                    }
+                    return;
+                }
+            }
+
+            std::array<location_type, 2> base{};
+            hash_all(item, base.data());
+            for (std::uint32_t i = 0; i < loc_func_count_; i++)
+            {
+                out[i] = detail::reduce(derive(base, i), table_size_, family_);
+            }
+        }
+
+        /**
+        Computes the locations for count consecutive items using all location functions. The location of items[i]
+        for the location function of index j is written to out[i * loc_func_count() + j]. Every item is hashed with
+        all functions as by locations(item, out); unlike the batch operator of LocFunc, the hashing is not vectorized
+        across items, since gathering from the interleaved hash tables is slower than reading each table row once.
+
+        @param[in] items Pointer to the hash table items for which to compute the locations
+        @param[in] count The number of items
+        @param[out] out Pointer to an array of count * loc_func_count() locations
+        */
+        void locations(const item_type *items, std::size_t count, location_type *out) const noexcept
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                locations(items[i], out + i * loc_func_count_);
+            }
+        }
+
+    private:
+        using hash_funcs_type =
+            std::variant<HashFuncBank, std::vector<AESHashFunc>, std::vector<MultiplyShiftHashFunc>>;
+
+        static hash_funcs_type make_hash_funcs(std::uint32_t count, item_type seed, HashFamily family)
+        {
+            detail::validate_hash_family(family);
+            if (family == HashFamily::tabulation)
+            {
+                return HashFuncBank(count, seed);
+            }
+
+            // Seed the functions with seed, seed + 1, and so on, like HashFuncBank does
+            auto make = [&](auto funcs) {
+                funcs.reserve(count);
+                for (std::uint32_t i = 0; i < count; i++)
+                {
+                    funcs.emplace_back(seed);
+                    increment_item(seed);
+                }
+                return funcs;
+            };
+            if (family == HashFamily::aes)
+            {
+                return make(std::vector<AESHashFunc>{});
+            }
+            return make(std::vector<MultiplyShiftHashFunc>{});
+        }
+
+        location_type hash(const item_type &item, std::uint32_t index) const noexcept
+        {
+            switch (family_)
+            {
+            case HashFamily::aes:
+                return std::get<std::vector<AESHashFunc>>(hfs_)[index](item);
+            case HashFamily::multiply_shift:
+                return std::get<std::vector<MultiplyShiftHashFunc>>(hfs_)[index](item);
+            default:
+                return std::get<HashFuncBank>(hfs_)(item, index);
+            }
+        }
+
+        /*
+        Writes the hashes of all underlying hash functions to out.
+        */
+        void hash_all(const item_type &item, location_type *out) const noexcept
+        {
+            switch (family_)
+            {
+            case HashFamily::aes:
+                for (const auto &hf : std::get<std::vector<AESHashFunc>>(hfs_))
+                {
+                    *out++ = hf(item);
+                }
+                break;
+            case HashFamily::multiply_shift:
+                for (const auto &hf : std::get<std::vector<MultiplyShiftHashFunc>>(hfs_))
+                {
+                    *out++ = hf(item);
+                }
+                break;
+            default:
+                std::get<HashFuncBank>(hfs_)(item, out);
+                break;
+            }
+        }
+
+        /*
+        Writes the locations of all hash functions of a non-tabulation family to out, dispatching on the family only
+        once per item.
+        */
+        template <typename HashFuncs>
+        void hash_all_reduced(const HashFuncs &hfs, const item_type &item, location_type *out) const noexcept
+        {
+            for (const auto &hf : hfs)
+            {
+                *out++ = detail::multiply_high(hf(item), table_size_);
+            }
+        }
+
+        static std::uint32_t hash_func_count(
+            table_size_type table_size, std::uint32_t loc_func_count, LocFuncMode mode)
+        {
+            if (loc_func_count < min_loc_func_count || loc_func_count > max_loc_func_count)
+            {
+                throw std::invalid_argument("loc_func_count is out of range");
+            }
+            if (table_size < min_table_size || table_size > max_table_size)
+            {
+                throw std::invalid_argument("table_size is out of range");
+            }
+            switch (mode)
+            {
+            case LocFuncMode::independent:
+                return loc_func_count;
+            case LocFuncMode::derived:
+                return loc_func_count < 2 ? loc_func_count : 2;
+            default:
+                throw std::invalid_argument("mode is invalid");
+            }
+        }
+
+        /*
+        Enhanced double hashing; the cubic term keeps the derived functions distinct when h2 shares a factor with
+        the table size. A bank with a single location function has no h2, which is then zero.
+        */
+        static location_type derive(const std::array<location_type, 2> &base, std::uint32_t index) noexcept
+        {
+            return base[0] + index * base[1] + (index * index * index - index) / 6;
+        }
+
+        table_size_type table_size_;
+
+        std::uint32_t loc_func_count_;
+
+        LocFuncMode mode_;
+
+        HashFamily family_;
+
+        hash_funcs_type hfs_;
     };
 } // namespace kuku
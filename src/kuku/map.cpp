@@ -0,0 +1,147 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/map.h"
+#include "kuku/internal/walk.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+using namespace std;
+
+namespace kuku
+{
+    KukuMap::KukuMap(
+        table_size_type table_size, table_size_type stash_size, uint32_t loc_func_count, item_type loc_func_seed,
+        uint64_t max_probe, item_type empty_item, size_t payload_size, LocFuncMode loc_func_mode,
+        HashFamily hash_family)
+        : loc_funcs_(table_size, loc_func_count, loc_func_seed, loc_func_mode, hash_family), stash_index_(stash_size),
+          table_size_(table_size), stash_size_(stash_size), payload_size_(payload_size), loc_func_seed_(loc_func_seed),
+          max_probe_(max_probe), empty_item_(empty_item), leftover_item_(empty_item_), gen_(random_uint64())
+    {
+        // The location (hash) functions have already validated loc_func_count and table_size
+        if (!max_probe)
+        {
+            throw invalid_argument("max_probe cannot be zero");
+        }
+        if (!payload_size)
+        {
+            throw invalid_argument("payload_size cannot be zero");
+        }
+
+        // Allocate the hash table and the payloads
+        table_.resize(table_size_, empty_item_);
+        payloads_.resize(static_cast<size_t>(table_size_) * payload_size_);
+        leftover_payload_.resize(payload_size_);
+        walk_payload_.resize(payload_size_);
+
+        // Set up the distribution for location function sampling
+        u_ = uniform_int_distribution<uint32_t>(0, loc_func_count - 1);
+    }
+
+    QueryResult KukuMap::query(item_type item) const
+    {
+        if (is_empty_item(item))
+        {
+            throw invalid_argument("item cannot be the empty item");
+        }
+
+        array<location_type, max_loc_func_count> locations;
+        loc_funcs_.locations(item, locations.data());
+        return query_at(item, locations.data());
+    }
+
+    QueryResult KukuMap::query_at(const item_type &item, const location_type *locations) const noexcept
+    {
+        // Search the hash table
+        const uint32_t i = detail::find_at_locations(table_.data(), item, locations, loc_func_count());
+        if (i < loc_func_count())
+        {
+            return { locations[i], i };
+        }
+
+        // Search the stash
+        const size_t position = stash_index_.find(stash_.data(), stash_.size(), item);
+        if (position < stash_.size())
+        {
+            return { static_cast<location_type>(position), ~static_cast<uint32_t>(0) };
+        }
+
+        // Not found
+        return { 0, max_loc_func_count };
+    }
+
+    void KukuMap::clear_table() noexcept
+    {
+        fill(table_.begin(), table_.end(), empty_item_);
+        fill(payloads_.begin(), payloads_.end(), static_cast<unsigned char>(0));
+        stash_.clear();
+        stash_payloads_.clear();
+        stash_index_.clear();
+        leftover_item_ = empty_item_;
+        fill(leftover_payload_.begin(), leftover_payload_.end(), static_cast<unsigned char>(0));
+        inserted_items_ = 0;
+    }
+
+    bool KukuMap::insert(item_type item, const unsigned char *payload)
+    {
+        if (is_empty_item(item))
+        {
+            throw invalid_argument("item cannot be the empty item");
+        }
+        if (nullptr == payload)
+        {
+            throw invalid_argument("payload cannot be null");
+        }
+
+        // Check if the item is already inserted
+        array<location_type, max_loc_func_count> locations;
+        loc_funcs_.locations(item, locations.data());
+        if (query_at(item, locations.data()))
+        {
+            return false;
+        }
+
+        // The payload travels with the item in walk_payload_
+        memcpy(walk_payload_.data(), payload, payload_size_);
+        const uint32_t lfc = loc_func_count();
+        const uint64_t steps = detail::random_walk(
+            item, locations.data(), max_probe_,
+            [&](const item_type &walk_item, const location_type *walk_locations) {
+                const uint32_t i = detail::find_at_locations(table_.data(), empty_item_, walk_locations, lfc);
+                if (i < lfc)
+                {
+                    table_[walk_locations[i]] = walk_item;
+                    memcpy(table_payload(walk_locations[i]), walk_payload_.data(), payload_size_);
+                    return true;
+                }
+                return false;
+            },
+            [&](item_type &walk_item, const location_type *walk_locations) {
+                // Swap in the current item along with its payload
+                const location_type loc = walk_locations[u_(gen_)];
+                swap(walk_item, table_[loc]);
+                swap_ranges(walk_payload_.begin(), walk_payload_.end(), table_payload(loc));
+            },
+            [&](const item_type &walk_item, location_type *out) { loc_funcs_.locations(walk_item, out); });
+        if (steps < max_probe_)
+        {
+            inserted_items_++;
+            return true;
+        }
+
+        // The walk ran out of steps; try stash
+        if (stash_.size() < stash_size_)
+        {
+            stash_.push_back(item);
+            stash_index_.add(stash_.data(), stash_.size() - 1);
+            stash_payloads_.insert(stash_payloads_.end(), walk_payload_.begin(), walk_payload_.end());
+            inserted_items_++;
+            return true;
+        }
+
+        leftover_item_ = item;
+        leftover_payload_ = walk_payload_;
+        return false;
+    }
+} // namespace kuku
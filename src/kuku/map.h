@@ -0,0 +1,386 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "kuku/common.h"
+#include "kuku/kuku.h"
+#include "kuku/locfunc.h"
+#include "kuku/internal/lookup.h"
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace kuku
+{
+    /**
+    The KukuMap class represents a cuckoo hash table that associates a payload of fixed size with every item, such as
+    a label or an offset into a record file. The payloads are stored in a separate array parallel to the table (and
+    one parallel to the stash), and every move of an item during insertion moves its payload along with it, so a
+    query finds the payload of an item at the location where it finds the item. Items are placed with the same
+    location functions as in a KukuTable with the same parameters, using random walk cuckoo hashing.
+
+    Keeping the payloads out of the table keeps the table as dense as that of a KukuTable: a query compares only
+    items and reads the payload of a hit only.
+    */
+    class KukuMap
+    {
+    public:
+        /**
+        Creates a new empty hash table with payloads.
+
+        @param[in] table_size The size of the hash table
+        @param[in] stash_size The size of the stash (possibly zero)
+        @param[in] loc_func_count The number of location functions (hash functions) to use
+        @param[in] loc_func_seed The 128-bit seed for the location functions, represented as a hash table item
+        @param[in] max_probe The maximum number of random walk steps taken in attempting to insert an item
+        @param[in] empty_item A hash table item that represents an empty location in the table
+        @param[in] payload_size The size of the payload of every item in bytes
+        @param[in] loc_func_mode Whether the location functions use independent hash functions or are derived from
+        two hash functions
+        @param[in] hash_family The family of the hash functions underlying the location functions
+        @throws std::invalid_argument if loc_func_count is too large or too small
+        @throws std::invalid_argument if table_size is too large or too small
+        @throws std::invalid_argument if max_probe or payload_size is zero
+        @throws std::invalid_argument if loc_func_mode or hash_family is invalid
+        */
+        KukuMap(
+            table_size_type table_size, table_size_type stash_size, std::uint32_t loc_func_count,
+            item_type loc_func_seed, std::uint64_t max_probe, item_type empty_item, std::size_t payload_size,
+            LocFuncMode loc_func_mode = LocFuncMode::independent, HashFamily hash_family = HashFamily::tabulation);
+
+        /**
+        Adds a single item with its payload to the hash table. The return value indicates whether the item was
+        successfully inserted (possibly into the stash) or not. If the item is already in the table, it is not
+        inserted again and its payload is left unchanged. If the insertion fails, the leftover item and its payload
+        can be read with leftover_item() and leftover_payload().
+
+        @param[in] item The hash table item to insert
+        @param[in] payload Pointer to the payload_size() bytes of the payload of the item
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        @throws std::invalid_argument if payload is null
+        */
+        [[nodiscard]] bool insert(item_type item, const unsigned char *payload);
+
+        /**
+        Queries for the presence of a given item in the hash table and stash. The payload of a found item can be
+        accessed with payload(result).
+
+        @param[in] item The hash table item to query
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] QueryResult query(item_type item) const;
+
+        /**
+        Queries for a given item and returns a pointer to its payload_size() bytes of payload, or nullptr if the item
+        is not in the hash table or stash.
+
+        @param[in] item The hash table item to query
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] const unsigned char *find(item_type item) const
+        {
+            const QueryResult result = query(item);
+            return result ? payload_at(result) : nullptr;
+        }
+
+        /**
+        Queries for a given item and returns a pointer to its payload_size() bytes of payload, which may be modified,
+        or nullptr if the item is not in the hash table or stash.
+
+        @param[in] item The hash table item to query
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] unsigned char *find(item_type item)
+        {
+            return const_cast<unsigned char *>(static_cast<const KukuMap *>(this)->find(item));
+        }
+
+        /**
+        Returns a pointer to the payload_size() bytes of payload of an item found by query. The pointer is valid until
+        the next insertion or clear_table().
+
+        @param[in] result The result of a query that found an item
+        @throws std::invalid_argument if result does not represent a found item
+        @throws std::out_of_range if the location of result is out of range
+        */
+        [[nodiscard]] const unsigned char *payload(const QueryResult &result) const
+        {
+            if (!result)
+            {
+                throw std::invalid_argument("result does not represent a found item");
+            }
+            if (result.location() >= (result.in_stash() ? stash_.size() : table_size_))
+            {
+                throw std::out_of_range("location is out of range");
+            }
+            return payload_at(result);
+        }
+
+        /**
+        Returns a pointer to the payload_size() bytes of payload, which may be modified, of an item found by query.
+        The pointer is valid until the next insertion or clear_table().
+
+        @param[in] result The result of a query that found an item
+        @throws std::invalid_argument if result does not represent a found item
+        @throws std::out_of_range if the location of result is out of range
+        */
+        [[nodiscard]] unsigned char *payload(const QueryResult &result)
+        {
+            return const_cast<unsigned char *>(static_cast<const KukuMap *>(this)->payload(result));
+        }
+
+        /**
+        Returns a location that a given hash table item may be placed at.
+
+        @param[in] item The hash table item for which the location is to be obtained
+        @param[in] loc_func_index The index of the location function which to use to compute the location
+        @throws std::out_of_range if loc_func_index is out of range
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] location_type location(item_type item, std::uint32_t loc_func_index) const
+        {
+            if (loc_func_index >= loc_func_count())
+            {
+                throw std::out_of_range("loc_func_index is out of range");
+            }
+            if (is_empty_item(item))
+            {
+                throw std::invalid_argument("item cannot be the empty item");
+            }
+            return loc_funcs_(item, loc_func_index);
+        }
+
+        /**
+        Clears the hash table by filling every location with the empty item. The payloads are zeroed.
+        */
+        void clear_table() noexcept;
+
+        /**
+        Returns the number of location functions used by the hash table.
+        */
+        [[nodiscard]] std::uint32_t loc_func_count() const noexcept
+        {
+            return loc_funcs_.loc_func_count();
+        }
+
+        /**
+        Returns a reference to a specific location in the hash table.
+
+        @param[in] index The index in the hash table
+        @throws std::out_of_range if index is out of range
+        */
+        [[nodiscard]] const item_type &table(location_type index) const
+        {
+            if (index >= table_size_)
+            {
+                throw std::out_of_range("index is out of range");
+            }
+            return table_[index];
+        }
+
+        /**
+        Returns a reference to the stash.
+        */
+        [[nodiscard]] const std::vector<item_type> &stash() const noexcept
+        {
+            return stash_;
+        }
+
+        /**
+        Returns the size of the hash table.
+        */
+        [[nodiscard]] table_size_type table_size() const noexcept
+        {
+            return table_size_;
+        }
+
+        /**
+        Returns the size of the stash.
+        */
+        [[nodiscard]] table_size_type stash_size() const noexcept
+        {
+            return stash_size_;
+        }
+
+        /**
+        Returns the size of the payload of every item in bytes.
+        */
+        [[nodiscard]] std::size_t payload_size() const noexcept
+        {
+            return payload_size_;
+        }
+
+        /**
+        Returns the 128-bit seed used for the location functions, represented as a hash table item.
+        */
+        [[nodiscard]] item_type loc_func_seed() const noexcept
+        {
+            return loc_func_seed_;
+        }
+
+        /**
+        Returns the maximum number of random walk steps taken in attempting to insert an item.
+        */
+        [[nodiscard]] std::uint64_t max_probe() const noexcept
+        {
+            return max_probe_;
+        }
+
+        /**
+        Returns the hash table item that represents an empty location in the table.
+        */
+        [[nodiscard]] const item_type &empty_item() const noexcept
+        {
+            return empty_item_;
+        }
+
+        /**
+        Returns whether a given item is the empty item for this hash table.
+
+        @param[in] item The item to compare to the empty item
+        */
+        [[nodiscard]] bool is_empty_item(const item_type &item) const noexcept
+        {
+            return are_equal_item(item, empty_item_);
+        }
+
+        /**
+        When the insert function fails to insert a hash table item, there is a leftover item that could not be inserted
+        into the table. This function will return the empty item if insertion never failed, and otherwise it will return
+        the latest leftover item.
+        */
+        [[nodiscard]] item_type leftover_item() const noexcept
+        {
+            return leftover_item_;
+        }
+
+        /**
+        Returns the payload of the leftover item (see leftover_item()); all zeros if insertion never failed.
+        */
+        [[nodiscard]] const std::vector<unsigned char> &leftover_payload() const noexcept
+        {
+            return leftover_payload_;
+        }
+
+        /**
+        Returns the current fill rate of the hash table and stash.
+        */
+        [[nodiscard]] double fill_rate() const noexcept
+        {
+            return static_cast<double>(inserted_items_) /
+                   (static_cast<double>(table_size_) + static_cast<double>(stash_size_));
+        }
+
+        KukuMap(const KukuMap &copy) = delete;
+
+        KukuMap &operator=(const KukuMap &assign) = delete;
+
+    private:
+        /*
+        Searches the given locations of item and the stash.
+        */
+        QueryResult query_at(const item_type &item, const location_type *locations) const noexcept;
+
+        /*
+        Returns the payload of a found item without checking the result.
+        */
+        const unsigned char *payload_at(const QueryResult &result) const noexcept
+        {
+            const auto &payloads = result.in_stash() ? stash_payloads_ : payloads_;
+            return payloads.data() + static_cast<std::size_t>(result.location()) * payload_size_;
+        }
+
+        unsigned char *table_payload(location_type location) noexcept
+        {
+            return payloads_.data() + static_cast<std::size_t>(location) * payload_size_;
+        }
+
+        /*
+        The location functions.
+        */
+        const LocFuncBank loc_funcs_;
+
+        /*
+        The hash table that holds all of the input data.
+        */
+        std::vector<item_type> table_;
+
+        /*
+        The payloads of the items in the table, payload_size_ bytes per location.
+        */
+        std::vector<unsigned char> payloads_;
+
+        /*
+        The stash.
+        */
+        std::vector<item_type> stash_;
+
+        /*
+        The payloads of the items in the stash, payload_size_ bytes per item.
+        */
+        std::vector<unsigned char> stash_payloads_;
+
+        /*
+        The index of the stash, used by queries instead of scanning a large stash.
+        */
+        detail::StashIndex<item_type> stash_index_;
+
+        /*
+        The size of the table.
+        */
+        const table_size_type table_size_;
+
+        /*
+        The size of the stash.
+        */
+        const table_size_type stash_size_;
+
+        /*
+        The size of a payload in bytes.
+        */
+        const std::size_t payload_size_;
+
+        /*
+        Seed for the hash functions
+        */
+        const item_type loc_func_seed_;
+
+        /*
+        The maximum number of attempts that are made to insert an item.
+        */
+        const std::uint64_t max_probe_;
+
+        /*
+        An item value that denotes an empty item.
+        */
+        const item_type empty_item_;
+
+        /*
+        Storage for an item that was evicted and could not be re-inserted, and its payload. This is populated when
+        insert fails.
+        */
+        item_type leftover_item_;
+
+        std::vector<unsigned char> leftover_payload_;
+
+        /*
+        The payload of the item being moved by a random walk.
+        */
+        std::vector<unsigned char> walk_payload_;
+
+        /*
+        The number of items that have been inserted to table or stash.
+        */
+        table_size_type inserted_items_ = 0;
+
+        /*
+        Randomness source for location function sampling.
+        */
+        std::mt19937_64 gen_;
+
+        std::uniform_int_distribution<std::uint32_t> u_;
+    };
+} // namespace kuku
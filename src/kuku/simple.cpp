@@ -0,0 +1,151 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/simple.h"
+#include "kuku/internal/threads.h"
+#include <algorithm>
+#include <thread>
+
+using namespace std;
+
+namespace kuku
+{
+    SimpleHashTable::SimpleHashTable(
+        table_size_type table_size, uint32_t loc_func_count, item_type loc_func_seed, LocFuncMode loc_func_mode,
+        HashFamily hash_family)
+        : loc_funcs_(table_size, loc_func_count, loc_func_seed, loc_func_mode, hash_family), table_size_(table_size),
+          loc_func_seed_(loc_func_seed)
+    {
+        // The location (hash) functions have already validated loc_func_count and table_size
+        bin_offsets_.resize(static_cast<size_t>(table_size_) + 1, 0);
+    }
+
+    void SimpleHashTable::clear() noexcept
+    {
+        items_.clear();
+        fill(bin_offsets_.begin(), bin_offsets_.end(), size_t(0));
+        max_bin_load_ = 0;
+        item_count_ = 0;
+    }
+
+    void SimpleHashTable::build(const item_type *items, size_t count, size_t thread_count)
+    {
+        if (count && nullptr == items)
+        {
+            throw invalid_argument("items cannot be null");
+        }
+
+        if (!thread_count)
+        {
+            thread_count = max<size_t>(thread::hardware_concurrency(), 1);
+        }
+        thread_count = max<size_t>(min(thread_count, count / build_min_items_per_thread_), 1);
+
+        // Every thread owns a contiguous share of the items and keeps its own count for every bin, so that the items
+        // are read and their locations computed only once in total
+        const size_t bin_count = static_cast<size_t>(table_size_);
+        auto item_begin = [&](size_t t) { return count * t / thread_count; };
+        auto bin_begin = [&](size_t t) { return bin_count * t / thread_count; };
+
+        // Pass 1: compute the locations of the items of every thread and count them in the bins of the thread; a
+        // location that repeats an earlier location of the same item is replaced by no_location
+        constexpr location_type no_location = ~location_type(0);
+        const uint32_t lfc = loc_func_count();
+        vector<location_type> locations(count * lfc);
+        vector<size_t> thread_bins(thread_count * bin_count, 0);
+        run_threads(thread_count, [&](size_t t) {
+            size_t *bins = thread_bins.data() + t * bin_count;
+            const size_t end = item_begin(t + 1);
+            for (size_t begin = item_begin(t); begin < end; begin += build_batch_size_)
+            {
+                const size_t batch_count = min(build_batch_size_, end - begin);
+                location_type *batch_locations = locations.data() + begin * lfc;
+                loc_funcs_.locations(items + begin, batch_count, batch_locations);
+                for (size_t i = 0; i < batch_count; i++)
+                {
+                    location_type *item_locations = batch_locations + i * lfc;
+                    for (uint32_t j = 1; j < lfc; j++)
+                    {
+                        if (find(item_locations, item_locations + j, item_locations[j]) != item_locations + j)
+                        {
+                            item_locations[j] = no_location;
+                        }
+                    }
+                }
+                for (size_t i = 0; i < batch_count * lfc; i++)
+                {
+                    if (batch_locations[i] != no_location)
+                    {
+                        bins[batch_locations[i]]++;
+                    }
+                }
+            }
+        });
+
+        // Pass 2: split by bin ranges, sum the counts of every bin over the threads, turning every count into the
+        // offset of the items of its thread within the bin, and the bin sizes into offsets within the bin range
+        vector<size_t> range_sizes(thread_count, 0);
+        vector<size_t> max_bin_loads(thread_count, 0);
+        run_threads(thread_count, [&](size_t t) {
+            size_t sum = 0;
+            const size_t end = bin_begin(t + 1);
+            for (size_t loc = bin_begin(t); loc < end; loc++)
+            {
+                bin_offsets_[loc] = sum;
+                size_t bin_sum = 0;
+                for (size_t u = 0; u < thread_count; u++)
+                {
+                    const size_t bin_size = thread_bins[u * bin_count + loc];
+                    thread_bins[u * bin_count + loc] = bin_sum;
+                    bin_sum += bin_size;
+                }
+                max_bin_loads[t] = max(max_bin_loads[t], bin_sum);
+                sum += bin_sum;
+            }
+            range_sizes[t] = sum;
+        });
+
+        vector<size_t> range_starts(thread_count, 0);
+        for (size_t t = 1; t < thread_count; t++)
+        {
+            range_starts[t] = range_starts[t - 1] + range_sizes[t - 1];
+        }
+        const size_t total = range_starts.back() + range_sizes.back();
+        items_.resize(total);
+        bin_offsets_[table_size_] = total;
+
+        // Pass 3: move every bin range to its start, and every offset of a thread to the start of its bin
+        run_threads(thread_count, [&](size_t t) {
+            const size_t end = bin_begin(t + 1);
+            for (size_t loc = bin_begin(t); loc < end; loc++)
+            {
+                bin_offsets_[loc] += range_starts[t];
+                for (size_t u = 0; u < thread_count; u++)
+                {
+                    thread_bins[u * bin_count + loc] += bin_offsets_[loc];
+                }
+            }
+        });
+
+        // Pass 4: every thread places its items in order after those of the threads before it, so that every bin
+        // holds its items in their original order whatever the number of threads
+        run_threads(thread_count, [&](size_t t) {
+            size_t *bins = thread_bins.data() + t * bin_count;
+            const size_t end = item_begin(t + 1);
+            for (size_t i = item_begin(t); i < end; i++)
+            {
+                const location_type *item_locations = locations.data() + i * lfc;
+                for (uint32_t j = 0; j < lfc; j++)
+                {
+                    if (item_locations[j] != no_location)
+                    {
+                        items_[bins[item_locations[j]]++] = items[i];
+                    }
+                }
+            }
+        });
+
+        max_bin_load_ = *max_element(max_bin_loads.begin(), max_bin_loads.end());
+        item_count_ = count;
+    }
+} // namespace kuku
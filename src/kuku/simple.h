@@ -0,0 +1,220 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "kuku/common.h"
+#include "kuku/kuku.h"
+#include "kuku/locfunc.h"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace kuku
+{
+    /**
+    The SimpleHashTable class represents a hash table in which every item is placed into all of its bins: the
+    distinct locations given by its location functions, as returned by KukuTable::all_locations. It is the
+    counterpart of a KukuTable in protocols such as private set intersection, where one party places its items with
+    cuckoo hashing and the other places every item into all bins that the first party may have chosen; it can be
+    created with the location functions of a given KukuTable.
+
+    The bins are stored flat: the items of bin i are items()[bin_offsets()[i]] up to items()[bin_offsets()[i + 1]],
+    in the order in which they were given to build. The bins are laid out by first counting the items of every bin and
+    then placing them, so that no bin is ever reallocated.
+    */
+    class SimpleHashTable
+    {
+    public:
+        /**
+        Creates a new empty simple hash table.
+
+        @param[in] table_size The number of bins
+        @param[in] loc_func_count The number of location functions (hash functions) to use
+        @param[in] loc_func_seed The 128-bit seed for the location functions, represented as a hash table item
+        @param[in] loc_func_mode Whether the location functions use independent hash functions or are derived from
+        two hash functions
+        @param[in] hash_family The family of the hash functions underlying the location functions
+        @throws std::invalid_argument if loc_func_count is too large or too small
+        @throws std::invalid_argument if table_size is too large or too small
+        @throws std::invalid_argument if loc_func_mode or hash_family is invalid
+        */
+        SimpleHashTable(
+            table_size_type table_size, std::uint32_t loc_func_count, item_type loc_func_seed,
+            LocFuncMode loc_func_mode = LocFuncMode::independent, HashFamily hash_family = HashFamily::tabulation);
+
+        /**
+        Creates a new empty simple hash table with the same size and location functions as a given KukuTable.
+
+        @param[in] table The KukuTable whose location functions to use
+        */
+        explicit SimpleHashTable(const KukuTable &table)
+            : SimpleHashTable(
+                  table.table_size(), table.loc_func_count(), table.loc_func_seed(), table.loc_func_mode(),
+                  table.hash_family())
+        {}
+
+        /**
+        Replaces the contents of the hash table with the given items, each placed into all of its bins. The locations
+        of the items are computed in batches. Every thread computes the locations of a share of the items and counts
+        them in bins of its own, which takes thread_count * table_size() counters; the counts are summed by ranges of
+        bins, and every thread then places its items after those of the threads before it, so that the result does
+        not depend on the number of threads. Repeated items are placed repeatedly.
+
+        @param[in] items Pointer to the items to place
+        @param[in] count The number of items to place
+        @param[in] thread_count The number of threads to use; zero uses one thread per hardware thread
+        @throws std::invalid_argument if items is null and count is non-zero
+        */
+        void build(const item_type *items, std::size_t count, std::size_t thread_count = 0);
+
+        /**
+        Removes all items from the hash table.
+        */
+        void clear() noexcept;
+
+        /**
+        Returns the number of items in a given bin.
+
+        @param[in] index The index of the bin
+        @throws std::out_of_range if index is out of range
+        */
+        [[nodiscard]] std::size_t bin_size(location_type index) const
+        {
+            if (index >= table_size_)
+            {
+                throw std::out_of_range("index is out of range");
+            }
+            return bin_offsets_[index + 1] - bin_offsets_[index];
+        }
+
+        /**
+        Returns a pointer to the bin_size(index) items of a given bin.
+
+        @param[in] index The index of the bin
+        @throws std::out_of_range if index is out of range
+        */
+        [[nodiscard]] const item_type *bin(location_type index) const
+        {
+            if (index >= table_size_)
+            {
+                throw std::out_of_range("index is out of range");
+            }
+            return items_.data() + bin_offsets_[index];
+        }
+
+        /**
+        Returns the items of all bins, one bin after another.
+        */
+        [[nodiscard]] const std::vector<item_type> &items() const noexcept
+        {
+            return items_;
+        }
+
+        /**
+        Returns the table_size() + 1 offsets into items() at which the bins begin; the last offset is the total number
+        of items in all bins.
+        */
+        [[nodiscard]] const std::vector<std::size_t> &bin_offsets() const noexcept
+        {
+            return bin_offsets_;
+        }
+
+        /**
+        Returns the largest number of items in any bin.
+        */
+        [[nodiscard]] std::size_t max_bin_load() const noexcept
+        {
+            return max_bin_load_;
+        }
+
+        /**
+        Returns the number of items given to the latest build.
+        */
+        [[nodiscard]] std::size_t item_count() const noexcept
+        {
+            return item_count_;
+        }
+
+        /**
+        Returns the number of bins.
+        */
+        [[nodiscard]] table_size_type table_size() const noexcept
+        {
+            return table_size_;
+        }
+
+        /**
+        Returns the number of location functions used by the hash table.
+        */
+        [[nodiscard]] std::uint32_t loc_func_count() const noexcept
+        {
+            return loc_funcs_.loc_func_count();
+        }
+
+        /**
+        Returns the 128-bit seed used for the location functions, represented as a hash table item.
+        */
+        [[nodiscard]] item_type loc_func_seed() const noexcept
+        {
+            return loc_func_seed_;
+        }
+
+        /**
+        Returns how the location functions are obtained from the underlying hash functions.
+        */
+        [[nodiscard]] LocFuncMode loc_func_mode() const noexcept
+        {
+            return loc_funcs_.mode();
+        }
+
+        /**
+        Returns the family of the hash functions underlying the location functions.
+        */
+        [[nodiscard]] HashFamily hash_family() const noexcept
+        {
+            return loc_funcs_.hash_family();
+        }
+
+    private:
+        /*
+        The minimum number of items per thread for build to start another thread.
+        */
+        static constexpr std::size_t build_min_items_per_thread_ = std::size_t(1) << 12;
+
+        /*
+        The number of items whose locations build computes at once.
+        */
+        static constexpr std::size_t build_batch_size_ = 64;
+
+        /*
+        The location functions.
+        */
+        const LocFuncBank loc_funcs_;
+
+        /*
+        The number of bins.
+        */
+        const table_size_type table_size_;
+
+        /*
+        Seed for the hash functions
+        */
+        const item_type loc_func_seed_;
+
+        /*
+        The items of all bins, one bin after another.
+        */
+        std::vector<item_type> items_;
+
+        /*
+        The offsets into items_ at which the bins begin, followed by the size of items_.
+        */
+        std::vector<std::size_t> bin_offsets_;
+
+        std::size_t max_bin_load_ = 0;
+
+        std::size_t item_count_ = 0;
+    };
+} // namespace kuku
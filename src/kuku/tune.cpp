@@ -0,0 +1,327 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/tune.h"
+#include "kuku/internal/threads.h"
+#include "kuku/kuku.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+namespace kuku
+{
+    namespace
+    {
+        /*
+        The number of items a simulated build inserts between checks for failure.
+        */
+        constexpr size_t trial_chunk_size = size_t(1) << 12;
+
+        /*
+        The number of tables filled to estimate the range in which to search for the smallest table size.
+        */
+        constexpr size_t estimate_trial_count = 4;
+
+        /*
+        The parameters of the tables of a simulated build, except for the location function seed.
+        */
+        struct TrialParameters
+        {
+            table_size_type table_size;
+
+            table_size_type stash_size;
+
+            uint32_t loc_func_count;
+
+            uint64_t max_probe;
+        };
+
+        /*
+        Builds tables with the given parameters and random location function seeds holding the given items, up to
+        trial_count times on thread_count threads, and stops as soon as more than allowed_failures builds have failed.
+        Returns the number of builds completed and the number of those that failed.
+        */
+        pair<size_t, size_t> simulate(
+            const vector<item_type> &items, const TrialParameters &params, size_t trial_count, size_t allowed_failures,
+            size_t thread_count)
+        {
+            atomic<size_t> next_trial(0);
+            atomic<size_t> completed(0);
+            atomic<size_t> failures(0);
+            exception_ptr error;
+            mutex error_mutex;
+
+            run_threads(min(thread_count, trial_count), [&](size_t) {
+                try
+                {
+                    unique_ptr<bool[]> results(new bool[min(items.size(), trial_chunk_size)]);
+                    while (next_trial++ < trial_count && failures.load() <= allowed_failures)
+                    {
+                        KukuTable table(
+                            params.table_size, params.stash_size, params.loc_func_count, make_random_item(),
+                            params.max_probe, make_zero_item());
+                        bool failed = false;
+                        for (size_t begin = 0; begin < items.size() && !failed; begin += trial_chunk_size)
+                        {
+                            const size_t chunk_size = min(items.size() - begin, trial_chunk_size);
+                            failed = !table.insert_batch(items.data() + begin, chunk_size, results.get()).empty();
+                        }
+                        if (failed)
+                        {
+                            failures++;
+                        }
+                        completed++;
+                    }
+                }
+                catch (...)
+                {
+                    lock_guard<mutex> lock(error_mutex);
+                    if (!error)
+                    {
+                        error = current_exception();
+                    }
+                    next_trial = trial_count;
+                }
+            });
+
+            if (error)
+            {
+                rethrow_exception(error);
+            }
+            return { completed.load(), failures.load() };
+        }
+
+        /*
+        Estimates the range of table sizes in which the smallest one that holds the given items lies: fills
+        estimate_trial_count tables of the smallest possible size until the first failed insert, and scales the size by
+        the ratio of the item count to the number of items held. Returns the smallest and largest estimates.
+        */
+        pair<double, double> estimate_table_size(const vector<item_type> &items, const TrialParameters &params)
+        {
+            double low = numeric_limits<double>::max();
+            double high = 0.0;
+            for (size_t trial = 0; trial < estimate_trial_count; trial++)
+            {
+                KukuTable table(
+                    params.table_size, params.stash_size, params.loc_func_count, make_random_item(), params.max_probe,
+                    make_zero_item());
+                size_t inserted = 0;
+                while (inserted < items.size() && table.insert(items[inserted]))
+                {
+                    inserted++;
+                }
+                const double estimate = static_cast<double>(params.table_size) * static_cast<double>(items.size()) /
+                                        static_cast<double>(max<size_t>(inserted, 1));
+                low = min(low, estimate);
+                high = max(high, estimate);
+            }
+            return { low, high };
+        }
+
+        /*
+        Measures the throughput of inserting the given items one by one into a table with the given parameters.
+        */
+        double measure_inserts_per_second(const vector<item_type> &items, const TrialParameters &params)
+        {
+            KukuTable table(
+                params.table_size, params.stash_size, params.loc_func_count, make_random_item(), params.max_probe,
+                make_zero_item());
+            size_t inserted = 0;
+            const auto start = chrono::steady_clock::now();
+            while (inserted < items.size() && table.insert(items[inserted]))
+            {
+                inserted++;
+            }
+            const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            return static_cast<double>(inserted) / max(elapsed.count(), 1e-9);
+        }
+    } // namespace
+
+    vector<TuneResult> tune_parameters(const TuneOptions &options)
+    {
+        if (!options.item_count)
+        {
+            throw invalid_argument("item_count cannot be zero");
+        }
+        if (!(options.failure_probability > 0.0 && options.failure_probability < 1.0))
+        {
+            throw invalid_argument("failure_probability is out of range");
+        }
+        if (options.loc_func_counts.empty() || options.stash_sizes.empty() || options.max_probes.empty())
+        {
+            throw invalid_argument("candidate parameters cannot be empty");
+        }
+        if (any_of(options.loc_func_counts.begin(), options.loc_func_counts.end(), [](uint32_t loc_func_count) {
+                return loc_func_count < min_loc_func_count || loc_func_count > max_loc_func_count;
+            }))
+        {
+            throw invalid_argument("loc_func_count is out of range");
+        }
+        if (any_of(options.max_probes.begin(), options.max_probes.end(), [](uint64_t max_probe) { return !max_probe; }))
+        {
+            throw invalid_argument("max_probe cannot be zero");
+        }
+        if (!options.trial_count)
+        {
+            throw invalid_argument("trial_count cannot be zero");
+        }
+        if (!(options.size_precision >= 0.0) || !(options.memory_slack >= 0.0))
+        {
+            throw invalid_argument("size_precision and memory_slack cannot be negative");
+        }
+
+        size_t thread_count = options.thread_count;
+        if (!thread_count)
+        {
+            thread_count = max<size_t>(thread::hardware_concurrency(), 1);
+        }
+        const auto allowed_failures =
+            static_cast<size_t>(floor(options.failure_probability * static_cast<double>(options.trial_count)));
+        const auto size_step = max<uint64_t>(
+            static_cast<uint64_t>(options.size_precision * static_cast<double>(options.item_count)), 1);
+
+        // Every simulated build inserts the same items; the random location function seeds make the builds
+        // independent
+        vector<item_type> items(options.item_count);
+        mt19937_64 gen(random_uint64());
+        for (auto &item : items)
+        {
+            do
+            {
+                set_item(gen(), gen(), item);
+            } while (are_equal_item(item, make_zero_item()));
+        }
+
+        vector<TuneResult> results;
+        for (uint32_t loc_func_count : options.loc_func_counts)
+        {
+            for (table_size_type stash_size : options.stash_sizes)
+            {
+                for (uint64_t max_probe : options.max_probes)
+                {
+                    TuneResult result;
+                    result.stash_size = stash_size;
+                    result.loc_func_count = loc_func_count;
+                    result.max_probe = max_probe;
+
+                    // Returns whether builds with a table of the given size meet the failure probability, and if
+                    // so records their outcome
+                    auto passes = [&](uint64_t table_size) {
+                        const TrialParameters params{ static_cast<table_size_type>(table_size), stash_size,
+                                                      loc_func_count, max_probe };
+                        const auto outcome =
+                            simulate(items, params, options.trial_count, allowed_failures, thread_count);
+                        if (outcome.second > allowed_failures)
+                        {
+                            return false;
+                        }
+                        result.table_size = params.table_size;
+                        result.trial_count = outcome.first;
+                        result.failure_count = outcome.second;
+                        return true;
+                    };
+
+                    // A table smaller than items_in_table cannot hold the items; the search starts from the range
+                    // of sizes estimated by filling tables of that size, and grows the upper end of the range until
+                    // the builds succeed
+                    const uint64_t items_in_table = max<uint64_t>(
+                        options.item_count > stash_size ? options.item_count - stash_size : 0, min_table_size);
+                    if (items_in_table > max_table_size)
+                    {
+                        continue;
+                    }
+                    const auto estimate = estimate_table_size(
+                        items, { static_cast<table_size_type>(items_in_table), stash_size, loc_func_count, max_probe });
+                    uint64_t low =
+                        max(static_cast<uint64_t>(estimate.first * (1.0 - options.size_precision)), items_in_table) - 1;
+                    uint64_t high = max(
+                        static_cast<uint64_t>(ceil(estimate.second * (1.0 + options.size_precision))), low + 1);
+                    bool found = false;
+                    bool low_fails = low < items_in_table;
+                    while (high <= max_table_size && !(found = passes(high)))
+                    {
+                        low = high;
+                        low_fails = true;
+                        high += max((high - items_in_table) / 2, size_step);
+                    }
+                    if (!found)
+                    {
+                        continue;
+                    }
+
+                    // The lower end of the estimate is not simulated above; if it passes, move the range down with
+                    // growing steps until its lower end fails. Below items_in_table every size fails.
+                    for (uint64_t step = max(high - low, size_step); !low_fails && passes(low); step *= 2)
+                    {
+                        high = low;
+                        low = low - items_in_table > step ? low - step : items_in_table - 1;
+                        low_fails = low < items_in_table;
+                    }
+
+                    // Narrow down the smallest passing size; result always holds the outcome for high
+                    while (high - low > size_step)
+                    {
+                        const uint64_t mid = low + (high - low) / 2;
+                        if (!passes(mid))
+                        {
+                            low = mid;
+                        }
+                        else
+                        {
+                            high = mid;
+                        }
+                    }
+
+                    result.inserts_per_second = measure_inserts_per_second(
+                        items, { result.table_size, stash_size, loc_func_count, max_probe });
+                    results.push_back(result);
+                }
+            }
+        }
+
+        // Cheapest first: by memory, except that candidates within memory_slack of the smallest are ordered by the
+        // cost of a query and then by max_probe
+        auto memory = [](const TuneResult &result) {
+            return static_cast<uint64_t>(result.table_size) + result.stash_size;
+        };
+        uint64_t min_memory = ~uint64_t(0);
+        for (const auto &result : results)
+        {
+            min_memory = min(min_memory, memory(result));
+        }
+        const double max_small_memory = static_cast<double>(min_memory) * (1.0 + options.memory_slack);
+        sort(results.begin(), results.end(), [&](const TuneResult &a, const TuneResult &b) {
+            const bool a_small = static_cast<double>(memory(a)) <= max_small_memory;
+            const bool b_small = static_cast<double>(memory(b)) <= max_small_memory;
+            if (a_small != b_small)
+            {
+                return a_small;
+            }
+            if (a_small)
+            {
+                const uint64_t a_query_cost = static_cast<uint64_t>(a.loc_func_count) + a.stash_size;
+                const uint64_t b_query_cost = static_cast<uint64_t>(b.loc_func_count) + b.stash_size;
+                if (a_query_cost != b_query_cost)
+                {
+                    return a_query_cost < b_query_cost;
+                }
+                if (a.max_probe != b.max_probe)
+                {
+                    return a.max_probe < b.max_probe;
+                }
+            }
+            return memory(a) < memory(b);
+        });
+        return results;
+    }
+} // namespace kuku
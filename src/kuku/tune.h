@@ -0,0 +1,124 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "kuku/common.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace kuku
+{
+    /**
+    The parameters of a search for KukuTable constructor parameters with tune_parameters.
+    */
+    struct TuneOptions
+    {
+        /**
+        The number of items the hash table must hold.
+        */
+        std::size_t item_count = 0;
+
+        /**
+        The largest acceptable probability that inserting item_count items into a table with a random location
+        function seed fails.
+        */
+        double failure_probability = 0.0;
+
+        /**
+        The numbers of location functions to consider.
+        */
+        std::vector<std::uint32_t> loc_func_counts{ 2, 3, 4 };
+
+        /**
+        The stash sizes to consider.
+        */
+        std::vector<table_size_type> stash_sizes{ 0, 8 };
+
+        /**
+        The values of max_probe to consider.
+        */
+        std::vector<std::uint64_t> max_probes{ 20, 100, 500 };
+
+        /**
+        The number of simulated builds that decide whether a table size meets failure_probability. A table size is
+        accepted if at most failure_probability * trial_count of its builds fail; with no failures observed, the
+        failure probability is below 3 / trial_count with 95% confidence, so trial_count should be at least
+        3 / failure_probability for the result to be statistically sound.
+        */
+        std::size_t trial_count = 200;
+
+        /**
+        The precision of the search for the smallest table size, as a fraction of item_count.
+        */
+        double size_precision = 0.01;
+
+        /**
+        Candidates whose memory (table size plus stash size) exceeds that of the smallest candidate by at most this
+        fraction are considered equally small, and are ordered by the cost of a query instead.
+        */
+        double memory_slack = 0.05;
+
+        /**
+        The number of threads running simulated builds; zero uses one thread per hardware thread.
+        */
+        std::size_t thread_count = 0;
+    };
+
+    /**
+    A combination of KukuTable constructor parameters found by tune_parameters, with the outcome of its simulated
+    builds.
+    */
+    struct TuneResult
+    {
+        /**
+        The smallest table size found to meet the failure probability.
+        */
+        table_size_type table_size = 0;
+
+        table_size_type stash_size = 0;
+
+        std::uint32_t loc_func_count = 0;
+
+        std::uint64_t max_probe = 0;
+
+        /**
+        The number of simulated builds at table_size, and the number of them that failed.
+        */
+        std::size_t trial_count = 0;
+
+        std::size_t failure_count = 0;
+
+        /**
+        The throughput of inserting item_count items one by one with insert into a table with these parameters,
+        measured on one thread.
+        */
+        double inserts_per_second = 0.0;
+    };
+
+    /**
+    Searches for the cheapest KukuTable constructor parameters that hold a given number of items with a given
+    probability of failure. For every combination of the location function counts, stash sizes, and max_probe values
+    in options, the smallest table size is searched for at which simulated builds (random walk insertions of
+    item_count random items into tables with random location function seeds, using the real location functions and
+    insertion code) fail no more often than options.failure_probability. The search starts from the range of sizes
+    estimated by filling a few tables until their first failed insert. The builds run on several threads, and the
+    builds for a table size stop as soon as too many have failed.
+
+    The returned results hold one entry for every combination that meets the failure probability within the largest
+    allowed table size, cheapest first. Candidates are compared by their memory (table size plus stash size); those
+    within options.memory_slack of the smallest are ordered by the number of items a query reads (location function
+    count plus stash size), then by max_probe. The recommendation is the first entry. Every entry includes its
+    measured insert throughput.
+
+    @param[in] options The item count, failure probability, and candidate parameters
+    @throws std::invalid_argument if options.item_count is zero
+    @throws std::invalid_argument if options.failure_probability is not in (0, 1)
+    @throws std::invalid_argument if any list of candidate parameters is empty, or contains an invalid location
+    function count or a zero max_probe
+    @throws std::invalid_argument if options.trial_count is zero, or options.size_precision or options.memory_slack
+    is negative
+    */
+    [[nodiscard]] std::vector<TuneResult> tune_parameters(const TuneOptions &options);
+} // namespace kuku
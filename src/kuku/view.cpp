@@ -0,0 +1,214 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/view.h"
+#include "kuku/internal/serialization.h"
+#include <array>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace kuku
+{
+#ifdef _WIN32
+    class KukuTableView::FileMapping
+    {
+    public:
+        explicit FileMapping(const string &path)
+        {
+            HANDLE file = CreateFileA(
+                path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                throw runtime_error("failed to open " + path);
+            }
+            LARGE_INTEGER file_size;
+            if (!GetFileSizeEx(file, &file_size) || !file_size.QuadPart)
+            {
+                CloseHandle(file);
+                throw runtime_error("failed to map " + path);
+            }
+            mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            CloseHandle(file);
+            if (!mapping_)
+            {
+                throw runtime_error("failed to map " + path);
+            }
+            data_ = MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+            if (!data_)
+            {
+                CloseHandle(mapping_);
+                throw runtime_error("failed to map " + path);
+            }
+            size_ = static_cast<size_t>(file_size.QuadPart);
+        }
+
+        ~FileMapping()
+        {
+            UnmapViewOfFile(data_);
+            CloseHandle(mapping_);
+        }
+
+        const byte *data() const noexcept
+        {
+            return static_cast<const byte *>(data_);
+        }
+
+        size_t size() const noexcept
+        {
+            return size_;
+        }
+
+    private:
+        HANDLE mapping_ = nullptr;
+
+        void *data_ = nullptr;
+
+        size_t size_ = 0;
+    };
+#else
+    class KukuTableView::FileMapping
+    {
+    public:
+        explicit FileMapping(const string &path)
+        {
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                throw runtime_error("failed to open " + path);
+            }
+            struct stat file_stat;
+            if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0)
+            {
+                close(fd);
+                throw runtime_error("failed to map " + path);
+            }
+            size_ = static_cast<size_t>(file_stat.st_size);
+            data_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if (data_ == MAP_FAILED)
+            {
+                throw runtime_error("failed to map " + path);
+            }
+
+            // Queries touch the table at random; reading ahead would only waste I/O and page cache
+            (void)madvise(data_, size_, MADV_RANDOM);
+        }
+
+        ~FileMapping()
+        {
+            munmap(data_, size_);
+        }
+
+        const byte *data() const noexcept
+        {
+            return static_cast<const byte *>(data_);
+        }
+
+        size_t size() const noexcept
+        {
+            return size_;
+        }
+
+    private:
+        void *data_ = nullptr;
+
+        size_t size_ = 0;
+    };
+#endif
+
+    SaveHeader KukuTableView::read_header(const byte *data, size_t size)
+    {
+        if (nullptr == data)
+        {
+            throw invalid_argument("data cannot be null");
+        }
+        if (size < SaveHeader::size + SaveHeader::checksum_size)
+        {
+            throw invalid_argument("size is too small");
+        }
+        const SaveHeader header = SaveHeader::read(reinterpret_cast<const unsigned char *>(data));
+        if (size < SaveHeader::size + header.body_size() + SaveHeader::checksum_size)
+        {
+            throw invalid_argument("size is too small");
+        }
+        if (header.stash_count > header.stash_size ||
+            static_cast<uint64_t>(header.inserted_items) >
+                static_cast<uint64_t>(header.table_size) + static_cast<uint64_t>(header.stash_count))
+        {
+            throw invalid_argument("saved KukuTable is invalid");
+        }
+        return header;
+    }
+
+    KukuTableView::KukuTableView(const byte *data, size_t size)
+        : KukuTableView(read_header(data, size), reinterpret_cast<const unsigned char *>(data))
+    {}
+
+    KukuTableView::KukuTableView(const SaveHeader &header, const unsigned char *data)
+        : data_(data), table_(reinterpret_cast<const item_type *>(data + SaveHeader::size)),
+          stash_(table_ + header.table_size), stash_index_(header.stash_size),
+          loc_funcs_(header.table_size, header.loc_func_count, header.loc_func_seed, header.loc_func_mode,
+                     header.hash_family),
+          table_size_(header.table_size), stash_size_(header.stash_size), stash_count_(header.stash_count),
+          loc_func_seed_(header.loc_func_seed), max_probe_(header.max_probe), empty_item_(header.empty_item),
+          leftover_item_(header.leftover_item), inserted_items_(header.inserted_items)
+    {
+        // The location (hash) functions have already validated loc_func_count, table_size, and the modes
+        stash_index_.rebuild(stash_, stash_count_);
+    }
+
+    KukuTableView::~KukuTableView() = default;
+
+    unique_ptr<KukuTableView> KukuTableView::map_file(const string &path)
+    {
+        auto mapping = make_unique<FileMapping>(path);
+        auto view = make_unique<KukuTableView>(mapping->data(), mapping->size());
+        view->mapping_ = move(mapping);
+        return view;
+    }
+
+    QueryResult KukuTableView::query(item_type item) const
+    {
+        if (is_empty_item(item))
+        {
+            throw invalid_argument("item cannot be the empty item");
+        }
+
+        array<location_type, max_loc_func_count> locations;
+        loc_funcs_.locations(item, locations.data());
+
+        // Search the hash table
+        const uint32_t i = detail::find_at_locations(table_, item, locations.data(), loc_func_count());
+        if (i < loc_func_count())
+        {
+            return { locations[i], i };
+        }
+
+        // Search the stash
+        const size_t position = stash_index_.find(stash_, stash_count_, item);
+        if (position < stash_count_)
+        {
+            return { static_cast<location_type>(position), ~static_cast<uint32_t>(0) };
+        }
+
+        // Not found
+        return { 0, max_loc_func_count };
+    }
+
+    bool KukuTableView::verify_checksum() const noexcept
+    {
+        const unsigned char *checksum = reinterpret_cast<const unsigned char *>(stash_ + stash_count_);
+        return read_le<uint64_t>(checksum) == save_checksum(data_, table_, table_size_, stash_, stash_count_);
+    }
+} // namespace kuku
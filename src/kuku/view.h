@@ -0,0 +1,289 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include "kuku/common.h"
+#include "kuku/kuku.h"
+#include "kuku/locfunc.h"
+#include "kuku/internal/lookup.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace kuku
+{
+    /**
+    The KukuTableView class is a read-only view of a hash table saved with KukuTable::save. It reads the table and
+    stash in place, either from a buffer owned by the caller or from a file mapped into memory with map_file, so
+    creating a view copies nothing and takes time independent of the size of the table; only a stash of more than
+    eight items is read on creation, to index it as KukuTable does. When a file is mapped, pages are read from disk as
+    queries touch them, and processes that map the same file share them in the page cache.
+
+    The checksum of the saved table is not verified on creation, since that would read the entire table; call
+    verify_checksum to do so.
+    */
+    class KukuTableView
+    {
+    public:
+        /**
+        Creates a view of a hash table saved in a buffer. The buffer must remain valid and unchanged for the lifetime
+        of the view.
+
+        @param[in] data The buffer holding the saved hash table
+        @param[in] size The size of the buffer in bytes
+        @throws std::invalid_argument if data is null, or the data is not a saved hash table, has an unsupported
+        version, is truncated, or has invalid parameters
+        */
+        KukuTableView(const std::byte *data, std::size_t size);
+
+        /**
+        Creates a view of a hash table saved in a file by mapping the file read-only into memory. The mapping is
+        released when the view is destroyed.
+
+        @param[in] path The path of the file
+        @throws std::runtime_error if the file cannot be opened or mapped
+        @throws std::invalid_argument if the file does not hold a valid saved hash table
+        */
+        [[nodiscard]] static std::unique_ptr<KukuTableView> map_file(const std::string &path);
+
+        ~KukuTableView();
+
+        /**
+        Queries for the presence of a given item in the hash table and stash.
+
+        @param[in] item The hash table item to query
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] QueryResult query(item_type item) const;
+
+        /**
+        Returns a location that a given hash table item may be placed at.
+
+        @param[in] item The hash table item for which the location is to be obtained
+        @param[in] loc_func_index The index of the location function which to use to compute the location
+        @throws std::out_of_range if loc_func_index is out of range
+        @throws std::invalid_argument if the given item is the empty item for this hash table
+        */
+        [[nodiscard]] location_type location(item_type item, std::uint32_t loc_func_index) const
+        {
+            if (loc_func_index >= loc_func_count())
+            {
+                throw std::out_of_range("loc_func_index is out of range");
+            }
+            if (is_empty_item(item))
+            {
+                throw std::invalid_argument("item cannot be the empty item");
+            }
+            return loc_funcs_(item, loc_func_index);
+        }
+
+        /**
+        Returns whether the checksum stored with the saved hash table matches its contents. This reads the entire
+        table.
+        */
+        [[nodiscard]] bool verify_checksum() const noexcept;
+
+        /**
+        Returns the number of location functions used by the hash table.
+        */
+        [[nodiscard]] std::uint32_t loc_func_count() const noexcept
+        {
+            return loc_funcs_.loc_func_count();
+        }
+
+        /**
+        Returns whether the location functions use independent hash functions or are derived from two.
+        */
+        [[nodiscard]] LocFuncMode loc_func_mode() const noexcept
+        {
+            return loc_funcs_.mode();
+        }
+
+        /**
+        Returns the family of the hash functions underlying the location functions.
+        */
+        [[nodiscard]] HashFamily hash_family() const noexcept
+        {
+            return loc_funcs_.hash_family();
+        }
+
+        /**
+        Returns a reference to the item at a specific location in the hash table.
+
+        @param[in] index The index in the hash table
+        @throws std::out_of_range if index is out of range
+        */
+        [[nodiscard]] const item_type &table(location_type index) const
+        {
+            if (index >= table_size_)
+            {
+                throw std::out_of_range("index is out of range");
+            }
+            return table_[index];
+        }
+
+        /**
+        Returns a reference to the item at a specific index in the stash. As in KukuTable, the stash is logically full
+        of empty slots up to stash_size(), so for indices in the range [stash_count(), stash_size()) this returns a
+        reference to the empty item.
+
+        @param[in] index The index in the stash
+        @throws std::out_of_range if index is greater than or equal to stash_size()
+        */
+        [[nodiscard]] const item_type &stash(location_type index) const
+        {
+            if (index >= stash_size_)
+            {
+                throw std::out_of_range("index is out of range");
+            }
+            if (index >= stash_count_)
+            {
+                return empty_item_;
+            }
+            return stash_[index];
+        }
+
+        /**
+        Returns the number of items in the stash.
+        */
+        [[nodiscard]] table_size_type stash_count() const noexcept
+        {
+            return stash_count_;
+        }
+
+        /**
+        Returns the size of the hash table.
+        */
+        [[nodiscard]] table_size_type table_size() const noexcept
+        {
+            return table_size_;
+        }
+
+        /**
+        Returns the size of the stash.
+        */
+        [[nodiscard]] table_size_type stash_size() const noexcept
+        {
+            return stash_size_;
+        }
+
+        /**
+        Returns the 128-bit seed used for the location functions, represented as a hash table item.
+        */
+        [[nodiscard]] item_type loc_func_seed() const noexcept
+        {
+            return loc_func_seed_;
+        }
+
+        /**
+        Returns the maximum number of random walk steps taken in attempting to insert an item.
+        */
+        [[nodiscard]] std::uint64_t max_probe() const noexcept
+        {
+            return max_probe_;
+        }
+
+        /**
+        Returns the hash table item that represents an empty location in the table.
+        */
+        [[nodiscard]] const item_type &empty_item() const noexcept
+        {
+            return empty_item_;
+        }
+
+        /**
+        Returns whether a given location in the table is empty.
+
+        @param[in] index The index in the hash table
+        @throws std::out_of_range if index is out of range
+        */
+        [[nodiscard]] bool is_empty(location_type index) const
+        {
+            return is_empty_item(table(index));
+        }
+
+        /**
+        Returns whether a given item is the empty item for this hash table.
+
+        @param[in] item The item to compare to the empty item
+        */
+        [[nodiscard]] bool is_empty_item(const item_type &item) const noexcept
+        {
+            return are_equal_item(item, empty_item_);
+        }
+
+        /**
+        Returns the leftover item of the hash table when it was saved.
+        */
+        [[nodiscard]] item_type leftover_item() const noexcept
+        {
+            return leftover_item_;
+        }
+
+        /**
+        Returns the fill rate of the hash table and stash.
+        */
+        [[nodiscard]] double fill_rate() const noexcept
+        {
+            return static_cast<double>(inserted_items_) /
+                   (static_cast<double>(table_size_) + static_cast<double>(stash_size_));
+        }
+
+        KukuTableView(const KukuTableView &copy) = delete;
+
+        KukuTableView &operator=(const KukuTableView &assign) = delete;
+
+    private:
+        /*
+        Reads and validates the header of a saved hash table in a buffer of the given size.
+        */
+        static SaveHeader read_header(const std::byte *data, std::size_t size);
+
+        KukuTableView(const SaveHeader &header, const unsigned char *data);
+
+        /*
+        A read-only memory mapping of a file, released on destruction; defined per platform in view.cpp.
+        */
+        class FileMapping;
+
+        std::unique_ptr<FileMapping> mapping_;
+
+        /*
+        The saved hash table: the start of the header, and the table and stash within it.
+        */
+        const unsigned char *data_;
+
+        const item_type *table_;
+
+        const item_type *stash_;
+
+        /*
+        The index of the stash, used by queries instead of scanning a large stash; built when the view is created.
+        */
+        detail::StashIndex<item_type> stash_index_;
+
+        /*
+        The hash functions.
+        */
+        const LocFuncBank loc_funcs_;
+
+        const table_size_type table_size_;
+
+        const table_size_type stash_size_;
+
+        const table_size_type stash_count_;
+
+        const item_type loc_func_seed_;
+
+        const std::uint64_t max_probe_;
+
+        const item_type empty_item_;
+
+        const item_type leftover_item_;
+
+        const table_size_type inserted_items_;
+    };
+} // namespace kuku
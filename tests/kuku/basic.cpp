@@ -0,0 +1,201 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/basic.h"
+#include "kuku/internal/hash.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_tests
+{
+    namespace
+    {
+        template <size_t ItemBytes>
+        void test_fill()
+        {
+            using item = basic_item_type<ItemBytes>;
+            SizedKukuTable<ItemBytes> table(1U << 12U, 4, 3, make_random_item(), 100, item{});
+            ASSERT_EQ(ItemBytes, sizeof(table.table(0)));
+            ASSERT_TRUE(table.is_empty(0));
+            ASSERT_THROW((void)table.insert(item{}), invalid_argument);
+            ASSERT_THROW((void)table.query(item{}), invalid_argument);
+
+            vector<item> inserted_items;
+            item next = make_random_item<ItemBytes>();
+            while (table.insert(next))
+            {
+                inserted_items.push_back(next);
+                next = make_random_item<ItemBytes>();
+            }
+            ASSERT_GT(table.fill_rate(), 0.75);
+            ASSERT_EQ(4, table.stash().size());
+
+            // The failed insert left out either the new item or one that it evicted
+            inserted_items.push_back(next);
+            auto leftover = find_if(inserted_items.begin(), inserted_items.end(), [&](const item &b) {
+                return are_equal_item(b, table.leftover_item());
+            });
+            ASSERT_TRUE(leftover != inserted_items.end());
+            ASSERT_FALSE(table.query(table.leftover_item()));
+            inserted_items.erase(leftover);
+            for (const auto &b : inserted_items)
+            {
+                QueryResult res = table.query(b);
+                ASSERT_TRUE(res.found());
+                if (res.in_stash())
+                {
+                    ASSERT_TRUE(are_equal_item(b, table.stash(res.location())));
+                }
+                else
+                {
+                    ASSERT_TRUE(are_equal_item(b, table.table(res.location())));
+                    ASSERT_EQ(table.location(b, res.loc_func_index()), res.location());
+                }
+                ASSERT_FALSE(table.insert(b));
+            }
+            ASSERT_FALSE(table.query(make_random_item<ItemBytes>()));
+
+            table.clear_table();
+            ASSERT_EQ(0.0, table.fill_rate());
+            ASSERT_TRUE(table.stash().empty());
+            ASSERT_FALSE(table.query(inserted_items[0]));
+        }
+
+        template <size_t ItemBytes>
+        void test_hash_batch()
+        {
+            BasicHashFunc<ItemBytes> hf(make_random_item());
+            BasicHashFuncBank<ItemBytes> bank(3, make_zero_item());
+            vector<basic_item_type<ItemBytes>> items;
+            for (int i = 0; i < 45; i++)
+            {
+                items.push_back(make_random_item<ItemBytes>());
+            }
+            vector<location_type> out(items.size());
+            hf(items.data(), items.size(), out.data());
+            for (size_t i = 0; i < items.size(); i++)
+            {
+                ASSERT_EQ(hf(items[i]), out[i]);
+            }
+
+            // The bank function of index i is the function seeded with i
+            item_type seed = make_zero_item();
+            for (uint32_t func = 0; func < 3; func++)
+            {
+                BasicHashFunc<ItemBytes> single(seed);
+                location_type all[3];
+                bank(items[func], all);
+                ASSERT_EQ(single(items[func]), bank(items[func], func));
+                ASSERT_EQ(single(items[func]), all[func]);
+                increment_item(seed);
+            }
+        }
+    } // namespace
+
+    TEST(SizedKukuTableTests, Create)
+    {
+        using item8 = basic_item_type<8>;
+        ASSERT_THROW(SizedKukuTable<8>(0, 0, 2, make_zero_item(), 1, item8{}), invalid_argument);
+        ASSERT_THROW(SizedKukuTable<8>(1, 0, 0, make_zero_item(), 1, item8{}), invalid_argument);
+        ASSERT_THROW(
+            SizedKukuTable<8>(1, 0, max_loc_func_count + 1, make_zero_item(), 1, item8{}), invalid_argument);
+        ASSERT_THROW(SizedKukuTable<8>(1, 0, 2, make_zero_item(), 0, item8{}), invalid_argument);
+
+        SizedKukuTable<32> table(1000, 2, 3, make_zero_item(), 10, make_random_item<32>());
+        ASSERT_EQ(1000, table.table_size());
+        ASSERT_EQ(2, table.stash_size());
+        ASSERT_EQ(3, table.loc_func_count());
+        ASSERT_EQ(10, table.max_probe());
+        ASSERT_TRUE(table.is_empty_item(table.table(999)));
+        ASSERT_TRUE(table.is_empty_item(table.leftover_item()));
+        ASSERT_THROW((void)table.table(1000), out_of_range);
+        ASSERT_TRUE(table.is_empty_item(table.stash(1)));
+        ASSERT_THROW((void)table.stash(2), out_of_range);
+        ASSERT_THROW((void)table.location(make_random_item<32>(), 3), out_of_range);
+    }
+
+    TEST(SizedKukuTableTests, Fill)
+    {
+        test_fill<8>();
+        test_fill<16>();
+        test_fill<32>();
+    }
+
+    TEST(SizedKukuTableTests, MatchesKukuTable)
+    {
+        static_assert(is_same<BasicKukuTable<16>, KukuTable>::value, "BasicKukuTable<16> must be KukuTable");
+        static_assert(is_same<BasicKukuTable<8>, SizedKukuTable<8>>::value, "BasicKukuTable<8> must be sized");
+        static_assert(is_same<basic_item_type<16>, item_type>::value, "basic_item_type<16> must be item_type");
+        static_assert(
+            is_same<decltype(declval<const SizedKukuTable<16> &>().leftover_item()),
+                    decltype(declval<const KukuTable &>().leftover_item())>::value,
+            "leftover_item must return by value like KukuTable");
+
+        // With 16-byte items the locations are those of a KukuTable with the same seed
+        const item_type seed = make_random_item();
+        SizedKukuTable<16> sized(10007, 0, 4, seed, 100, make_zero_item());
+        KukuTable table(10007, 0, 4, seed, 100, make_zero_item());
+        for (int i = 0; i < 100; i++)
+        {
+            const item_type item = make_random_item();
+            for (uint32_t func = 0; func < 4; func++)
+            {
+                ASSERT_EQ(table.location(item, func), sized.location(item, func));
+            }
+        }
+
+        // Both pad the stash with empty items up to its size
+        SizedKukuTable<16> sized_stash(16, 2, 2, seed, 1, make_zero_item());
+        KukuTable table_stash(16, 2, 2, seed, 1, make_zero_item());
+        for (location_type index = 0; index < 2; index++)
+        {
+            ASSERT_TRUE(are_equal_item(table_stash.stash(index), sized_stash.stash(index)));
+        }
+        ASSERT_THROW((void)table_stash.stash(2), out_of_range);
+        ASSERT_THROW((void)sized_stash.stash(2), out_of_range);
+    }
+
+    TEST(SizedKukuTableTests, HashBatch)
+    {
+        test_hash_batch<8>();
+        test_hash_batch<16>();
+        test_hash_batch<32>();
+    }
+
+    TEST(SizedKukuTableTests, Items)
+    {
+        const unsigned char bytes[8]{ 1, 2, 3, 4, 5, 6, 7, 8 };
+        const basic_item_type<8> item = make_item<8>(bytes);
+        ASSERT_EQ(8, item[7]);
+        ASSERT_TRUE(are_equal_item(item, make_item<8>(bytes)));
+        ASSERT_FALSE(are_equal_item(item, basic_item_type<8>{}));
+        ASSERT_TRUE(are_equal_item(make_item(1, 2), make_item<16>(make_item(1, 2).data())));
+    }
+
+    TEST(SizedKukuTableTests, LargeStash)
+    {
+        // Large stashes are indexed; with max_probe 1 items overflow into the stash early
+        SizedKukuTable<8> table(1U << 8U, 64, 2, make_random_item(), 1, basic_item_type<8>{});
+        vector<basic_item_type<8>> items;
+        while (table.stash().size() < table.stash_size())
+        {
+            items.push_back(make_random_item<8>());
+            ASSERT_TRUE(table.insert(items.back()));
+        }
+        for (const auto &item : items)
+        {
+            QueryResult res = table.query(item);
+            ASSERT_TRUE(res);
+            ASSERT_TRUE(
+                are_equal_item(item, res.in_stash() ? table.stash(res.location()) : table.table(res.location())));
+        }
+        ASSERT_FALSE(table.query(make_random_item<8>()));
+    }
+} // namespace kuku_tests
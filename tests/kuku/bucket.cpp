@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/bucket.h"
+#include "gtest/gtest.h"
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_tests
+{
+    TEST(BucketKukuTableTests, Create)
+    {
+        ASSERT_THROW(BucketKukuTable(0, 4, 0, 2, make_zero_item(), 1, make_zero_item()), invalid_argument);
+        ASSERT_THROW(BucketKukuTable(1, 3, 0, 2, make_zero_item(), 1, make_zero_item()), invalid_argument);
+        ASSERT_THROW(BucketKukuTable(1, 16, 0, 2, make_zero_item(), 1, make_zero_item()), invalid_argument);
+        ASSERT_THROW(
+            BucketKukuTable(max_table_size / 4 + 1, 4, 0, 2, make_zero_item(), 1, make_zero_item()),
+            invalid_argument);
+        ASSERT_THROW(BucketKukuTable(1, 4, 0, 0, make_zero_item(), 1, make_zero_item()), invalid_argument);
+        ASSERT_THROW(BucketKukuTable(1, 4, 0, 2, make_zero_item(), 0, make_zero_item()), invalid_argument);
+        ASSERT_NO_THROW(BucketKukuTable(1, 2, 0, 1, make_zero_item(), 1, make_zero_item()));
+
+        BucketKukuTable ct(100, 8, 4, 2, make_zero_item(), 10, make_all_ones_item());
+        ASSERT_EQ(100, ct.bucket_count());
+        ASSERT_EQ(8, ct.slot_count());
+        ASSERT_EQ(800, ct.table_size());
+        ASSERT_EQ(4, ct.stash_size());
+        ASSERT_EQ(2, ct.loc_func_count());
+        ASSERT_EQ(10, ct.max_probe());
+        ASSERT_TRUE(ct.is_empty_item(ct.table(799)));
+        ASSERT_THROW((void)ct.table(800), out_of_range);
+        ASSERT_THROW((void)ct.bucket(make_zero_item(), 2), out_of_range);
+        ASSERT_THROW((void)ct.insert(make_all_ones_item()), invalid_argument);
+        ASSERT_THROW((void)ct.query(make_all_ones_item()), invalid_argument);
+    }
+
+    TEST(BucketKukuTableTests, Fill)
+    {
+        // Two location functions reach these fill rates comfortably; the thresholds are about 0.90, 0.98, and 0.998
+        for (pair<uint32_t, double> config : { make_pair(2U, 0.8), make_pair(4U, 0.93), make_pair(8U, 0.95) })
+        {
+            const uint32_t slot_count = config.first;
+            BucketKukuTable ct(1U << 10U, slot_count, 0, 2, make_random_item(), 500, make_zero_item());
+            vector<item_type> inserted_items;
+            while (ct.fill_rate() < config.second)
+            {
+                inserted_items.emplace_back(make_random_item());
+                ASSERT_TRUE(ct.insert(inserted_items.back()));
+            }
+
+            // Re-inserting fails without effect
+            ASSERT_FALSE(ct.insert(inserted_items.front()));
+
+            set<location_type> locations;
+            for (const auto &item : inserted_items)
+            {
+                QueryResult res = ct.query(item);
+                ASSERT_TRUE(res.found());
+                ASSERT_FALSE(res.in_stash());
+                ASSERT_TRUE(are_equal_item(item, ct.table(res.location())));
+                ASSERT_EQ(ct.bucket(item, res.loc_func_index()), res.location() / slot_count);
+                locations.insert(res.location());
+            }
+            ASSERT_EQ(inserted_items.size(), locations.size());
+            for (int i = 0; i < 100; i++)
+            {
+                ASSERT_FALSE(ct.query(make_random_item()));
+            }
+
+            ct.clear_table();
+            ASSERT_EQ(0.0, ct.fill_rate());
+            for (const auto &item : inserted_items)
+            {
+                ASSERT_FALSE(ct.query(item));
+            }
+        }
+    }
+
+    TEST(BucketKukuTableTests, MatchesHalves)
+    {
+        // Items that agree with a stored item in one 64-bit half only must not be found
+        BucketKukuTable ct(1, 4, 0, 1, make_zero_item(), 1, make_zero_item());
+        ASSERT_TRUE(ct.insert(make_item(1, 2)));
+        ASSERT_TRUE(ct.insert(make_item(3, 4)));
+        ASSERT_TRUE(ct.query(make_item(1, 2)));
+        ASSERT_TRUE(ct.query(make_item(3, 4)));
+        ASSERT_FALSE(ct.query(make_item(1, 4)));
+        ASSERT_FALSE(ct.query(make_item(3, 2)));
+        ASSERT_FALSE(ct.query(make_item(2, 3)));
+    }
+
+    TEST(BucketKukuTableTests, Stash)
+    {
+        BucketKukuTable ct(1, 2, 2, 1, make_zero_item(), 1, make_zero_item());
+        ASSERT_TRUE(ct.insert(make_item(1, 0)));
+        ASSERT_TRUE(ct.insert(make_item(2, 0)));
+        ASSERT_TRUE(ct.insert(make_item(3, 0)));
+        ASSERT_TRUE(ct.insert(make_item(4, 0)));
+        ASSERT_FALSE(ct.insert(make_item(5, 0)));
+        ASSERT_EQ(2, ct.stash().size());
+        ASSERT_FALSE(ct.is_empty_item(ct.leftover_item()));
+        for (uint64_t i = 1; i <= 5; i++)
+        {
+            QueryResult res = ct.query(make_item(i, 0));
+            ASSERT_EQ(!are_equal_item(make_item(i, 0), ct.leftover_item()), res.found());
+        }
+        ASSERT_EQ(1.0, ct.fill_rate());
+    }
+
+    TEST(BucketKukuTableTests, LargeStash)
+    {
+        // Large stashes are indexed; with max_probe 1 items overflow into the stash early
+        BucketKukuTable ct(1U << 6U, 2, 64, 2, make_random_item(), 1, make_zero_item());
+        vector<item_type> items;
+        for (uint64_t i = 1; ct.stash().size() < ct.stash_size(); i++)
+        {
+            items.push_back(make_item(i, 0));
+            ASSERT_TRUE(ct.insert(items.back()));
+        }
+        for (const auto &item : items)
+        {
+            QueryResult res = ct.query(item);
+            ASSERT_TRUE(res);
+            if (res.in_stash())
+            {
+                ASSERT_TRUE(are_equal_item(item, ct.stash()[res.location()]));
+            }
+        }
+        ASSERT_FALSE(ct.query(make_random_item()));
+
+        ct.clear_table();
+        ASSERT_FALSE(ct.query(items.back()));
+    }
+} // namespace kuku_tests
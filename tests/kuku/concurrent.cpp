@@ -0,0 +1,265 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/concurrent.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_tests
+{
+    TEST(ConcurrentKukuTableTests, Create)
+    {
+        ASSERT_THROW(ConcurrentKukuTable(0, 0, 2, make_zero_item(), 1, make_zero_item()), invalid_argument);
+        ASSERT_THROW(ConcurrentKukuTable(1, 0, 0, make_zero_item(), 1, make_zero_item()), invalid_argument);
+        ASSERT_THROW(ConcurrentKukuTable(1, 0, 2, make_zero_item(), 0, make_zero_item()), invalid_argument);
+
+        ConcurrentKukuTable ct(1000, 2, 3, make_zero_item(), 10, make_all_ones_item());
+        ASSERT_EQ(1000, ct.table_size());
+        ASSERT_EQ(2, ct.stash_size());
+        ASSERT_EQ(512, ct.stripe_count());
+        ASSERT_TRUE(ct.is_empty_item(ct.table(999)));
+        ASSERT_THROW((void)ct.table(1000), out_of_range);
+        ASSERT_THROW((void)ct.insert(make_all_ones_item()), invalid_argument);
+        ASSERT_THROW((void)ct.query(make_all_ones_item()), invalid_argument);
+    }
+
+    TEST(ConcurrentKukuTableTests, Fill)
+    {
+        ConcurrentKukuTable ct(1U << 12U, 4, 3, make_random_item(), 100, make_zero_item());
+        vector<item_type> inserted_items;
+        item_type item = make_random_item();
+        while (ct.insert(item))
+        {
+            inserted_items.push_back(item);
+            item = make_random_item();
+        }
+        ASSERT_GT(ct.fill_rate(), 0.75);
+        ASSERT_EQ(4, ct.stash().size());
+        ASSERT_FALSE(ct.query(item));
+        for (const auto &b : inserted_items)
+        {
+            QueryResult res = ct.query(b);
+            ASSERT_TRUE(res.found());
+            if (!res.in_stash())
+            {
+                ASSERT_TRUE(are_equal_item(b, ct.table(res.location())));
+                ASSERT_EQ(ct.location(b, res.loc_func_index()), res.location());
+            }
+            ASSERT_FALSE(ct.insert(b));
+        }
+
+        ct.clear_table();
+        ASSERT_EQ(0.0, ct.fill_rate());
+        ASSERT_FALSE(ct.query(inserted_items[0]));
+    }
+
+    TEST(ConcurrentKukuTableTests, ConcurrentInsert)
+    {
+        constexpr size_t thread_count = 4;
+        constexpr table_size_type table_size = 1U << 14U;
+        constexpr size_t items_per_thread = table_size / 5;
+        ConcurrentKukuTable ct(table_size, 0, 3, make_random_item(), 100, make_zero_item());
+
+        vector<vector<item_type>> items(thread_count);
+        for (auto &thread_items : items)
+        {
+            for (size_t i = 0; i < items_per_thread; i++)
+            {
+                thread_items.push_back(make_random_item());
+            }
+        }
+
+        // Every thread inserts its own items and also tries to insert the items of the next thread; each item must
+        // be inserted exactly once
+        atomic<size_t> successes{ 0 };
+        vector<thread> threads;
+        for (size_t t = 0; t < thread_count; t++)
+        {
+            threads.emplace_back([&, t]() {
+                const auto &own = items[t];
+                const auto &other = items[(t + 1) % thread_count];
+                for (size_t i = 0; i < items_per_thread; i++)
+                {
+                    successes += static_cast<size_t>(ct.insert(own[i]));
+                    successes += static_cast<size_t>(ct.insert(other[i]));
+                }
+            });
+        }
+        for (auto &th : threads)
+        {
+            th.join();
+        }
+
+        ASSERT_EQ(thread_count * items_per_thread, successes.load());
+        ASSERT_DOUBLE_EQ(
+            static_cast<double>(thread_count * items_per_thread) / static_cast<double>(table_size), ct.fill_rate());
+        size_t occupied = 0;
+        for (location_type loc = 0; loc < table_size; loc++)
+        {
+            occupied += static_cast<size_t>(!ct.is_empty_item(ct.table(loc)));
+        }
+        ASSERT_EQ(thread_count * items_per_thread, occupied);
+        for (const auto &thread_items : items)
+        {
+            for (const auto &item : thread_items)
+            {
+                ASSERT_TRUE(ct.query(item));
+            }
+        }
+    }
+
+    TEST(ConcurrentKukuTableTests, QueryDuringInsert)
+    {
+        constexpr table_size_type table_size = 1U << 13U;
+        ConcurrentKukuTable ct(table_size, 0, 2, make_random_item(), 100, make_zero_item());
+
+        // Items inserted before the readers start must be found while writers move them around
+        vector<item_type> present;
+        for (size_t i = 0; i < table_size / 4; i++)
+        {
+            present.push_back(make_random_item());
+            ASSERT_TRUE(ct.insert(present.back()));
+        }
+
+        atomic<bool> done{ false };
+        atomic<size_t> misses{ 0 };
+        vector<thread> threads;
+        for (int w = 0; w < 2; w++)
+        {
+            threads.emplace_back([&]() {
+                for (table_size_type i = 0; i < table_size && ct.fill_rate() < 0.45; i++)
+                {
+                    (void)ct.insert(make_random_item());
+                }
+            });
+        }
+        for (int r = 0; r < 2; r++)
+        {
+            threads.emplace_back([&]() {
+                while (!done.load())
+                {
+                    for (const auto &item : present)
+                    {
+                        misses += static_cast<size_t>(!ct.query(item));
+                    }
+                }
+            });
+        }
+        threads[0].join();
+        threads[1].join();
+        done = true;
+        threads[2].join();
+        threads[3].join();
+
+        ASSERT_EQ(0, misses.load());
+    }
+
+    TEST(ConcurrentKukuTableTests, SingleWriterLockFreeReaders)
+    {
+        constexpr table_size_type table_size = 1U << 12U;
+        ConcurrentKukuTable ct(table_size, 16, 2, make_random_item(), 100, make_zero_item());
+
+        vector<item_type> present;
+        for (size_t i = 0; i < table_size / 4; i++)
+        {
+            present.push_back(make_random_item());
+            ASSERT_TRUE(ct.insert(present.back()));
+        }
+
+        // A single writer fills the table until it and the stash are full, moving items on every step; readers must
+        // find every item inserted before they started and no item that was never inserted
+        atomic<bool> done{ false };
+        atomic<size_t> misses{ 0 };
+        atomic<size_t> false_hits{ 0 };
+        vector<thread> readers;
+        for (int r = 0; r < 3; r++)
+        {
+            readers.emplace_back([&]() {
+                while (!done.load())
+                {
+                    for (const auto &item : present)
+                    {
+                        misses += static_cast<size_t>(!ct.query(item));
+                    }
+                    false_hits += static_cast<size_t>(!!ct.query(make_random_item()));
+                }
+            });
+        }
+        table_size_type failures = 0;
+        for (table_size_type i = 0; i < table_size && failures < 16; i++)
+        {
+            failures += static_cast<table_size_type>(!ct.insert(make_random_item()));
+        }
+        done = true;
+        for (auto &reader : readers)
+        {
+            reader.join();
+        }
+
+        ASSERT_EQ(0, misses.load());
+        ASSERT_EQ(0, false_hits.load());
+        ASSERT_EQ(16, ct.stash().size());
+        for (const auto &item : ct.stash())
+        {
+            ASSERT_TRUE(ct.query(item).in_stash());
+        }
+    }
+
+    TEST(ConcurrentKukuTableTests, ConcurrentInsertWithStash)
+    {
+        constexpr size_t thread_count = 4;
+        constexpr table_size_type table_size = 1U << 8U;
+        constexpr table_size_type stash_size = 64;
+
+        // With two location functions and a short search, many items end up in the stash; every thread inserts the
+        // same items, so that an item is often stashed by one thread while another places it in the table
+        ConcurrentKukuTable ct(table_size, stash_size, 2, make_random_item(), 2, make_zero_item());
+        vector<item_type> items;
+        for (table_size_type i = 0; i < table_size + stash_size; i++)
+        {
+            items.push_back(make_random_item());
+        }
+
+        atomic<size_t> successes{ 0 };
+        vector<thread> threads;
+        for (size_t t = 0; t < thread_count; t++)
+        {
+            threads.emplace_back([&]() {
+                for (const auto &item : items)
+                {
+                    successes += static_cast<size_t>(ct.insert(item));
+                }
+            });
+        }
+        for (auto &th : threads)
+        {
+            th.join();
+        }
+
+        // Every item is stored at most once, in the table or in the stash, and every stored item was reported
+        // inserted exactly once
+        vector<item_type> stored = ct.stash();
+        ASSERT_FALSE(stored.empty());
+        for (location_type loc = 0; loc < table_size; loc++)
+        {
+            if (!ct.is_empty_item(ct.table(loc)))
+            {
+                stored.push_back(ct.table(loc));
+            }
+        }
+        ASSERT_EQ(successes.load(), stored.size());
+        sort(stored.begin(), stored.end());
+        ASSERT_TRUE(adjacent_find(stored.begin(), stored.end()) == stored.end());
+        for (const auto &item : stored)
+        {
+            ASSERT_TRUE(ct.query(item));
+        }
+    }
+} // namespace kuku_tests
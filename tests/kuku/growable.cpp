@@ -0,0 +1,119 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/growable.h"
+#include "gtest/gtest.h"
+#include <cstddef>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_tests
+{
+    TEST(GrowableKukuTableTests, Create)
+    {
+        ASSERT_THROW(GrowableKukuTable(0, 0, 2, make_zero_item(), 1, make_zero_item()), invalid_argument);
+        ASSERT_THROW(GrowableKukuTable(1, 0, 0, make_zero_item(), 1, make_zero_item()), invalid_argument);
+        ASSERT_THROW(GrowableKukuTable(1, 0, 2, make_zero_item(), 0, make_zero_item()), invalid_argument);
+        ASSERT_THROW(GrowableKukuTable(1, 0, 2, make_zero_item(), 1, make_zero_item(), 0.0), invalid_argument);
+        ASSERT_THROW(GrowableKukuTable(1, 0, 2, make_zero_item(), 1, make_zero_item(), 1.5), invalid_argument);
+        ASSERT_THROW(GrowableKukuTable(1, 0, 2, make_zero_item(), 1, make_zero_item(), 0.9, 1.0), invalid_argument);
+        ASSERT_THROW(
+            GrowableKukuTable(1, 0, 2, make_zero_item(), 1, make_zero_item(), 0.9, 2.0, 0), invalid_argument);
+
+        GrowableKukuTable gt(100, 2, 3, make_zero_item(), 10, make_all_ones_item());
+        ASSERT_EQ(100, gt.table_size());
+        ASSERT_EQ(0, gt.size());
+        ASSERT_EQ(0, gt.generation());
+        ASSERT_FALSE(gt.migrating());
+        ASSERT_THROW((void)gt.insert(make_all_ones_item()), invalid_argument);
+        ASSERT_THROW((void)gt.query(make_all_ones_item()), invalid_argument);
+        ASSERT_THROW((void)gt.erase(make_all_ones_item()), invalid_argument);
+    }
+
+    TEST(GrowableKukuTableTests, Grow)
+    {
+        GrowableKukuTable gt(1U << 8U, 4, 3, make_random_item(), 100, make_zero_item());
+        vector<item_type> items;
+        bool migrated = false;
+        for (size_t i = 0; i < 20000; i++)
+        {
+            items.push_back(make_random_item());
+            ASSERT_TRUE(gt.insert(items.back()));
+            ASSERT_FALSE(gt.insert(items.back()));
+
+            // While migrating, items still in the old table must be found
+            if (gt.migrating() && !migrated)
+            {
+                migrated = true;
+                for (const auto &item : items)
+                {
+                    ASSERT_TRUE(gt.query(item));
+                }
+            }
+        }
+        ASSERT_TRUE(migrated);
+        ASSERT_EQ(items.size(), gt.size());
+        ASSERT_GE(gt.table_size(), items.size());
+        ASSERT_GT(gt.generation(), 5);
+        for (const auto &item : items)
+        {
+            ASSERT_TRUE(gt.query(item));
+        }
+
+        gt.finish_migration();
+        ASSERT_FALSE(gt.migrating());
+        ASSERT_LE(gt.fill_rate(), 0.9);
+        for (const auto &item : items)
+        {
+            ASSERT_TRUE(gt.table().query(item));
+        }
+        ASSERT_FALSE(gt.query(make_random_item()));
+    }
+
+    TEST(GrowableKukuTableTests, EraseDuringMigration)
+    {
+        GrowableKukuTable gt(1U << 10U, 4, 3, make_random_item(), 100, make_zero_item(), 0.9, 2.0, 1);
+        vector<item_type> items;
+        while (!gt.migrating())
+        {
+            items.push_back(make_random_item());
+            ASSERT_TRUE(gt.insert(items.back()));
+        }
+
+        // Erase every third item while the migration proceeds one location at a time, so that both migrated and
+        // unmigrated items are erased
+        for (size_t i = 0; i < items.size(); i += 3)
+        {
+            ASSERT_TRUE(gt.erase(items[i]));
+            ASSERT_FALSE(gt.erase(items[i]));
+        }
+        ASSERT_TRUE(gt.migrating());
+        gt.finish_migration();
+        ASSERT_FALSE(gt.migrating());
+        ASSERT_EQ(items.size() - (items.size() + 2) / 3, gt.size());
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            ASSERT_EQ(i % 3 != 0, gt.query(items[i]));
+        }
+    }
+
+    TEST(GrowableKukuTableTests, SlowMigration)
+    {
+        // With a small growth factor and one location migrated per insert, tables fill up before their migration
+        // completes, and the remaining items are migrated at once
+        GrowableKukuTable gt(1U << 6U, 0, 2, make_random_item(), 10, make_zero_item(), 0.45, 1.05, 1);
+        vector<item_type> items;
+        for (size_t i = 0; i < 5000; i++)
+        {
+            items.push_back(make_random_item());
+            ASSERT_TRUE(gt.insert(items.back()));
+        }
+        ASSERT_EQ(items.size(), gt.size());
+        for (const auto &item : items)
+        {
+            ASSERT_TRUE(gt.query(item));
+        }
+    }
+} // namespace kuku_tests
@@ -2,9 +2,16 @@
 // Licensed under the MIT license.
 
 #include "kuku/kuku.h"
+#include "kuku/internal/checksum.h"
 #include "gtest/gtest.h"
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
 
 using namespace kuku;
 using namespace std;
@@ -174,6 +181,382 @@ namespace kuku_tests
         }
     }
 
+    TEST(KukuTableTests, FillDerived)
+    {
+        KukuTable ct(1U << 12U, 0, 4, make_random_item(), 100, make_zero_item(), LocFuncMode::derived);
+        ASSERT_EQ(LocFuncMode::derived, ct.loc_func_mode());
+        vector<item_type> inserted_items;
+        for (int i = 0; i < 3000; i++)
+        {
+            inserted_items.emplace_back(make_random_item());
+            ASSERT_TRUE(ct.insert(inserted_items.back()));
+        }
+        for (auto b : inserted_items)
+        {
+            ASSERT_TRUE(ct.query(b));
+        }
+        ASSERT_FALSE(ct.query(make_random_item()));
+
+        // The default remains independent location functions
+        KukuTable ct2(1U << 12U, 0, 4, make_random_item(), 100, make_zero_item());
+        ASSERT_EQ(LocFuncMode::independent, ct2.loc_func_mode());
+    }
+
+    TEST(KukuTableTests, FillHashFamilies)
+    {
+        for (HashFamily family : { HashFamily::aes, HashFamily::multiply_shift })
+        {
+            for (LocFuncMode mode : { LocFuncMode::independent, LocFuncMode::derived })
+            {
+                KukuTable ct(1U << 12U, 0, 4, make_random_item(), 100, make_zero_item(), mode, family);
+                ASSERT_EQ(family, ct.hash_family());
+                vector<item_type> inserted_items;
+                for (int i = 0; i < 3000; i++)
+                {
+                    inserted_items.emplace_back(make_random_item());
+                    ASSERT_TRUE(ct.insert(inserted_items.back()));
+                }
+                for (auto b : inserted_items)
+                {
+                    ASSERT_TRUE(ct.query(b));
+                }
+                ASSERT_FALSE(ct.query(make_random_item()));
+            }
+        }
+
+        // The default remains tabulation hashing
+        KukuTable ct(1U << 12U, 0, 4, make_random_item(), 100, make_zero_item());
+        ASSERT_EQ(HashFamily::tabulation, ct.hash_family());
+    }
+
+    TEST(KukuTableTests, FillBFS)
+    {
+        KukuTable ct(1U << 12U, 0, 3, make_random_item(), 100, make_zero_item());
+        ASSERT_EQ(InsertStrategy::random_walk, ct.insert_strategy());
+        ASSERT_THROW(ct.set_insert_strategy(static_cast<InsertStrategy>(2)), invalid_argument);
+        ct.set_insert_strategy(InsertStrategy::bfs);
+        ASSERT_EQ(InsertStrategy::bfs, ct.insert_strategy());
+
+        // Fill until failure; a failed BFS insert moves nothing, so the leftover item is the item itself
+        vector<item_type> inserted_items;
+        item_type item = make_random_item();
+        while (ct.insert(item))
+        {
+            inserted_items.push_back(item);
+            item = make_random_item();
+        }
+        ASSERT_TRUE(are_equal_item(item, ct.leftover_item()));
+        ASSERT_FALSE(ct.query(item));
+        ASSERT_GT(ct.fill_rate(), 0.75);
+        for (auto b : inserted_items)
+        {
+            ASSERT_TRUE(ct.query(b));
+        }
+
+        // Every item is in the table exactly once
+        vector<item_type> table_items;
+        for (const auto &b : ct.table())
+        {
+            if (!ct.is_empty_item(b))
+            {
+                table_items.push_back(b);
+            }
+        }
+        ASSERT_EQ(inserted_items.size(), table_items.size());
+
+        // Switching back to random walk keeps working on the same table
+        ct.set_insert_strategy(InsertStrategy::random_walk);
+        ct.clear_table();
+        for (int i = 0; i < 1000; i++)
+        {
+            ASSERT_TRUE(ct.insert(make_random_item()));
+        }
+    }
+
+    TEST(KukuTableTests, InsertBatch)
+    {
+        KukuTable ct((1U << 10U) + 1, 4, 2, make_zero_item(), 100, make_random_item());
+        vector<item_type> items;
+        for (int i = 0; i < 950; i++)
+        {
+            items.emplace_back(make_random_item());
+        }
+
+        // Repeat the first item so that the batch contains a duplicate of an item that is certainly present
+        items[1] = items[0];
+
+        unique_ptr<bool[]> results(new bool[items.size()]);
+        auto leftover_items = ct.insert_batch(items.data(), items.size(), results.get());
+        ASSERT_TRUE(results[0]);
+        ASSERT_FALSE(results[1]);
+
+        size_t failed = 0;
+        for (size_t i = 2; i < items.size(); i++)
+        {
+            failed += results[i] ? 0 : 1;
+        }
+        ASSERT_EQ(failed, leftover_items.size());
+        for (auto &leftover : leftover_items)
+        {
+            ASSERT_FALSE(ct.query(leftover));
+        }
+        for (size_t i = 2; i < items.size(); i++)
+        {
+            bool is_leftover = any_of(leftover_items.cbegin(), leftover_items.cend(), [&](const item_type &item) {
+                return are_equal_item(item, items[i]);
+            });
+            ASSERT_EQ(!is_leftover, static_cast<bool>(ct.query(items[i])));
+        }
+
+        // A batch containing the empty item is rejected without modifying the table
+        KukuTable ct2(1U << 10U, 0, 2, make_zero_item(), 10, make_zero_item());
+        vector<item_type> bad_items{ make_item(1, 0), make_item(0, 0) };
+        bool bad_results[2];
+        ASSERT_THROW((void)ct2.insert_batch(bad_items.data(), bad_items.size(), bad_results), invalid_argument);
+        ASSERT_FALSE(ct2.query(make_item(1, 0)));
+        ASSERT_THROW((void)ct2.insert_batch(nullptr, 1, bad_results), invalid_argument);
+        ASSERT_TRUE(ct2.insert_batch(nullptr, 0, nullptr).empty());
+    }
+
+    TEST(KukuTableTests, BuildParallel)
+    {
+        for (size_t thread_count : { 1, 2, 4 })
+        {
+            KukuTable ct(1U << 15U, 8, 3, make_random_item(), 100, make_zero_item());
+            item_type present = make_random_item();
+            ASSERT_TRUE(ct.insert(present));
+
+            vector<item_type> items;
+            for (int i = 0; i < 26000; i++)
+            {
+                items.emplace_back(make_random_item());
+            }
+
+            // Duplicates within the batch in different thread ranges, and an item already in the table
+            items[20000] = items[10];
+            items[25999] = items[10];
+            items[15000] = present;
+
+            unique_ptr<bool[]> results(new bool[items.size()]);
+            auto leftover_items = ct.build_parallel(items.data(), items.size(), thread_count, results.get());
+            ASSERT_FALSE(results[15000]);
+            ASSERT_EQ(1, static_cast<int>(results[10]) + results[20000] + results[25999]);
+
+            size_t succeeded = 0;
+            for (size_t i = 0; i < items.size(); i++)
+            {
+                succeeded += results[i] ? 1 : 0;
+            }
+            ASSERT_EQ(items.size() - 3, succeeded + leftover_items.size());
+            ASSERT_DOUBLE_EQ(
+                static_cast<double>(succeeded + 1) / static_cast<double>(ct.table_size() + ct.stash_size()),
+                ct.fill_rate());
+            ASSERT_TRUE(ct.query(present));
+            for (size_t i = 0; i < items.size(); i++)
+            {
+                bool is_leftover = any_of(leftover_items.cbegin(), leftover_items.cend(), [&](const item_type &item) {
+                    return are_equal_item(item, items[i]);
+                });
+                ASSERT_EQ(!is_leftover, static_cast<bool>(ct.query(items[i])));
+            }
+        }
+
+        KukuTable ct2(1U << 10U, 0, 2, make_zero_item(), 10, make_zero_item());
+        vector<item_type> bad_items{ make_item(1, 0), make_item(0, 0) };
+        bool bad_results[2];
+        ASSERT_THROW((void)ct2.build_parallel(bad_items.data(), bad_items.size(), 2, bad_results), invalid_argument);
+        ASSERT_FALSE(ct2.query(make_item(1, 0)));
+        ASSERT_THROW((void)ct2.build_parallel(nullptr, 1, 2, bad_results), invalid_argument);
+        ASSERT_TRUE(ct2.build_parallel(nullptr, 0, 2, nullptr).empty());
+    }
+
+    TEST(KukuTableTests, BuildWithSeeds)
+    {
+        vector<item_type> seeds;
+        for (int i = 0; i < 8; i++)
+        {
+            seeds.emplace_back(make_random_item());
+        }
+        vector<item_type> items;
+        for (int i = 0; i < 1800; i++)
+        {
+            items.emplace_back(make_random_item());
+        }
+        items[1000] = items[10];
+
+        for (size_t thread_count : { 1, 3, 8 })
+        {
+            auto table = KukuTable::build_with_seeds(
+                1U << 12U, 0, 2, seeds.data(), seeds.size(), 100, make_zero_item(), items.data(), items.size(),
+                thread_count);
+            ASSERT_NE(nullptr, table);
+            ASSERT_TRUE(any_of(seeds.cbegin(), seeds.cend(), [&](const item_type &seed) {
+                return are_equal_item(seed, table->loc_func_seed());
+            }));
+            ASSERT_EQ(1U << 12U, table->table_size());
+            ASSERT_EQ(2, table->loc_func_count());
+            ASSERT_DOUBLE_EQ(static_cast<double>(items.size() - 1) / (1U << 12U), table->fill_rate());
+            for (const auto &item : items)
+            {
+                ASSERT_TRUE(table->query(item));
+            }
+        }
+
+        // Too many items for any seed
+        for (size_t thread_count : { 1, 4 })
+        {
+            ASSERT_EQ(
+                nullptr, KukuTable::build_with_seeds(
+                             1U << 8U, 0, 2, seeds.data(), seeds.size(), 10, make_zero_item(), items.data(), 250,
+                             thread_count));
+        }
+
+        ASSERT_THROW(
+            (void)KukuTable::build_with_seeds(
+                1U << 12U, 0, 2, nullptr, 1, 100, make_zero_item(), items.data(), items.size()),
+            invalid_argument);
+        ASSERT_THROW(
+            (void)KukuTable::build_with_seeds(
+                1U << 12U, 0, 2, seeds.data(), 0, 100, make_zero_item(), items.data(), items.size()),
+            invalid_argument);
+        ASSERT_THROW(
+            (void)KukuTable::build_with_seeds(
+                1U << 12U, 0, 2, seeds.data(), seeds.size(), 100, items[5], items.data(), items.size()),
+            invalid_argument);
+        ASSERT_THROW(
+            (void)KukuTable::build_with_seeds(
+                1U << 12U, 0, 0, seeds.data(), seeds.size(), 100, make_zero_item(), items.data(), items.size(), 4),
+            invalid_argument);
+        ASSERT_NE(
+            nullptr, KukuTable::build_with_seeds(1U << 12U, 0, 2, seeds.data(), 1, 100, make_zero_item(), nullptr, 0));
+    }
+
+    TEST(KukuTableTests, SaveLoad)
+    {
+        KukuTable ct(
+            (1U << 10U) + 3, 8, 2, make_random_item(), 50, make_random_item(), LocFuncMode::derived, HashFamily::aes);
+        ct.set_insert_strategy(InsertStrategy::bfs);
+        vector<item_type> items;
+        for (int i = 0; i < 1000; i++)
+        {
+            items.emplace_back(make_random_item());
+            (void)ct.insert(items.back());
+        }
+        ASSERT_FALSE(ct.stash().empty());
+
+        auto check_equal = [&](const KukuTable &loaded) {
+            ASSERT_EQ(ct.table_size(), loaded.table_size());
+            ASSERT_EQ(ct.stash_size(), loaded.stash_size());
+            ASSERT_EQ(ct.loc_func_count(), loaded.loc_func_count());
+            ASSERT_EQ(ct.loc_func_mode(), loaded.loc_func_mode());
+            ASSERT_EQ(ct.hash_family(), loaded.hash_family());
+            ASSERT_EQ(ct.insert_strategy(), loaded.insert_strategy());
+            ASSERT_EQ(ct.max_probe(), loaded.max_probe());
+            ASSERT_TRUE(are_equal_item(ct.loc_func_seed(), loaded.loc_func_seed()));
+            ASSERT_TRUE(are_equal_item(ct.empty_item(), loaded.empty_item()));
+            ASSERT_TRUE(are_equal_item(ct.leftover_item(), loaded.leftover_item()));
+            ASSERT_EQ(ct.fill_rate(), loaded.fill_rate());
+            ASSERT_TRUE(ct.stash() == loaded.stash());
+            for (location_type loc = 0; loc < ct.table_size(); loc++)
+            {
+                ASSERT_TRUE(are_equal_item(ct.table(loc), loaded.table(loc)));
+            }
+            for (const auto &item : items)
+            {
+                auto expected = ct.query(item);
+                auto result = loaded.query(item);
+                ASSERT_EQ(static_cast<bool>(expected), static_cast<bool>(result));
+                ASSERT_EQ(expected.location(), result.location());
+                ASSERT_EQ(expected.loc_func_index(), result.loc_func_index());
+            }
+        };
+
+        stringstream stream;
+        ASSERT_EQ(ct.save_size(), ct.save(stream));
+        string saved = stream.str();
+        ASSERT_EQ(ct.save_size(), saved.size());
+        check_equal(*KukuTable::load(stream));
+
+        vector<byte> buffer(ct.save_size());
+        ASSERT_EQ(buffer.size(), ct.save(buffer.data(), buffer.size()));
+        ASSERT_TRUE(equal(saved.begin(), saved.end(), buffer.begin(), [](char a, byte b) {
+            return static_cast<unsigned char>(a) == static_cast<unsigned char>(b);
+        }));
+        auto loaded = KukuTable::load(buffer.data(), buffer.size());
+        check_equal(*loaded);
+
+        // The loaded table keeps working
+        loaded->clear_table();
+        ASSERT_TRUE(loaded->insert(items[0]));
+        ASSERT_TRUE(loaded->query(items[0]));
+
+        // Buffers that are too small, truncated, or corrupted are rejected
+        ASSERT_THROW((void)ct.save(buffer.data(), buffer.size() - 1), invalid_argument);
+        ASSERT_THROW((void)KukuTable::load(buffer.data(), buffer.size() - 1), invalid_argument);
+        ASSERT_THROW((void)KukuTable::load(nullptr, buffer.size()), invalid_argument);
+        buffer[100] ^= byte{ 1 };
+        ASSERT_THROW((void)KukuTable::load(buffer.data(), buffer.size()), invalid_argument);
+        buffer[100] ^= byte{ 1 };
+        buffer[0] = byte{ 'X' };
+        ASSERT_THROW((void)KukuTable::load(buffer.data(), buffer.size()), invalid_argument);
+
+        stringstream truncated(saved.substr(0, saved.size() - 1));
+        ASSERT_THROW((void)KukuTable::load(truncated), runtime_error);
+        saved[saved.size() - 1] ^= 1;
+        stringstream corrupted(saved);
+        ASSERT_THROW((void)KukuTable::load(corrupted), invalid_argument);
+    }
+
+    TEST(KukuTableTests, SaveChecksum)
+    {
+        // Known answers of XXH64, which checksums saved tables
+        ASSERT_EQ(0xEF46DB3751D8E999ULL, xxhash64(nullptr, 0));
+        ASSERT_EQ(0x44BC2CF5AD770999ULL, xxhash64("abc", 3));
+
+        // A length that exercises the 32-byte stripes and every tail case
+        vector<unsigned char> data(101);
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            data[i] = static_cast<unsigned char>(i * 7 + 3);
+        }
+        ASSERT_EQ(0xBAD4D3BF033BDA4CULL, xxhash64(data.data(), data.size()));
+        ASSERT_EQ(0x046DCCA647FF92A6ULL, xxhash64(data.data(), data.size(), 12345));
+    }
+
+    TEST(KukuTableTests, QueryBatch)
+    {
+        KukuTable ct(1U << 10U, 4, 3, make_zero_item(), 100, make_random_item());
+        vector<item_type> items;
+        for (int i = 0; i < 700; i++)
+        {
+            items.emplace_back(make_random_item());
+            (void)ct.insert(items.back());
+        }
+
+        // Mix hits with misses and use a count that is not a multiple of the group size
+        for (int i = 0; i < 37; i++)
+        {
+            items.emplace_back(make_random_item());
+        }
+
+        vector<QueryResult> results(items.size());
+        ct.query_batch(items.data(), items.size(), results.data());
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            QueryResult expected = ct.query(items[i]);
+            ASSERT_EQ(expected.found(), results[i].found());
+            ASSERT_EQ(expected.in_stash(), results[i].in_stash());
+            ASSERT_EQ(expected.location(), results[i].location());
+            ASSERT_EQ(expected.loc_func_index(), results[i].loc_func_index());
+        }
+
+        items.push_back(ct.empty_item());
+        results.resize(items.size());
+        ASSERT_THROW(ct.query_batch(items.data(), items.size(), results.data()), invalid_argument);
+        ASSERT_THROW(ct.query_batch(nullptr, 1, results.data()), invalid_argument);
+        ASSERT_NO_THROW(ct.query_batch(nullptr, 0, nullptr));
+    }
+
     TEST(KukuTableTests, Locations)
     {
         uint8_t lfc = 2;
@@ -196,6 +579,30 @@ namespace kuku_tests
         }
     }
 
+    TEST(KukuTableTests, LocationsBatch)
+    {
+        KukuTable ct(1U << 10U, 4, 3, make_random_item(), 100, make_zero_item());
+        vector<item_type> items(100);
+        for (auto &item : items)
+        {
+            set_random_item(item);
+        }
+
+        vector<location_type> locs(items.size() * ct.loc_func_count());
+        ct.locations(items.data(), items.size(), locs.data());
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            for (uint32_t j = 0; j < ct.loc_func_count(); j++)
+            {
+                ASSERT_EQ(ct.location(items[i], j), locs[i * ct.loc_func_count() + j]);
+            }
+        }
+
+        items.push_back(ct.empty_item());
+        locs.resize(items.size() * ct.loc_func_count());
+        ASSERT_THROW(ct.locations(items.data(), items.size(), locs.data()), invalid_argument);
+    }
+
     TEST(KukuTableTests, RepeatedInsert)
     {
         KukuTable ct(1U << 10U, 0, 4, make_zero_item(), 10, make_zero_item());
@@ -291,6 +698,180 @@ namespace kuku_tests
         ASSERT_TRUE(ct.insert(make_item(1, 1)));
     }
 
+    TEST(KukuTableTests, Erase)
+    {
+        KukuTable ct(1U << 10U, 8, 2, make_zero_item(), 100, make_random_item());
+        ASSERT_THROW((void)ct.erase(ct.empty_item()), invalid_argument);
+
+        // Fill until the stash is in use
+        vector<item_type> items;
+        while (ct.stash().size() < 4)
+        {
+            items.push_back(make_random_item());
+            ASSERT_TRUE(ct.insert(items.back()));
+        }
+        const double full_rate = ct.fill_rate();
+        ASSERT_FALSE(ct.erase(make_random_item()));
+        ASSERT_DOUBLE_EQ(full_rate, ct.fill_rate());
+
+        // Erase half of the items in random order; every erased item is gone and every other item is still found
+        shuffle(items.begin(), items.end(), mt19937_64(random_uint64()));
+        const size_t erase_count = items.size() / 2;
+        for (size_t i = 0; i < erase_count; i++)
+        {
+            ASSERT_TRUE(ct.erase(items[i]));
+            ASSERT_FALSE(ct.erase(items[i]));
+            ASSERT_FALSE(ct.query(items[i]));
+        }
+        for (size_t i = erase_count; i < items.size(); i++)
+        {
+            ASSERT_TRUE(ct.query(items[i]));
+        }
+        ASSERT_DOUBLE_EQ(
+            static_cast<double>(items.size() - erase_count) / static_cast<double>(ct.table_size() + ct.stash_size()),
+            ct.fill_rate());
+        size_t occupied = ct.stash().size();
+        for (location_type loc = 0; loc < ct.table_size(); loc++)
+        {
+            occupied += static_cast<size_t>(!ct.is_empty(loc));
+        }
+        ASSERT_EQ(items.size() - erase_count, occupied);
+
+        // A stash item with an empty location would have been moved back into the table
+        for (const auto &item : ct.stash())
+        {
+            for (location_type loc : ct.all_locations(item))
+            {
+                ASSERT_FALSE(ct.is_empty(loc));
+            }
+        }
+
+        // Erased locations can be reused
+        for (size_t i = 0; i < erase_count; i++)
+        {
+            ASSERT_TRUE(ct.insert(items[i]));
+        }
+        for (const auto &item : items)
+        {
+            ASSERT_TRUE(ct.query(item));
+        }
+    }
+
+    TEST(KukuTableTests, EraseBatch)
+    {
+        KukuTable ct(1U << 10U, 8, 2, make_zero_item(), 100, make_random_item());
+        vector<item_type> items;
+        while (ct.stash().size() < 4)
+        {
+            items.push_back(make_random_item());
+            ASSERT_TRUE(ct.insert(items.back()));
+        }
+
+        // Erase the even items, a duplicate, and an absent item
+        vector<item_type> erased;
+        for (size_t i = 0; i < items.size(); i += 2)
+        {
+            erased.push_back(items[i]);
+        }
+        erased.push_back(items[0]);
+        erased.push_back(make_random_item());
+        unique_ptr<bool[]> results(new bool[erased.size()]);
+        ASSERT_EQ(erased.size() - 2, ct.erase_batch(erased.data(), erased.size(), results.get()));
+        for (size_t i = 0; i < erased.size() - 2; i++)
+        {
+            ASSERT_TRUE(results[i]);
+        }
+        ASSERT_FALSE(results[erased.size() - 2]);
+        ASSERT_FALSE(results[erased.size() - 1]);
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            ASSERT_EQ(i % 2 == 1, static_cast<bool>(ct.query(items[i])));
+        }
+        ASSERT_DOUBLE_EQ(
+            static_cast<double>(items.size() / 2) / static_cast<double>(ct.table_size() + ct.stash_size()),
+            ct.fill_rate());
+        for (const auto &item : ct.stash())
+        {
+            for (location_type loc : ct.all_locations(item))
+            {
+                ASSERT_FALSE(ct.is_empty(loc));
+            }
+        }
+
+        // A batch containing the empty item is rejected without modifying the table
+        vector<item_type> bad_items{ items[1], ct.empty_item() };
+        bool bad_results[2];
+        ASSERT_THROW((void)ct.erase_batch(bad_items.data(), bad_items.size(), bad_results), invalid_argument);
+        ASSERT_TRUE(ct.query(items[1]));
+        ASSERT_THROW((void)ct.erase_batch(nullptr, 1, bad_results), invalid_argument);
+        ASSERT_EQ(0, ct.erase_batch(nullptr, 0, nullptr));
+    }
+
+    TEST(KukuTableTests, LargeStash)
+    {
+        // Large stashes are indexed; with max_probe 1 items overflow into the stash early
+        KukuTable ct(1U << 10U, 300, 2, make_random_item(), 1, make_zero_item());
+        vector<item_type> items;
+        for (uint64_t i = 1; ct.stash().size() < ct.stash_size(); i++)
+        {
+            items.push_back(make_item(i, 0));
+            ASSERT_TRUE(ct.insert(items.back()));
+        }
+
+        auto check = [&](const KukuTable &table, const vector<item_type> &present, const vector<item_type> &absent) {
+            for (const auto &item : present)
+            {
+                QueryResult res = table.query(item);
+                ASSERT_TRUE(res);
+                ASSERT_TRUE(are_equal_item(
+                    item, res.in_stash() ? table.stash(res.location()) : table.table(res.location())));
+            }
+            for (const auto &item : absent)
+            {
+                ASSERT_FALSE(table.query(item));
+            }
+        };
+        vector<item_type> misses;
+        for (int i = 0; i < 1000; i++)
+        {
+            misses.push_back(make_random_item());
+        }
+        check(ct, items, misses);
+
+        // Erasing stash items renumbers the stash; erasing table items moves stash items back into the table
+        vector<item_type> stash_items(ct.stash().begin(), ct.stash().begin() + 100);
+        for (const auto &item : stash_items)
+        {
+            ASSERT_TRUE(ct.erase(item));
+        }
+        for (size_t i = 0; i < 200; i++)
+        {
+            const QueryResult res = ct.query(items[i]);
+            if (res && !res.in_stash())
+            {
+                stash_items.push_back(items[i]);
+                ASSERT_TRUE(ct.erase(items[i]));
+            }
+        }
+        vector<item_type> remaining;
+        copy_if(items.begin(), items.end(), back_inserter(remaining), [&](const item_type &item) {
+            return none_of(stash_items.begin(), stash_items.end(), [&](const item_type &b) {
+                return are_equal_item(b, item);
+            });
+        });
+        check(ct, remaining, stash_items);
+
+        // The index is rebuilt when loading
+        stringstream stream;
+        ct.save(stream);
+        check(*KukuTable::load(stream), remaining, stash_items);
+
+        ct.clear_table();
+        check(ct, {}, items);
+        ASSERT_TRUE(ct.insert(items[0]));
+        check(ct, { items[0] }, misses);
+    }
+
     TEST(KukuTableTests, QueryResultDefaultIsNotFound)
     {
         // Default-constructed QueryResult must report not-found; otherwise a stack-allocated
@@ -299,4 +880,66 @@ namespace kuku_tests
         ASSERT_FALSE(result.found());
         ASSERT_FALSE(static_cast<bool>(result));
     }
+
+#ifdef KUKU_USE_STATS
+    TEST(KukuTableTests, Stats)
+    {
+        constexpr uint64_t max_probe = 10;
+        KukuTable ct(1 << 8, 4, 2, make_random_item(), max_probe, make_zero_item());
+        KukuTableStats stats = ct.stats();
+        ASSERT_EQ(0, stats.evictions);
+        ASSERT_EQ(2, stats.loc_func_occupancy.size());
+
+        // Fill until failure; a random walk ends at a free location, in the stash, or in failure
+        uint64_t attempts = 0;
+        item_type item = make_item(1, 0);
+        while (ct.insert(item))
+        {
+            increment_item(item);
+            attempts++;
+        }
+        attempts++;
+
+        // Re-inserting an item already in the table is not counted
+        ASSERT_FALSE(ct.insert(make_item(1, 0)));
+
+        stats = ct.stats();
+        uint64_t walks = 0;
+        for (auto count : stats.walk_histogram)
+        {
+            walks += count;
+        }
+        ASSERT_EQ(attempts, walks);
+        ASSERT_EQ(4, stats.stash_inserts);
+        ASSERT_EQ(1, stats.failed_inserts);
+        ASSERT_GE(stats.evictions, 5 * max_probe);
+        ASSERT_GT(stats.walk_histogram[0], 0);
+
+        // Walks that ended in the stash or failed took max_probe = 10 steps, which falls in bucket 4 (8 to 15)
+        ASSERT_GE(stats.walk_histogram[4], 5);
+
+        uint64_t occupied = 0;
+        for (auto count : stats.loc_func_occupancy)
+        {
+            occupied += count;
+        }
+        ASSERT_EQ(
+            static_cast<uint64_t>(count_if(
+                ct.table().begin(), ct.table().end(), [&](const item_type &it) { return !ct.is_empty_item(it); })),
+            occupied);
+
+        // Resetting clears the counters but not the occupancy, which reflects the table contents
+        ct.reset_stats();
+        stats = ct.stats();
+        ASSERT_EQ(0, stats.evictions);
+        ASSERT_EQ(0, stats.stash_inserts);
+        ASSERT_EQ(0, stats.failed_inserts);
+        ASSERT_EQ(0, stats.walk_histogram[0]);
+        ASSERT_EQ(occupied, stats.loc_func_occupancy[0] + stats.loc_func_occupancy[1]);
+
+        ct.clear_table();
+        stats = ct.stats();
+        ASSERT_EQ(0, stats.loc_func_occupancy[0] + stats.loc_func_occupancy[1]);
+    }
+#endif
 } // namespace kuku_tests
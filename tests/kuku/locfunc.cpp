@@ -4,7 +4,9 @@
 #include "kuku/common.h"
 #include "kuku/locfunc.h"
 #include "gtest/gtest.h"
+#include <array>
 #include <cmath>
+#include <vector>
 
 using namespace kuku;
 using namespace std;
@@ -46,4 +48,197 @@ namespace kuku_tests
             }
         }
     }
+
+    TEST(LocFuncTests, Batch)
+    {
+        // Sizes that exercise the vectorized loops as well as the scalar tail
+        for (size_t count : { 0, 1, 7, 8, 15, 16, 17, 100 })
+        {
+            LocFunc lf(1000, make_random_item());
+            vector<item_type> items(count);
+            for (auto &item : items)
+            {
+                set_random_item(item);
+            }
+
+            vector<location_type> out(count);
+            lf(items.data(), count, out.data());
+            for (size_t i = 0; i < count; i++)
+            {
+                ASSERT_EQ(lf(items[i]), out[i]);
+            }
+        }
+    }
+
+    TEST(LocFuncTests, BankCreate)
+    {
+        ASSERT_THROW(LocFuncBank(0, 2, make_item(0, 0)), invalid_argument);
+        ASSERT_THROW(LocFuncBank(max_table_size + 1, 2, make_item(0, 0)), invalid_argument);
+        ASSERT_THROW(LocFuncBank(1, 0, make_item(0, 0)), invalid_argument);
+        ASSERT_THROW(LocFuncBank(1, max_loc_func_count + 1, make_item(0, 0)), invalid_argument);
+        ASSERT_NO_THROW(LocFuncBank(1, max_loc_func_count, make_item(0, 0)));
+    }
+
+    TEST(LocFuncTests, BankMatchesLocFunc)
+    {
+        // Cover the specialized counts as well as the generic path
+        for (uint32_t lfc : { 1U, 2U, 3U, 4U, 5U, 8U, max_loc_func_count })
+        {
+            item_type seed = make_random_item();
+            LocFuncBank bank(1000, lfc, seed);
+            ASSERT_EQ(lfc, bank.loc_func_count());
+
+            vector<LocFunc> lfs;
+            for (uint32_t i = 0; i < lfc; i++)
+            {
+                lfs.emplace_back(1000, seed);
+                increment_item(seed);
+            }
+
+            vector<item_type> items(20);
+            for (auto &item : items)
+            {
+                set_random_item(item);
+            }
+            vector<location_type> all(items.size() * lfc);
+            bank.locations(items.data(), items.size(), all.data());
+            for (size_t i = 0; i < items.size(); i++)
+            {
+                for (uint32_t j = 0; j < lfc; j++)
+                {
+                    ASSERT_EQ(lfs[j](items[i]), bank(items[i], j));
+                    ASSERT_EQ(lfs[j](items[i]), all[i * lfc + j]);
+                }
+            }
+        }
+    }
+
+    TEST(LocFuncTests, BankDerived)
+    {
+        // With a single location function there is nothing to derive
+        item_type seed = make_random_item();
+        LocFuncBank independent(1000, 1, seed, LocFuncMode::independent);
+        LocFuncBank derived1(1000, 1, seed, LocFuncMode::derived);
+        ASSERT_EQ(LocFuncMode::derived, derived1.mode());
+        for (int i = 0; i < 100; i++)
+        {
+            item_type item = make_random_item();
+            ASSERT_EQ(independent(item, 0), derived1(item, 0));
+        }
+
+        constexpr uint32_t lfc = 8;
+        constexpr table_size_type ts = 4;
+        LocFuncBank derived(ts, lfc, seed, LocFuncMode::derived);
+        ASSERT_EQ(lfc, derived.loc_func_count());
+        array<uint64_t, lfc> zeros{};
+        uint64_t total = 10000;
+        for (uint64_t i = 0; i < total; i++)
+        {
+            item_type item = make_random_item();
+            array<location_type, lfc> locs{};
+            derived.locations(item, locs.data());
+            for (uint32_t j = 0; j < lfc; j++)
+            {
+                ASSERT_EQ(derived(item, j), locs[j]);
+                ASSERT_LT(locs[j], ts);
+                zeros[j] += static_cast<uint64_t>(locs[j] == 0);
+            }
+        }
+
+        // Every derived function is uniform on its own
+        for (uint32_t j = 0; j < lfc; j++)
+        {
+            ASSERT_TRUE(
+                abs((static_cast<double>(zeros[j]) / static_cast<double>(total)) - (1.0 / static_cast<double>(ts))) <
+                0.05);
+        }
+    }
+
+    TEST(LocFuncTests, HashFamilies)
+    {
+        ASSERT_THROW(LocFunc(1000, make_item(0, 0), static_cast<HashFamily>(3)), invalid_argument);
+        ASSERT_THROW(LocFuncBank(1000, 2, make_item(0, 0), LocFuncMode::independent, static_cast<HashFamily>(3)),
+            invalid_argument);
+
+        for (HashFamily family : { HashFamily::tabulation, HashFamily::aes, HashFamily::multiply_shift })
+        {
+            // Small and non-power-of-two sizes; the multiply-high reduction must still be uniform
+            for (table_size_type ts : { 1U, 3U, 7U, 1000U })
+            {
+                item_type seed = make_random_item();
+                LocFunc lf(ts, seed, family);
+                ASSERT_EQ(family, lf.hash_family());
+
+                uint64_t zeros = 0;
+                uint64_t total = 10000;
+                vector<item_type> items(total);
+                for (auto &item : items)
+                {
+                    set_random_item(item);
+                    ASSERT_LT(lf(item), ts);
+                    zeros += static_cast<uint64_t>(lf(item) == 0);
+                }
+                ASSERT_TRUE(
+                    abs((static_cast<double>(zeros) / static_cast<double>(total)) - (1.0 / static_cast<double>(ts))) <
+                    0.05);
+
+                vector<location_type> out(items.size());
+                lf(items.data(), items.size(), out.data());
+                for (size_t i = 0; i < items.size(); i++)
+                {
+                    ASSERT_EQ(lf(items[i]), out[i]);
+                }
+            }
+
+            // Banks of either mode agree with individual location functions of the same family
+            item_type seed = make_random_item();
+            constexpr uint32_t lfc = 3;
+            LocFuncBank bank(1000, lfc, seed, LocFuncMode::independent, family);
+            LocFuncBank derived(1000, lfc, seed, LocFuncMode::derived, family);
+            ASSERT_EQ(family, bank.hash_family());
+            vector<LocFunc> lfs;
+            for (uint32_t i = 0; i < lfc; i++)
+            {
+                lfs.emplace_back(1000, seed, family);
+                increment_item(seed);
+            }
+            for (int i = 0; i < 100; i++)
+            {
+                item_type item = make_random_item();
+                array<location_type, lfc> locs{};
+                array<location_type, lfc> derived_locs{};
+                bank.locations(item, locs.data());
+                derived.locations(item, derived_locs.data());
+                for (uint32_t j = 0; j < lfc; j++)
+                {
+                    ASSERT_EQ(lfs[j](item), bank(item, j));
+                    ASSERT_EQ(lfs[j](item), locs[j]);
+                    ASSERT_EQ(derived(item, j), derived_locs[j]);
+                    ASSERT_LT(derived_locs[j], 1000U);
+                }
+            }
+        }
+    }
+
+    TEST(LocFuncTests, AESRound)
+    {
+        // The first round of the AES-128 example in FIPS-197, Appendix B
+        item_type state{ 0x19, 0x3d, 0xe3, 0xbe, 0xa0, 0xf4, 0xe2, 0x2b,
+                         0x9a, 0xc6, 0x8d, 0x2a, 0xe9, 0xf8, 0x48, 0x08 };
+        item_type round_key{ 0xa0, 0xfa, 0xfe, 0x17, 0x88, 0x54, 0x2c, 0xb1,
+                             0x23, 0xa3, 0x39, 0x39, 0x2a, 0x6c, 0x76, 0x05 };
+        item_type expected{ 0xa4, 0x9c, 0x7f, 0xf2, 0x68, 0x9f, 0x35, 0x2b,
+                            0x6b, 0x5b, 0xea, 0x43, 0x02, 0x6a, 0x50, 0x49 };
+        ASSERT_EQ(expected, AESHashFunc::encrypt_round_portable(state, round_key));
+        ASSERT_EQ(expected, AESHashFunc::encrypt_round(state, round_key));
+
+        // The hardware and portable rounds agree
+        for (int i = 0; i < 100; i++)
+        {
+            state = make_random_item();
+            round_key = make_random_item();
+            ASSERT_EQ(
+                AESHashFunc::encrypt_round_portable(state, round_key), AESHashFunc::encrypt_round(state, round_key));
+        }
+    }
 } // namespace kuku_tests
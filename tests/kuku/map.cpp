@@ -0,0 +1,150 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/map.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_tests
+{
+    namespace
+    {
+        /*
+        A payload derived from the item, so that every payload can be checked against its item.
+        */
+        array<unsigned char, 12> make_payload(const item_type &item)
+        {
+            array<unsigned char, 12> payload;
+            const uint64_t low_word = get_low_word(item) * 3;
+            const uint32_t high_bits = static_cast<uint32_t>(get_high_word(item));
+            memcpy(payload.data(), &low_word, sizeof(low_word));
+            memcpy(payload.data() + sizeof(low_word), &high_bits, sizeof(high_bits));
+            return payload;
+        }
+    } // namespace
+
+    TEST(KukuMapTests, Create)
+    {
+        ASSERT_THROW(KukuMap(0, 0, 2, make_zero_item(), 1, make_zero_item(), 8), invalid_argument);
+        ASSERT_THROW(KukuMap(1, 0, 0, make_zero_item(), 1, make_zero_item(), 8), invalid_argument);
+        ASSERT_THROW(KukuMap(1, 0, 2, make_zero_item(), 0, make_zero_item(), 8), invalid_argument);
+        ASSERT_THROW(KukuMap(1, 0, 2, make_zero_item(), 1, make_zero_item(), 0), invalid_argument);
+
+        KukuMap map(1000, 2, 3, make_zero_item(), 10, make_all_ones_item(), 4);
+        ASSERT_EQ(1000, map.table_size());
+        ASSERT_EQ(2, map.stash_size());
+        ASSERT_EQ(4, map.payload_size());
+        ASSERT_TRUE(map.is_empty_item(map.table(999)));
+        ASSERT_EQ(vector<unsigned char>(4, 0), map.leftover_payload());
+        ASSERT_THROW((void)map.table(1000), out_of_range);
+        ASSERT_THROW((void)map.insert(make_all_ones_item(), map.leftover_payload().data()), invalid_argument);
+        ASSERT_THROW((void)map.insert(make_zero_item(), nullptr), invalid_argument);
+        ASSERT_THROW((void)map.find(make_all_ones_item()), invalid_argument);
+        ASSERT_EQ(nullptr, map.find(make_zero_item()));
+        ASSERT_THROW((void)map.payload(map.query(make_zero_item())), invalid_argument);
+    }
+
+    TEST(KukuMapTests, Fill)
+    {
+        KukuMap map(1U << 12U, 4, 3, make_random_item(), 100, make_zero_item(), 12);
+        KukuTable table(1U << 12U, 4, 3, map.loc_func_seed(), 100, make_zero_item());
+        vector<item_type> inserted_items;
+        item_type item = make_random_item();
+        while (map.insert(item, make_payload(item).data()))
+        {
+            inserted_items.push_back(item);
+            item = make_random_item();
+        }
+        ASSERT_GT(map.fill_rate(), 0.75);
+        ASSERT_EQ(4, map.stash().size());
+
+        // The leftover item carries its own payload
+        ASSERT_TRUE(equal(
+            map.leftover_payload().begin(), map.leftover_payload().end(),
+            make_payload(map.leftover_item()).begin()));
+        inserted_items.push_back(item);
+        inserted_items.erase(find_if(inserted_items.begin(), inserted_items.end(), [&](const item_type &b) {
+            return are_equal_item(b, map.leftover_item());
+        }));
+
+        // Every item is found with its own payload, at a location of the KukuTable location functions
+        for (const auto &b : inserted_items)
+        {
+            QueryResult res = map.query(b);
+            ASSERT_TRUE(res.found());
+            if (!res.in_stash())
+            {
+                ASSERT_TRUE(are_equal_item(b, map.table(res.location())));
+                ASSERT_EQ(table.location(b, res.loc_func_index()), res.location());
+            }
+            ASSERT_EQ(0, memcmp(make_payload(b).data(), map.payload(res), map.payload_size()));
+            ASSERT_EQ(map.payload(res), map.find(b));
+
+            // A repeated insert leaves the payload unchanged
+            const array<unsigned char, 12> other{};
+            ASSERT_FALSE(map.insert(b, other.data()));
+            ASSERT_EQ(0, memcmp(make_payload(b).data(), map.find(b), map.payload_size()));
+        }
+        ASSERT_EQ(nullptr, map.find(make_random_item()));
+
+        map.clear_table();
+        ASSERT_EQ(0.0, map.fill_rate());
+        ASSERT_EQ(nullptr, map.find(inserted_items[0]));
+    }
+
+    TEST(KukuMapTests, ModifyPayload)
+    {
+        KukuMap map(1U << 9U, 0, 3, make_random_item(), 100, make_zero_item(), sizeof(uint64_t));
+        vector<item_type> items;
+        for (uint64_t i = 1; i <= 100; i++)
+        {
+            items.push_back(make_item(i, 0));
+            ASSERT_TRUE(map.insert(items.back(), reinterpret_cast<const unsigned char *>(&i)));
+        }
+
+        // Payloads modified in place move with their items during later evictions
+        for (uint64_t i = 1; i <= 100; i++)
+        {
+            const uint64_t value = i * 1000;
+            memcpy(map.find(items[i - 1]), &value, sizeof(value));
+        }
+        for (uint64_t i = 101; i <= 300; i++)
+        {
+            ASSERT_TRUE(map.insert(make_item(i, 0), reinterpret_cast<const unsigned char *>(&i)));
+        }
+        for (uint64_t i = 1; i <= 100; i++)
+        {
+            uint64_t value = 0;
+            memcpy(&value, map.find(items[i - 1]), sizeof(value));
+            ASSERT_EQ(i * 1000, value);
+        }
+    }
+
+    TEST(KukuMapTests, LargeStash)
+    {
+        // Large stashes are indexed; with max_probe 1 items overflow into the stash early
+        KukuMap map(1U << 8U, 64, 2, make_random_item(), 1, make_zero_item(), 12);
+        vector<item_type> items;
+        for (uint64_t i = 1; map.stash().size() < map.stash_size(); i++)
+        {
+            items.push_back(make_item(i, 0));
+            ASSERT_TRUE(map.insert(items.back(), make_payload(items.back()).data()));
+        }
+        for (const auto &item : items)
+        {
+            ASSERT_NE(nullptr, map.find(item));
+            ASSERT_EQ(0, memcmp(make_payload(item).data(), map.find(item), map.payload_size()));
+        }
+        ASSERT_EQ(nullptr, map.find(make_random_item()));
+
+        map.clear_table();
+        ASSERT_EQ(nullptr, map.find(items.back()));
+    }
+} // namespace kuku_tests
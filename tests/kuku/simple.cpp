@@ -0,0 +1,93 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/simple.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_tests
+{
+    TEST(SimpleHashTableTests, Create)
+    {
+        ASSERT_THROW(SimpleHashTable(0, 2, make_zero_item()), invalid_argument);
+        ASSERT_THROW(SimpleHashTable(1, 0, make_zero_item()), invalid_argument);
+
+        KukuTable table(1000, 0, 3, make_random_item(), 10, make_zero_item(), LocFuncMode::derived);
+        SimpleHashTable sht(table);
+        ASSERT_EQ(1000, sht.table_size());
+        ASSERT_EQ(3, sht.loc_func_count());
+        ASSERT_TRUE(are_equal_item(table.loc_func_seed(), sht.loc_func_seed()));
+        ASSERT_EQ(LocFuncMode::derived, sht.loc_func_mode());
+        ASSERT_EQ(HashFamily::tabulation, sht.hash_family());
+        ASSERT_EQ(0, sht.bin_size(999));
+        ASSERT_EQ(1001, sht.bin_offsets().size());
+        ASSERT_EQ(0, sht.max_bin_load());
+        ASSERT_THROW((void)sht.bin_size(1000), out_of_range);
+        ASSERT_THROW((void)sht.bin(1000), out_of_range);
+        ASSERT_THROW(sht.build(nullptr, 1), invalid_argument);
+        sht.build(nullptr, 0);
+        ASSERT_TRUE(sht.items().empty());
+    }
+
+    TEST(SimpleHashTableTests, Build)
+    {
+        KukuTable table(1U << 12U, 0, 3, make_random_item(), 10, make_zero_item());
+        vector<item_type> items;
+        for (int i = 0; i < 20000; i++)
+        {
+            items.push_back(make_random_item());
+        }
+        items[100] = items[5];
+
+        // Every item is in each of its distinct locations, in the order of the items
+        vector<vector<item_type>> expected(table.table_size());
+        for (const auto &item : items)
+        {
+            for (location_type loc : table.all_locations(item))
+            {
+                expected[loc].push_back(item);
+            }
+        }
+        size_t total = 0;
+        size_t max_load = 0;
+        for (const auto &bin : expected)
+        {
+            total += bin.size();
+            max_load = max(max_load, bin.size());
+        }
+
+        SimpleHashTable sht(table);
+        for (size_t thread_count : { 1, 3, 4 })
+        {
+            sht.build(items.data(), items.size(), thread_count);
+            ASSERT_EQ(items.size(), sht.item_count());
+            ASSERT_EQ(total, sht.items().size());
+            ASSERT_EQ(total, sht.bin_offsets().back());
+            ASSERT_EQ(max_load, sht.max_bin_load());
+            for (location_type loc = 0; loc < table.table_size(); loc++)
+            {
+                ASSERT_EQ(expected[loc].size(), sht.bin_size(loc));
+                ASSERT_TRUE(equal(
+                    expected[loc].begin(), expected[loc].end(), sht.bin(loc),
+                    [](const item_type &a, const item_type &b) { return are_equal_item(a, b); }));
+            }
+        }
+
+        // A new build replaces the contents
+        sht.build(items.data(), 10, 2);
+        ASSERT_EQ(10, sht.item_count());
+        ASSERT_GE(sht.items().size(), 10);
+        ASSERT_LE(sht.items().size(), 30);
+
+        sht.clear();
+        ASSERT_TRUE(sht.items().empty());
+        ASSERT_EQ(0, sht.bin_size(0));
+        ASSERT_EQ(0, sht.max_bin_load());
+    }
+} // namespace kuku_tests
@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/tune.h"
+#include "gtest/gtest.h"
+#include <stdexcept>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_tests
+{
+    TEST(TuneTests, InvalidOptions)
+    {
+        TuneOptions options;
+        options.item_count = 100;
+        options.failure_probability = 0.1;
+
+        TuneOptions bad = options;
+        bad.item_count = 0;
+        ASSERT_THROW((void)tune_parameters(bad), invalid_argument);
+        bad = options;
+        bad.failure_probability = 1.0;
+        ASSERT_THROW((void)tune_parameters(bad), invalid_argument);
+        bad.failure_probability = 0.0;
+        ASSERT_THROW((void)tune_parameters(bad), invalid_argument);
+        bad = options;
+        bad.stash_sizes.clear();
+        ASSERT_THROW((void)tune_parameters(bad), invalid_argument);
+        bad = options;
+        bad.loc_func_counts = { 3, 0 };
+        ASSERT_THROW((void)tune_parameters(bad), invalid_argument);
+        bad.loc_func_counts = { max_loc_func_count + 1 };
+        ASSERT_THROW((void)tune_parameters(bad), invalid_argument);
+        bad = options;
+        bad.max_probes = { 0 };
+        ASSERT_THROW((void)tune_parameters(bad), invalid_argument);
+        bad = options;
+        bad.trial_count = 0;
+        ASSERT_THROW((void)tune_parameters(bad), invalid_argument);
+        bad = options;
+        bad.memory_slack = -0.5;
+        ASSERT_THROW((void)tune_parameters(bad), invalid_argument);
+    }
+
+    TEST(TuneTests, Recommend)
+    {
+        TuneOptions options;
+        options.item_count = 2000;
+        options.failure_probability = 0.05;
+        options.loc_func_counts = { 2, 3 };
+        options.stash_sizes = { 0 };
+        options.max_probes = { 100 };
+        options.trial_count = 40;
+        options.thread_count = 2;
+
+        const auto results = tune_parameters(options);
+        ASSERT_EQ(2, results.size());
+
+        // Two location functions hold at most half a table; three hold around 90%
+        const auto &best = results[0];
+        ASSERT_EQ(3, best.loc_func_count);
+        ASSERT_EQ(0, best.stash_size);
+        ASSERT_EQ(100, best.max_probe);
+        ASSERT_GE(best.table_size, 2000);
+        ASSERT_LE(best.table_size, 2750);
+        ASSERT_EQ(40, best.trial_count);
+        ASSERT_LE(best.failure_count, 2);
+        ASSERT_GT(best.inserts_per_second, 0.0);
+
+        ASSERT_EQ(2, results[1].loc_func_count);
+        ASSERT_GE(results[1].table_size, 4000);
+        ASSERT_LE(results[1].failure_count, 2);
+
+        // Equally small candidates are ordered by query cost: the stash is not worth its comparisons
+        options.loc_func_counts = { 3 };
+        options.stash_sizes = { 0, 4 };
+        options.memory_slack = 0.1;
+        const auto stash_results = tune_parameters(options);
+        ASSERT_EQ(2, stash_results.size());
+        ASSERT_EQ(0, stash_results[0].stash_size);
+        ASSERT_EQ(4, stash_results[1].stash_size);
+    }
+} // namespace kuku_tests
@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT license.
+
+#include "kuku/kuku.h"
+#include "kuku/view.h"
+#include "gtest/gtest.h"
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace kuku;
+using namespace std;
+
+namespace kuku_tests
+{
+    namespace
+    {
+        void fill(KukuTable &table, vector<item_type> &items, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                items.push_back(make_random_item());
+                (void)table.insert(items.back());
+            }
+        }
+
+        void check_view(const KukuTable &table, const KukuTableView &view, const vector<item_type> &items)
+        {
+            ASSERT_EQ(table.table_size(), view.table_size());
+            ASSERT_EQ(table.stash_size(), view.stash_size());
+            ASSERT_EQ(table.loc_func_count(), view.loc_func_count());
+            ASSERT_EQ(table.loc_func_mode(), view.loc_func_mode());
+            ASSERT_EQ(table.hash_family(), view.hash_family());
+            ASSERT_EQ(table.max_probe(), view.max_probe());
+            ASSERT_TRUE(are_equal_item(table.loc_func_seed(), view.loc_func_seed()));
+            ASSERT_TRUE(are_equal_item(table.empty_item(), view.empty_item()));
+            ASSERT_TRUE(are_equal_item(table.leftover_item(), view.leftover_item()));
+            ASSERT_EQ(table.fill_rate(), view.fill_rate());
+            ASSERT_TRUE(view.verify_checksum());
+
+            for (location_type loc = 0; loc < table.table_size(); loc++)
+            {
+                ASSERT_TRUE(are_equal_item(table.table(loc), view.table(loc)));
+                ASSERT_EQ(table.is_empty(loc), view.is_empty(loc));
+            }
+            ASSERT_EQ(table.stash().size(), view.stash_count());
+            for (location_type loc = 0; loc < view.stash_size(); loc++)
+            {
+                ASSERT_TRUE(are_equal_item(table.stash(loc), view.stash(loc)));
+            }
+            for (const auto &item : items)
+            {
+                auto expected = table.query(item);
+                auto result = view.query(item);
+                ASSERT_EQ(static_cast<bool>(expected), static_cast<bool>(result));
+                ASSERT_EQ(expected.location(), result.location());
+                ASSERT_EQ(expected.loc_func_index(), result.loc_func_index());
+                ASSERT_EQ(table.location(item, 0), view.location(item, 0));
+            }
+            ASSERT_FALSE(view.query(make_random_item()));
+        }
+    } // namespace
+
+    TEST(KukuTableViewTests, Buffer)
+    {
+        KukuTable table(
+            (1U << 10U) + 1, 8, 2, make_random_item(), 50, make_zero_item(), LocFuncMode::independent,
+            HashFamily::multiply_shift);
+        vector<item_type> items;
+        fill(table, items, 1000);
+        ASSERT_FALSE(table.stash().empty());
+
+        vector<byte> buffer(table.save_size());
+        (void)table.save(buffer.data(), buffer.size());
+        KukuTableView view(buffer.data(), buffer.size());
+        check_view(table, view, items);
+
+        ASSERT_THROW((void)view.table(table.table_size()), out_of_range);
+        ASSERT_THROW((void)view.stash(view.stash_size()), out_of_range);
+        ASSERT_THROW((void)view.location(items[0], 2), out_of_range);
+        ASSERT_THROW((void)view.query(make_zero_item()), invalid_argument);
+
+        // Invalid buffers are rejected; corruption is only detected by verify_checksum
+        ASSERT_THROW(KukuTableView(nullptr, buffer.size()), invalid_argument);
+        ASSERT_THROW(KukuTableView(buffer.data(), buffer.size() - 1), invalid_argument);
+        buffer[100] ^= byte{ 1 };
+        ASSERT_FALSE(KukuTableView(buffer.data(), buffer.size()).verify_checksum());
+        buffer[4] = byte{ 2 };
+        ASSERT_THROW(KukuTableView(buffer.data(), buffer.size()), invalid_argument);
+    }
+
+    TEST(KukuTableViewTests, MapFile)
+    {
+        KukuTable table(1U << 12U, 4, 3, make_random_item(), 100, make_random_item(), LocFuncMode::derived);
+        vector<item_type> items;
+        fill(table, items, 3500);
+
+        const string path = testing::TempDir() + "kuku_view_test.bin";
+        {
+            ofstream stream(path, ios::binary);
+            (void)table.save(stream);
+        }
+        {
+            auto view = KukuTableView::map_file(path);
+            check_view(table, *view, items);
+        }
+
+        // A truncated file is rejected
+        {
+            ofstream stream(path, ios::binary);
+            stream << "KUKU";
+        }
+        ASSERT_THROW((void)KukuTableView::map_file(path), invalid_argument);
+        ASSERT_EQ(0, remove(path.c_str()));
+        ASSERT_THROW((void)KukuTableView::map_file(path), runtime_error);
+    }
+
+    TEST(KukuTableViewTests, LargeStash)
+    {
+        // Large stashes are indexed by the view as by the table
+        KukuTable table(1U << 8U, 64, 2, make_random_item(), 1, make_zero_item());
+        vector<item_type> items;
+        while (table.stash().size() < table.stash_size())
+        {
+            items.push_back(make_random_item());
+            (void)table.insert(items.back());
+        }
+
+        vector<byte> buffer(table.save_size());
+        (void)table.save(buffer.data(), buffer.size());
+        KukuTableView view(buffer.data(), buffer.size());
+        check_view(table, view, items);
+    }
+} // namespace kuku_tests